@@ -0,0 +1,130 @@
+#pragma once
+#include "Base/Common.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace gdf
+{
+
+// Bounded lock-free multi-producer/multi-consumer queue.
+// Every cell carries a sequence number that tells producers and consumers whether the cell is free
+// for the current lap, so neither side takes a lock and no memory is allocated after construction.
+template <typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(size_t capacity)
+    {
+        capacity_ = 2;
+        while (capacity_ < capacity)
+            capacity_ <<= 1;
+        mask_ = capacity_ - 1;
+        cells_.reset(new Cell[capacity_]);
+        for (size_t i = 0; i < capacity_; i++)
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        enqueuePos_.store(0, std::memory_order_relaxed);
+        dequeuePos_.store(0, std::memory_order_relaxed);
+    }
+
+    ~BoundedQueue()
+    {
+        size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        size_t end = enqueuePos_.load(std::memory_order_relaxed);
+        for (; pos != end; pos++) {
+            Cell &cell = cells_[pos & mask_];
+            if (cell.sequence.load(std::memory_order_relaxed) == pos + 1)
+                cell.value()->~T();
+        }
+    }
+
+    BoundedQueue(const BoundedQueue &) = delete;
+    BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+    // Constructs the element in place, arguments are left untouched when the queue is full
+    template <typename... Args>
+    bool TryEmplace(Args &&...args)
+    {
+        Cell *cell;
+        size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+        new (cell->storage) T(std::forward<Args>(args)...);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool TryPop(T &value)
+    {
+        Cell *cell;
+        size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeuePos_.load(std::memory_order_relaxed);
+            }
+        }
+        value = std::move(*cell->value());
+        cell->value()->~T();
+        cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool Empty() const
+    {
+        return SizeApprox() == 0;
+    }
+
+    // Only exact when no other thread touches the queue
+    size_t SizeApprox() const
+    {
+        size_t enqueuePos = enqueuePos_.load(std::memory_order_acquire);
+        size_t dequeuePos = dequeuePos_.load(std::memory_order_acquire);
+        return enqueuePos > dequeuePos ? enqueuePos - dequeuePos : 0;
+    }
+
+    size_t capacity() const
+    {
+        return capacity_;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        alignas(T) std::byte storage[sizeof(T)];
+
+        T *value()
+        {
+            return std::launder(reinterpret_cast<T *>(storage));
+        }
+    };
+
+    alignas(GDF_CACHE_LINE_SIZE) std::atomic<size_t> enqueuePos_;
+    alignas(GDF_CACHE_LINE_SIZE) std::atomic<size_t> dequeuePos_;
+    alignas(GDF_CACHE_LINE_SIZE) std::unique_ptr<Cell[]> cells_;
+    size_t capacity_;
+    size_t mask_;
+};
+
+} // namespace gdf
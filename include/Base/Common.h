@@ -5,3 +5,4 @@
 
 #define GDF_EXTERN extern
 #define GDF_INLINE inline
+#define GDF_CACHE_LINE_SIZE 64
@@ -11,6 +11,9 @@ namespace File
 {
 std::vector<char> ReadBytes(const std::string &filename);
 
+// Writes to a temporary file next to filename and renames it over filename, readers never see a partial file
+bool WriteBytesAtomic(const std::string &filename, const void *data, size_t size);
+
 std::string GetExePath();
 
 std::string GetExeDir();
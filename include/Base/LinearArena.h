@@ -0,0 +1,140 @@
+#pragma once
+#include "Base/NonCopyable.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace gdf
+{
+
+// Bump allocator over a list of blocks. Allocate only moves a pointer, nothing is freed one by one,
+// Reset rewinds to the first block and keeps every block so a steady workload stops touching the heap.
+// Destructors of objects placed in the arena are never run.
+class LinearArena : public NonCopyable
+{
+public:
+    explicit LinearArena(size_t blockSize = 64 * 1024) : blockSize_(blockSize)
+    {
+    }
+
+    void *Allocate(size_t size, size_t alignment = alignof(std::max_align_t))
+    {
+        if (current_ < blocks_.size()) {
+            if (void *pointer = TryAllocate(blocks_[current_], size, alignment))
+                return pointer;
+        }
+        return AllocateSlow(size, alignment);
+    }
+
+    template <typename T>
+    T *Allocate(size_t count = 1)
+    {
+        return static_cast<T *>(Allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void Reset()
+    {
+        current_ = 0;
+        offset_ = 0;
+        used_ = 0;
+    }
+
+    // bytes handed out since the last Reset, without alignment padding
+    size_t used() const
+    {
+        return used_;
+    }
+
+    size_t capacity() const
+    {
+        size_t capacity = 0;
+        for (auto &block : blocks_)
+            capacity += block.size;
+        return capacity;
+    }
+
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        size_t size;
+    };
+
+    void *TryAllocate(Block &block, size_t size, size_t alignment)
+    {
+        uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+        size_t offset = ((base + offset_ + alignment - 1) & ~(alignment - 1)) - base;
+        if (offset + size > block.size)
+            return nullptr;
+        offset_ = offset + size;
+        used_ += size;
+        return block.data.get() + offset;
+    }
+
+    void *AllocateSlow(size_t size, size_t alignment)
+    {
+        // move on to the next kept block that fits, whatever is left in the skipped ones waits for Reset
+        if (current_ < blocks_.size())
+            current_++;
+        for (; current_ < blocks_.size(); current_++) {
+            offset_ = 0;
+            if (void *pointer = TryAllocate(blocks_[current_], size, alignment))
+                return pointer;
+        }
+        size_t blockSize = std::max(blockSize_, size + alignment);
+        blocks_.push_back(Block{std::unique_ptr<std::byte[]>(new std::byte[blockSize]), blockSize});
+        offset_ = 0;
+        return TryAllocate(blocks_.back(), size, alignment);
+    }
+
+    size_t blockSize_;
+    std::vector<Block> blocks_;
+    size_t current_{0};
+    size_t offset_{0};
+    size_t used_{0};
+};
+
+// std-compatible allocator that places containers in a LinearArena, deallocate is a no-op
+template <typename T>
+class ArenaAllocator
+{
+public:
+    using value_type = T;
+
+    ArenaAllocator(LinearArena &arena) noexcept : arena_(&arena)
+    {
+    }
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) noexcept : arena_(other.arena_)
+    {
+    }
+
+    T *allocate(size_t count)
+    {
+        return arena_->Allocate<T>(count);
+    }
+
+    void deallocate(T *, size_t) noexcept
+    {
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U> &other) const noexcept
+    {
+        return arena_ == other.arena_;
+    }
+
+private:
+    template <typename U>
+    friend class ArenaAllocator;
+
+    LinearArena *arena_;
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+} // namespace gdf
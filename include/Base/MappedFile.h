@@ -0,0 +1,60 @@
+#pragma once
+#include "Base/NonCopyable.h"
+#include <cstddef>
+#include <string>
+
+namespace gdf
+{
+
+// A file mapped into memory, read/write at a fixed size or read-only at its current size
+class GDF_EXPORT MappedFile : public NonCopyable
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    // Creates (or truncates) the file, sizes it to size bytes and maps it, returns false on failure.
+    // Where the file system allows, the bytes are allocated up front, so a full disk fails here instead of faulting
+    // on a write to the mapping.
+    bool Open(const std::string &path, size_t size);
+    // Maps an existing file read-only at its current size, returns false on failure or for an empty file
+    bool OpenRead(const std::string &path);
+    // Unmaps and truncates the file to usedSize bytes so readers don't see the unused tail, read-only files are kept.
+    // The file is closed either way, returns false when the truncation failed.
+    bool Close(size_t usedSize);
+    // Writes the dirty pages back to the file, safe to call from a crash handler path
+    void Sync();
+
+    bool isOpen() const
+    {
+        return data_ != nullptr;
+    }
+
+    char *data()
+    {
+        return data_;
+    }
+
+    const char *data() const
+    {
+        return data_;
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+private:
+    char *data_{nullptr};
+    size_t size_{0};
+    bool readOnly_{false};
+#ifdef _WIN32
+    void *file_{nullptr};
+    void *mapping_{nullptr};
+#else
+    int file_{-1};
+#endif
+};
+
+} // namespace gdf
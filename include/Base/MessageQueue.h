@@ -1,67 +1,63 @@
 #pragma once
+#include "Base/BoundedQueue.h"
 #include "Base/Common.h"
-#include <functional>
-#include <mutex>
-#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string_view>
 
 namespace gdf
 {
 
-class MessageCollector
+// Bounded lock-free multi-producer/single-consumer message channel on a BoundedQueue, worker threads report with
+// AddMessage and the main thread handles everything queued so far with Drain. Messages are copied inline into the
+// queue's cells, kMaxMessageSize bytes of text and a length each, nothing is allocated after construction.
+class GDF_EXPORT MessageCollector
 {
-    MessageCollector(size_t maxNum = 1024) : maxNum_(maxNum), frontOffset_(0)
-    {
-        msgs_.resize(maxNum_ * 3);
-    }
+public:
+    static constexpr size_t kMaxMessageSize = 240;
 
-    size_t AddMessage(std::string_view msg)
-    {
-        std::scoped_lock<std::mutex> lock(sync);
-        taskQueue.emplace_back([&, msg] {
-            msgs_[frontOffset_] = msg;
-            frontOffset_++;
-            assert(frontOffset_ <= maxNum_);
-            if (frontOffset_ >= maxNum_) {
-                frontOffset_ = 0;
-            }
-        });
-    }
+    explicit MessageCollector(size_t capacity = 1024);
 
-    void Update()
-    {
-        std::vector<std::function<void()>> tmp;
-        {
-            std::scoped_lock<std::mutex> lock(sync);
-            tmp.swap(taskQueue);
-        }
-        for (auto &task : tmp) {
-            task();
-        }
-    }
+    MessageCollector(const MessageCollector &) = delete;
+    MessageCollector &operator=(const MessageCollector &) = delete;
+
+    // Any thread. Longer messages are truncated to kMaxMessageSize, returns false when the queue is full
+    bool AddMessage(std::string_view message);
 
-    std::string_view At(size_t fromLastOffset)
+    // Consumer thread only. Calls callback(std::string_view) for up to maxCount queued messages in the order
+    // they were added, the view is only valid during the call. Returns the number of messages handled.
+    template <typename Callback>
+    size_t Drain(Callback &&callback, size_t maxCount = std::numeric_limits<size_t>::max())
     {
-        return msgs_[frontOffset_ - 1 - fromLastOffset < 0 ? frontOffset_ - 1 - fromLastOffset < 0 + maxNum_
-                                                           : frontOffset_ - 1 - fromLastOffset < 0];
+        Message message;
+        size_t handled = 0;
+        for (; handled < maxCount && queue_.TryPop(message); handled++)
+            callback(std::string_view{message.text, message.size});
+        return handled;
     }
 
-    std::vector<std::string_view> &msgs()
+    size_t SizeApprox() const
     {
-        return msgs_;
+        return queue_.SizeApprox();
     }
 
-    size_t frontOffset()
+    size_t capacity() const
     {
-        return frontOffset_;
+        return queue_.capacity();
     }
 
-public:
-    std::mutex sync;
-    std::vector<std::function<void()>> taskQueue;
+private:
+    struct Message {
+        Message() = default;
+        // truncated to kMaxMessageSize, built straight in the queue's cell
+        explicit Message(std::string_view message);
+
+        uint16_t size;
+        char text[kMaxMessageSize];
+    };
 
-    size_t frontOffset_;
-    std::vector<std::string_view> msgs_;
-    size_t maxNum_;
+    BoundedQueue<Message> queue_;
 };
 
-} // namespace gdf
\ No newline at end of file
+} // namespace gdf
@@ -0,0 +1,99 @@
+#pragma once
+#include "Base/Common.h"
+#include <cstdint>
+#include <vector>
+
+namespace gdf
+{
+
+// Two-level segregated fit (TLSF) allocator over an abstract range [0, size). It never touches the memory itself,
+// callers use the offsets to place resources inside something they own (a VkDeviceMemory block, a big buffer...).
+// Allocate and Free are O(1): free ranges are binned by size class with two bitmaps to find a fitting bin, and
+// neighbouring free ranges are merged on Free.
+class GDF_EXPORT OffsetAllocator
+{
+public:
+    static constexpr uint32_t kInvalidNode = UINT32_MAX;
+
+    struct Allocation {
+        uint64_t offset{0};
+        uint32_t node{kInvalidNode};
+
+        bool valid() const
+        {
+            return node != kInvalidNode;
+        }
+    };
+
+    struct Statistics {
+        uint64_t size{0};
+        uint64_t usedSize{0};
+        uint64_t freeSize{0};
+        uint64_t largestFreeRange{0};
+        uint32_t allocationCount{0};
+        uint32_t freeRangeCount{0};
+
+        // 0 when all free space is one range, close to 1 when it is scattered in small pieces
+        float fragmentation() const
+        {
+            return freeSize == 0 ? 0.0f : 1.0f - static_cast<float>(largestFreeRange) / static_cast<float>(freeSize);
+        }
+    };
+
+    explicit OffsetAllocator(uint64_t size);
+
+    // Returns an invalid allocation when no free range fits, alignment must be a power of two
+    Allocation Allocate(uint64_t size, uint64_t alignment = 1);
+    void Free(Allocation allocation);
+
+    uint64_t allocationSize(Allocation allocation) const
+    {
+        return nodes_[allocation.node].size;
+    }
+
+    bool empty() const
+    {
+        return allocationCount_ == 0;
+    }
+
+    uint64_t size() const
+    {
+        return size_;
+    }
+
+    Statistics statistics() const;
+
+private:
+    static constexpr uint32_t kSecondLevelBits = 4;
+    static constexpr uint32_t kSecondLevelCount = 1 << kSecondLevelBits;
+    static constexpr uint32_t kFirstLevelCount = 64 - kSecondLevelBits + 1;
+
+    struct Node {
+        uint64_t offset;
+        uint64_t size;
+        // neighbours in address order
+        uint32_t prevRange{kInvalidNode};
+        uint32_t nextRange{kInvalidNode};
+        // links inside a size class bin, only meaningful while free
+        uint32_t prevFree{kInvalidNode};
+        uint32_t nextFree{kInvalidNode};
+        bool free{false};
+    };
+
+    static void Mapping(uint64_t size, uint32_t &firstLevel, uint32_t &secondLevel);
+    uint32_t FindFreeNode(uint64_t size) const;
+    uint32_t NewNode(uint64_t offset, uint64_t size);
+    void InsertFree(uint32_t node);
+    void RemoveFree(uint32_t node);
+
+    uint64_t size_;
+    uint64_t usedSize_{0};
+    uint32_t allocationCount_{0};
+    uint64_t firstLevelBitmap_{0};
+    uint32_t secondLevelBitmaps_[kFirstLevelCount]{};
+    uint32_t bins_[kFirstLevelCount][kSecondLevelCount];
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> unusedNodes_;
+};
+
+} // namespace gdf
@@ -1,6 +1,240 @@
 #pragma once
+#include "Base/NonCopyable.h"
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
 
-class Pool
+namespace gdf
 {
 
+template <typename T, size_t kSlabSize, size_t kCacheSize>
+class SharedObjectPool;
+
+// Typed slab allocator. Objects live in slabs of kSlabSize slots, freed slots are chained through an intrusive
+// free list, so New and Delete are O(1) and neighbours allocated together stay close in memory.
+// Release (and the destructor) destroys every object still alive and hands the slabs back in one go.
+// Not thread safe, see SharedObjectPool.
+template <typename T, size_t kSlabSize = 256>
+class ObjectPool : public NonCopyable
+{
+public:
+    ObjectPool() = default;
+
+    ~ObjectPool()
+    {
+        Release();
+    }
+
+    template <typename... Args>
+    T *New(Args &&...args)
+    {
+        Slot *slot = AllocateSlot();
+        T *object;
+        try {
+            object = new (slot->storage) T(std::forward<Args>(args)...);
+        } catch (...) {
+            FreeSlot(slot);
+            throw;
+        }
+        slot->next = slot;
+        return object;
+    }
+
+    void Delete(T *object)
+    {
+        if (object == nullptr)
+            return;
+        object->~T();
+        FreeSlot(reinterpret_cast<Slot *>(object));
+    }
+
+    void Release()
+    {
+        for (size_t i = 0; i < slabs_.size(); i++) {
+            size_t used = i + 1 == slabs_.size() ? lastSlabUsed_ : kSlabSize;
+            for (size_t j = 0; j < used; j++) {
+                Slot &slot = slabs_[i][j];
+                if (slot.next == &slot)
+                    reinterpret_cast<T *>(slot.storage)->~T();
+            }
+        }
+        slabs_.clear();
+        freeList_ = nullptr;
+        lastSlabUsed_ = kSlabSize;
+        size_ = 0;
+    }
+
+    // slots handed out and not freed yet
+    size_t size() const
+    {
+        return size_;
+    }
+
+    size_t capacity() const
+    {
+        return slabs_.size() * kSlabSize;
+    }
+
+private:
+    template <typename, size_t, size_t>
+    friend class SharedObjectPool;
+
+    // A live slot points at itself, a free one at the next free slot
+    struct Slot {
+        alignas(T) std::byte storage[sizeof(T)];
+        Slot *next;
+    };
+
+    Slot *AllocateSlot()
+    {
+        size_++;
+        if (freeList_ != nullptr) {
+            Slot *slot = freeList_;
+            freeList_ = slot->next;
+            return slot;
+        }
+        if (lastSlabUsed_ == kSlabSize) {
+            slabs_.emplace_back(new Slot[kSlabSize]);
+            lastSlabUsed_ = 0;
+        }
+        return &slabs_.back()[lastSlabUsed_++];
+    }
+
+    void FreeSlot(Slot *slot)
+    {
+        size_--;
+        slot->next = freeList_;
+        freeList_ = slot;
+    }
+
+    std::vector<std::unique_ptr<Slot[]>> slabs_;
+    Slot *freeList_{nullptr};
+    size_t lastSlabUsed_{kSlabSize};
+    size_t size_{0};
+};
+
+// Thread safe ObjectPool. New/Delete on the pool take a lock, a thread allocating a lot keeps its own Cache
+// that moves free slots to and from the pool kCacheSize at a time. Objects may be deleted from any thread or
+// cache. Every Cache has to be destroyed before Release or the pool itself.
+template <typename T, size_t kSlabSize = 256, size_t kCacheSize = 32>
+class SharedObjectPool : public NonCopyable
+{
+    using Pool = ObjectPool<T, kSlabSize>;
+    using Slot = typename Pool::Slot;
+
+public:
+    class Cache : public NonCopyable
+    {
+    public:
+        explicit Cache(SharedObjectPool &pool) : pool_(pool)
+        {
+        }
+
+        ~Cache()
+        {
+            pool_.ReturnSlots(freeList_);
+        }
+
+        template <typename... Args>
+        T *New(Args &&...args)
+        {
+            if (freeList_ == nullptr)
+                count_ = pool_.TakeSlots(freeList_, kCacheSize);
+            Slot *slot = freeList_;
+            freeList_ = slot->next;
+            count_--;
+            T *object;
+            try {
+                object = new (slot->storage) T(std::forward<Args>(args)...);
+            } catch (...) {
+                PushSlot(slot);
+                throw;
+            }
+            slot->next = slot;
+            return object;
+        }
+
+        void Delete(T *object)
+        {
+            if (object == nullptr)
+                return;
+            object->~T();
+            PushSlot(reinterpret_cast<Slot *>(object));
+        }
+
+    private:
+        void PushSlot(Slot *slot)
+        {
+            slot->next = freeList_;
+            freeList_ = slot;
+            if (++count_ >= kCacheSize * 2) {
+                Slot *keep = freeList_;
+                for (size_t i = 1; i < kCacheSize; i++)
+                    keep = keep->next;
+                Slot *surplus = keep->next;
+                keep->next = nullptr;
+                pool_.ReturnSlots(surplus);
+                count_ = kCacheSize;
+            }
+        }
+
+        SharedObjectPool &pool_;
+        Slot *freeList_{nullptr};
+        size_t count_{0};
+    };
+
+    template <typename... Args>
+    T *New(Args &&...args)
+    {
+        std::scoped_lock<std::mutex> lock(sync_);
+        return pool_.New(std::forward<Args>(args)...);
+    }
+
+    void Delete(T *object)
+    {
+        std::scoped_lock<std::mutex> lock(sync_);
+        pool_.Delete(object);
+    }
+
+    void Release()
+    {
+        std::scoped_lock<std::mutex> lock(sync_);
+        pool_.Release();
+    }
+
+    size_t capacity()
+    {
+        std::scoped_lock<std::mutex> lock(sync_);
+        return pool_.capacity();
+    }
+
+private:
+    size_t TakeSlots(Slot *&list, size_t count)
+    {
+        std::scoped_lock<std::mutex> lock(sync_);
+        for (size_t i = 0; i < count; i++) {
+            Slot *slot = pool_.AllocateSlot();
+            slot->next = list;
+            list = slot;
+        }
+        return count;
+    }
+
+    void ReturnSlots(Slot *list)
+    {
+        std::scoped_lock<std::mutex> lock(sync_);
+        while (list != nullptr) {
+            Slot *next = list->next;
+            pool_.FreeSlot(list);
+            list = next;
+        }
+    }
+
+    std::mutex sync_;
+    Pool pool_;
 };
+
+} // namespace gdf
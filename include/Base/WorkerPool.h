@@ -0,0 +1,63 @@
+#pragma once
+#include "Base/NonCopyable.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gdf
+{
+
+// A fixed set of worker threads that run ParallelFor jobs together with the calling thread.
+// Items are handed out in chunks of grainSize from a shared counter, so items of uneven cost still balance. Which
+// thread runs an item is not fixed, a job whose items only write their own outputs gives the same result for any
+// thread count.
+// One job at a time, ParallelFor must not be called from inside a job.
+class GDF_EXPORT WorkerPool : public NonCopyable
+{
+public:
+    // Runs items [first, last), called on any thread of the pool
+    using RangeFunction = std::function<void(uint32_t first, uint32_t last)>;
+
+    ~WorkerPool();
+
+    // threadCount includes the calling thread, 1 runs every job inline. The workers show up as threadName in profiles.
+    void Create(uint32_t threadCount, const char *threadName = "Worker");
+    void Destroy();
+
+    // Runs function over [0, itemCount) and blocks until every item is done, rethrows the first exception of the job
+    void ParallelFor(uint32_t itemCount, uint32_t grainSize, const RangeFunction &function);
+
+    uint32_t threadCount() const
+    {
+        return threadCount_;
+    }
+
+private:
+    void WorkerLoop();
+    void RunChunks();
+
+    uint32_t threadCount_{0};
+    const char *threadName_{nullptr};
+    std::vector<std::thread> workers_;
+
+    std::mutex mutex_;
+    std::condition_variable startCondition_;
+    std::condition_variable doneCondition_;
+    uint64_t jobSerial_{0};
+    uint32_t pendingWorkers_{0};
+    bool stopping_{false};
+    std::exception_ptr workerException_;
+
+    // job being run, written before jobSerial_ is bumped. nextItem_ has 64 bits so chunks past the end never wrap
+    std::atomic<uint64_t> nextItem_{0};
+    uint32_t jobItemCount_{0};
+    uint32_t jobGrainSize_{1};
+    const RangeFunction *jobFunction_{nullptr};
+};
+
+} // namespace gdf
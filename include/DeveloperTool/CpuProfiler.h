@@ -0,0 +1,165 @@
+#pragma once
+#include "Base/Common.h"
+
+// Scoped CPU zones, compiled out unless the GDF_ENABLE_PROFILER CMake option is on.
+// GDF_PROFILE_ZONE("name") times the rest of the enclosing block, zones nest and may be opened on any thread.
+// GDF_PROFILE_FRAME() closes a frame, call it once per frame on the main thread.
+#ifdef GDF_ENABLE_PROFILER
+#define GDF_PROFILE_CONCAT_IMPL(a, b) a##b
+#define GDF_PROFILE_CONCAT(a, b) GDF_PROFILE_CONCAT_IMPL(a, b)
+#define GDF_PROFILE_ZONE(NAME) ::gdf::CpuProfileZone GDF_PROFILE_CONCAT(gdfProfileZone, __LINE__)(NAME)
+#define GDF_PROFILE_FUNCTION() GDF_PROFILE_ZONE(__func__)
+#define GDF_PROFILE_FRAME()                                                                                                    \
+    do {                                                                                                                       \
+        if (::gdf::CpuProfiler::pInstance() != nullptr)                                                                        \
+            ::gdf::CpuProfiler::instance().FrameMark();                                                                        \
+    } while (0)
+#define GDF_PROFILE_THREAD(NAME) ::gdf::CpuProfiler::SetThreadName(NAME)
+#else
+#define GDF_PROFILE_ZONE(NAME)
+#define GDF_PROFILE_FUNCTION()
+#define GDF_PROFILE_FRAME()
+#define GDF_PROFILE_THREAD(NAME)
+#endif // GDF_ENABLE_PROFILER
+
+#ifdef GDF_ENABLE_PROFILER
+#include "Base/Singleton.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace gdf
+{
+
+// Collects the zones of every thread. A thread writes finished zones into its own ring buffer without locking,
+// FrameMark drains the rings on the main thread and keeps the last frame for the panel and, while capturing, every
+// zone for a Chrome trace (chrome://tracing, Perfetto). A zone ending while its thread's ring is full is dropped.
+class GDF_EXPORT CpuProfiler : public Singleton<CpuProfiler>
+{
+public:
+    // zones a thread can have finished between two FrameMark calls
+    static constexpr size_t kThreadBufferSize = 16 * 1024;
+    static constexpr size_t kMaxCaptureEvents = 1024 * 1024;
+    static constexpr size_t kFrameHistorySize = 256;
+
+    struct Event {
+        // static storage, a string literal or __func__
+        const char *name{nullptr};
+        // nanoseconds on the steady clock
+        uint64_t begin{0};
+        uint64_t end{0};
+        uint32_t depth{0};
+        uint32_t thread{0};
+    };
+
+    CpuProfiler();
+    ~CpuProfiler();
+
+    static uint64_t Now();
+    // Names the calling thread in the panel and in exported traces
+    static void SetThreadName(const char *name);
+
+    void FrameMark();
+
+    void paused(bool paused)
+    {
+        paused_ = paused;
+    }
+    bool paused() const
+    {
+        return paused_;
+    }
+
+    // Zones of every thread that ended within the last finished frame
+    const std::vector<Event> &frameEvents() const
+    {
+        return frameEvents_;
+    }
+    uint64_t frameBegin() const
+    {
+        return frameBegin_;
+    }
+    uint64_t frameEnd() const
+    {
+        return frameEnd_;
+    }
+    uint64_t droppedCount() const;
+
+    // Capture keeps every zone drained from now on until ExportChromeTrace, up to kMaxCaptureEvents
+    void BeginCapture();
+    bool capturing() const
+    {
+        return capturing_;
+    }
+    // Writes the captured zones as Chrome trace JSON and ends the capture
+    bool ExportChromeTrace(const std::string &path);
+
+    // Flame graph of the last frame, call between ImGui::NewFrame and ImGui::Render
+    void DrawImGui();
+
+    // Hot path of CpuProfileZone
+    void BeginZone();
+    void EndZone(const char *name, uint64_t begin);
+
+private:
+    struct ThreadBuffer {
+        uint32_t index{0};
+        std::string name;
+        uint32_t depth{0};
+        std::unique_ptr<Event[]> events{new Event[kThreadBufferSize]};
+        // single producer (the thread) and single consumer (FrameMark)
+        alignas(GDF_CACHE_LINE_SIZE) std::atomic<uint64_t> write{0};
+        alignas(GDF_CACHE_LINE_SIZE) std::atomic<uint64_t> read{0};
+        std::atomic<uint64_t> dropped{0};
+    };
+
+    ThreadBuffer *threadBuffer();
+    void Drain(std::vector<Event> &events);
+
+    mutable std::mutex threadsMutex_;
+    std::vector<std::unique_ptr<ThreadBuffer>> threads_;
+    // a thread_local buffer pointer is only trusted when it was registered with this generation of the profiler
+    uint64_t generation_{0};
+
+    bool paused_{false};
+    bool capturing_{false};
+    uint64_t lastMark_{0};
+    uint64_t frameBegin_{0};
+    uint64_t frameEnd_{0};
+    std::vector<Event> drained_;
+    std::vector<Event> frameEvents_;
+    std::vector<Event> captureEvents_;
+    std::vector<float> frameHistory_;
+    size_t frameHistoryNext_{0};
+};
+
+// RAII zone behind GDF_PROFILE_ZONE
+class CpuProfileZone
+{
+public:
+    explicit CpuProfileZone(const char *name) : name_(name)
+    {
+        if (CpuProfiler *pProfiler = CpuProfiler::pInstance()) {
+            pProfiler->BeginZone();
+            begin_ = CpuProfiler::Now();
+        }
+    }
+    ~CpuProfileZone()
+    {
+        if (begin_ != 0) {
+            if (CpuProfiler *pProfiler = CpuProfiler::pInstance())
+                pProfiler->EndZone(name_, begin_);
+        }
+    }
+    CpuProfileZone(const CpuProfileZone &) = delete;
+    CpuProfileZone &operator=(const CpuProfileZone &) = delete;
+
+private:
+    const char *name_;
+    uint64_t begin_{0};
+};
+
+} // namespace gdf
+#endif // GDF_ENABLE_PROFILER
@@ -3,7 +3,9 @@
 #include "Log/LogCategory.h"
 #include "Log/LogLevel.h"
 #include "Log/LogSink.h"
-#include <deque>
+#include <mutex>
+#include <string_view>
+#include <vector>
 
 namespace gdf
 {
@@ -28,18 +30,55 @@ public:
 
     void maxEntries(size_t maxEntries);
 
+    struct EntryView {
+        const LogCategory *category;
+        LogLevel level;
+        // points into the history arena, only valid during the ForEachEntry callback
+        std::string_view message;
+    };
+
+    size_t entryCount();
+    // Calls callback(const EntryView &) for every retained entry, oldest first. The history stays locked during the
+    // calls, so a drain thread logging into the console can't overwrite a message being read. The callback must not log.
+    template <typename Callback>
+    void ForEachEntry(Callback &&callback)
+    {
+        std::scoped_lock<std::mutex> lock(sync_);
+        for (size_t i = 0; i < count_; i++) {
+            const Entry &entry = entries_[(head_ + i) % maxEntries_];
+            callback(EntryView{entry.category, entry.level, std::string_view{arena_.data() + entry.offset, entry.size}});
+        }
+    }
+
+    // Bytes reserved for the history, fixed for a given maxEntries
+    size_t memoryUsage();
+
     DeveloperConsole &Instance();
 
+    // Arena bytes reserved per entry, a message longer than the whole arena is truncated
+    static constexpr size_t kArenaBytesPerEntry = 256;
+
 private:
     struct Entry {
         const LogCategory *category;
         LogLevel level;
-        std::string_view message;
+        uint32_t offset;
+        uint32_t size;
     };
 
+    void Reserve(size_t maxEntries);
+    void PopOldest();
+    // The oldest entry that holds arena bytes, as a count of entries from head_. count_ when every entry is empty.
+    size_t OldestWithBytes() const;
+
     size_t maxEntries_;
     std::mutex sync_;
-    std::deque<Entry> entries_;
+    // messages are copied into one contiguous byte ring, entries_ is a ring of views into it
+    std::vector<char> arena_;
+    std::vector<Entry> entries_;
+    size_t head_{0};
+    size_t count_{0};
+    size_t writeOffset_{0};
 };
 
 } // namespace gdf
@@ -0,0 +1,74 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace gdf
+{
+
+// glTF accessor componentType values
+enum AccessorComponentType : int
+{
+    kComponentByte = 5120,
+    kComponentUnsignedByte = 5121,
+    kComponentShort = 5122,
+    kComponentUnsignedShort = 5123,
+    kComponentUnsignedInt = 5125,
+    kComponentFloat = 5126,
+};
+
+// Bytes of one component of componentType
+constexpr size_t AccessorComponentSize(int componentType)
+{
+    switch (componentType) {
+    case kComponentByte:
+    case kComponentUnsignedByte:
+        return 1;
+    case kComponentShort:
+    case kComponentUnsignedShort:
+        return 2;
+    default:
+        return 4;
+    }
+}
+
+// One strided stream of accessor elements, componentCount components of componentType each
+struct AccessorStream {
+    const uint8_t *data{nullptr};
+    size_t stride{0};
+    int componentType{kComponentFloat};
+    uint32_t componentCount{0};
+    // integer components map to [0, 1] or [-1, 1] instead of keeping their value
+    bool normalized{false};
+};
+
+// Instruction sets the decode kernels are built for, the best one the CPU supports is picked on first use.
+// Every set gives bit-identical results.
+enum class AccessorKernelSet
+{
+    Scalar,
+    SSE41,
+    AVX2,
+};
+
+// Decodes count elements to floats, element i goes to destination + i * destinationStride bytes.
+// Components the stream lacks are filled with 0, the fourth with 1, the way glTF widens vec3 colors.
+void DecodeAccessor(const AccessorStream &source,
+                    float *destination,
+                    size_t destinationStride,
+                    uint32_t destinationComponents,
+                    uint32_t count);
+// Writes the first destinationComponents floats of value to count elements
+void FillAccessor(
+    const float *value, float *destination, size_t destinationStride, uint32_t destinationComponents, uint32_t count);
+// Scales count vec3 to unit length in place
+void NormalizeVectors(float *vectors, size_t stride, uint32_t count);
+// Widens tightly packed u8, u16 or u32 indices to u32 and adds base
+void WidenIndices(const uint8_t *source, int componentType, uint32_t count, uint32_t base, uint32_t *destination);
+
+AccessorKernelSet accessorKernelSet();
+bool AccessorKernelSetSupported(AccessorKernelSet kernelSet);
+// Switches the kernels for benchmarks and tests, false when the CPU lacks the set. Not while anything decodes.
+bool SetAccessorKernelSet(AccessorKernelSet kernelSet);
+const char *AccessorKernelSetName(AccessorKernelSet kernelSet);
+
+} // namespace gdf
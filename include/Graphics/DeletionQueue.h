@@ -0,0 +1,79 @@
+#pragma once
+#include "Base/NonCopyable.h"
+#include "Graphics/DeviceMemoryAllocator.h"
+#include "Graphics/VulkanApi.h"
+#include <deque>
+
+namespace gdf
+{
+
+struct VulkanDevice;
+class FrameSync;
+
+// Vulkan objects whose last use may still be executing, destroyed once the frame that last used them has retired.
+// Streaming, hot reload and resizes hand their old objects over here instead of waiting for the device to go idle.
+// Entries are destroyed in the order they were queued, queue a view before its image and both before their memory.
+// Not thread safe, queue from the thread that drives the frames.
+class GDF_EXPORT DeletionQueue : public NonCopyable
+{
+public:
+    // lastUsedFrame default, the frame being built, which also covers every frame submitted so far
+    static constexpr uint64_t kCurrentFrame = UINT64_MAX;
+
+    void Create(VulkanDevice *device, FrameSync *frameSync);
+    // Destroys everything still queued, the device must be idle
+    void Destroy();
+
+    // lastUsedFrame is a FrameSync frame value, 0 for an object no frame has used
+    void Enqueue(VkBuffer buffer, uint64_t lastUsedFrame = kCurrentFrame);
+    void Enqueue(VkImage image, uint64_t lastUsedFrame = kCurrentFrame);
+    void Enqueue(VkImageView imageView, uint64_t lastUsedFrame = kCurrentFrame);
+    void Enqueue(VkSampler sampler, uint64_t lastUsedFrame = kCurrentFrame);
+    void Enqueue(VkFramebuffer framebuffer, uint64_t lastUsedFrame = kCurrentFrame);
+    void Enqueue(VkRenderPass renderPass, uint64_t lastUsedFrame = kCurrentFrame);
+    void Enqueue(VkPipeline pipeline, uint64_t lastUsedFrame = kCurrentFrame);
+    void Enqueue(VkPipelineLayout pipelineLayout, uint64_t lastUsedFrame = kCurrentFrame);
+    void Enqueue(VkCommandPool commandPool, uint64_t lastUsedFrame = kCurrentFrame);
+    void Enqueue(VkSwapchainKHR swapchain, uint64_t lastUsedFrame = kCurrentFrame);
+    void Enqueue(const DeviceAllocation &allocation, uint64_t lastUsedFrame = kCurrentFrame);
+
+    // Destroys what the retired frames no longer use, call once per frame
+    void Collect();
+
+    size_t pendingCount() const
+    {
+        return entries_.size();
+    }
+
+private:
+    enum class Kind : uint8_t
+    {
+        Buffer,
+        Image,
+        ImageView,
+        Sampler,
+        Framebuffer,
+        RenderPass,
+        Pipeline,
+        PipelineLayout,
+        CommandPool,
+        Swapchain,
+        Allocation,
+    };
+    struct Entry {
+        uint64_t frame{0};
+        Kind kind{Kind::Buffer};
+        uint64_t handle{0};
+        DeviceAllocation allocation;
+    };
+
+    template <typename T>
+    void Push(Kind kind, T handle, uint64_t lastUsedFrame);
+    void DestroyEntry(Entry &entry);
+
+    VulkanDevice *device_{nullptr};
+    FrameSync *frameSync_{nullptr};
+    std::deque<Entry> entries_;
+};
+
+} // namespace gdf
@@ -0,0 +1,90 @@
+#pragma once
+#include "Base/NonCopyable.h"
+#include "Base/OffsetAllocator.h"
+#include "Graphics/VulkanApi.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace gdf
+{
+
+// Buffers and linear images may not share a bufferImageGranularity page with optimal tiling images,
+// blocks only ever hold one kind so the granularity never needs padding
+enum class DeviceResourceKind : uint8_t
+{
+    Linear,
+    Optimal,
+};
+
+struct DeviceAllocation {
+    VkDeviceMemory memory{VK_NULL_HANDLE};
+    VkDeviceSize offset{0};
+    VkDeviceSize size{0};
+    // host visible memory is mapped once for the block lifetime, this already points at offset
+    void *mapped{nullptr};
+    uint32_t memoryType{UINT32_MAX};
+    // UINT32_MAX for dedicated allocations
+    uint32_t block{UINT32_MAX};
+    OffsetAllocator::Allocation range;
+};
+
+// Sub-allocates resources from large VkDeviceMemory blocks per memory type, with a TLSF OffsetAllocator per block,
+// so loading assets no longer costs one vkAllocateMemory (and one entry of maxMemoryAllocationCount) per resource.
+// Resources of at least half a block get a dedicated allocation.
+class GDF_EXPORT DeviceMemoryAllocator : public NonCopyable
+{
+public:
+    static constexpr VkDeviceSize kDefaultBlockSize = 64 * 1024 * 1024;
+
+    struct Statistics {
+        uint32_t blockCount{0};
+        uint32_t dedicatedCount{0};
+        uint32_t allocationCount{0};
+        VkDeviceSize blockBytes{0};
+        VkDeviceSize usedBytes{0};
+        VkDeviceSize dedicatedBytes{0};
+        VkDeviceSize largestFreeRange{0};
+        // free bytes of the blocks that are not part of their block's largest free range, over all free bytes
+        float fragmentation{0.0f};
+    };
+
+    void Initialize(VkDevice device,
+                    const VkPhysicalDeviceMemoryProperties &memoryProperties,
+                    VkDeviceSize bufferImageGranularity,
+                    VkDeviceSize blockSize = kDefaultBlockSize);
+    // Frees every block, all allocations must have been freed (or abandoned with their resources)
+    void Destroy();
+
+    DeviceAllocation Allocate(const VkMemoryRequirements &requirements,
+                              uint32_t memoryType,
+                              DeviceResourceKind kind,
+                              bool dedicated = false);
+    void Free(DeviceAllocation &allocation);
+
+    Statistics statistics();
+
+private:
+    struct Block {
+        VkDeviceMemory memory{VK_NULL_HANDLE};
+        void *mapped{nullptr};
+        uint32_t memoryType{UINT32_MAX};
+        DeviceResourceKind kind{DeviceResourceKind::Linear};
+        std::unique_ptr<OffsetAllocator> ranges;
+    };
+
+    VkDeviceMemory AllocateMemory(VkDeviceSize size, uint32_t memoryType, void **mapped);
+    VkDeviceSize BlockSize(uint32_t memoryType);
+
+    VkDevice device_{VK_NULL_HANDLE};
+    VkPhysicalDeviceMemoryProperties memoryProperties_{};
+    bool separateKinds_{false};
+    VkDeviceSize blockSize_{kDefaultBlockSize};
+    std::mutex sync_;
+    // destroyed blocks leave an empty slot (memory == VK_NULL_HANDLE) so block indices stay valid
+    std::vector<Block> blocks_;
+    uint32_t dedicatedCount_{0};
+    VkDeviceSize dedicatedBytes_{0};
+};
+
+} // namespace gdf
@@ -0,0 +1,73 @@
+#pragma once
+#include "Base/NonCopyable.h"
+#include "Graphics/VulkanApi.h"
+#include <vector>
+
+namespace gdf
+{
+
+struct VulkanDevice;
+
+// Frame pacing on one timeline semaphore. Frame N, counting from 1, signals value N once its submission has finished,
+// so asking whether a frame has retired is one counter read, which is what deferred deletion, upload reclamation and
+// query readback need. Devices without VK_KHR_timeline_semaphore fall back to one binary fence per frame slot.
+// Frames are submitted to one queue, they retire in submission order.
+class GDF_EXPORT FrameSync : public NonCopyable
+{
+public:
+    // signal semaphores a frame's VkSubmitInfo may carry besides the frame value
+    static constexpr uint32_t kMaxSignalSemaphores = 8;
+
+    void Create(VulkanDevice *device, uint32_t framesInFlight);
+    void Destroy();
+
+    // Blocks until the previous frame of the current slot has retired, the slot's resources are free after that
+    void WaitFrameSlot();
+    // Submits the frame being built, signalling its value on completion, and moves on to the next frame slot
+    void Submit(VkQueue queue, const VkSubmitInfo &submitInfo);
+
+    bool IsRetired(uint64_t frame);
+    // frame must have been submitted, 0 returns at once
+    void Wait(uint64_t frame);
+
+    uint32_t framesInFlight() const
+    {
+        return framesInFlight_;
+    }
+    // Slot of the frame being built, indexes the per-frame resources
+    uint32_t frameSlot() const
+    {
+        return static_cast<uint32_t>(submittedFrame_ % framesInFlight_);
+    }
+    // Value of the frame being built
+    uint64_t nextFrame() const
+    {
+        return submittedFrame_ + 1;
+    }
+    // Value of the newest submitted frame, 0 before the first submission
+    uint64_t submittedFrame() const
+    {
+        return submittedFrame_;
+    }
+    bool timeline() const
+    {
+        return timelineSemaphore_ != VK_NULL_HANDLE;
+    }
+
+private:
+    VulkanDevice *device_{nullptr};
+    uint32_t framesInFlight_{0};
+    uint64_t submittedFrame_{0};
+    // every frame up to this one is known to have retired
+    uint64_t retiredFrame_{0};
+
+    VkSemaphore timelineSemaphore_{VK_NULL_HANDLE};
+    PFN_vkGetSemaphoreCounterValueKHR fpGetSemaphoreCounterValueKHR_{nullptr};
+    PFN_vkWaitSemaphoresKHR fpWaitSemaphoresKHR_{nullptr};
+
+    // fallback, the fence of a slot and the frame last submitted with it
+    std::vector<VkFence> fences_;
+    std::vector<uint64_t> fenceFrames_;
+};
+
+} // namespace gdf
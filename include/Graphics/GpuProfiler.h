@@ -0,0 +1,127 @@
+#pragma once
+#include "Base/NonCopyable.h"
+#include "Graphics/VulkanApi.h"
+#include <array>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gdf
+{
+
+struct VulkanDevice;
+
+// GPU timings of named command buffer regions from timestamp queries, one query pool per frame slot.
+// A slot's results are read back once its fence has signalled, so reading them never stalls the GPU or the CPU.
+// Scopes of one slot may span several command buffers as long as they are submitted to the same queue in order.
+// Not thread safe, record scopes from the thread that records the frame.
+class GDF_EXPORT GpuProfiler : public NonCopyable
+{
+public:
+    static constexpr uint32_t kMaxScopes = 64;
+    // frames kept per scope name for the averages and percentiles
+    static constexpr uint32_t kHistorySize = 256;
+
+    struct TimelineEntry {
+        const char *name{nullptr};
+        uint32_t depth{0};
+        // milliseconds from the first timestamp of the frame
+        double beginMs{0.0};
+        double durationMs{0.0};
+    };
+
+    struct ScopeStatistics {
+        std::string name;
+        uint32_t sampleCount{0};
+        double lastMs{0.0};
+        double averageMs{0.0};
+        double p50Ms{0.0};
+        double p95Ms{0.0};
+        double p99Ms{0.0};
+    };
+
+    // queueFamilyIndex is the family the scopes are submitted to, without timestamp support the profiler stays off
+    void Create(VulkanDevice *device, uint32_t queueFamilyIndex, uint32_t frameCount);
+    void Destroy();
+
+    // Reads back the finished results of the slot, call only after the slot's fence has signalled
+    void Resolve(uint32_t frameSlot);
+    // Resolves the slot and resets its queries, record before any scope and outside a render pass
+    void BeginFrame(uint32_t frameSlot, VkCommandBuffer commandBuffer);
+    // name must outlive the profiler, a string literal in practice
+    void BeginScope(VkCommandBuffer commandBuffer, const char *name);
+    void EndScope(VkCommandBuffer commandBuffer);
+
+    bool enabled() const
+    {
+        return !frames_.empty();
+    }
+    // Scopes of the newest resolved frame in recording order
+    const std::vector<TimelineEntry> &timeline() const
+    {
+        return timeline_;
+    }
+    double frameMs() const
+    {
+        return frameMs_;
+    }
+    std::vector<ScopeStatistics> statistics() const;
+
+    // Timeline and statistics window, call between ImGui::NewFrame and ImGui::Render
+    void DrawImGui();
+
+    // RAII scope
+    class Scope : public NonCopyable
+    {
+    public:
+        Scope(GpuProfiler &profiler, VkCommandBuffer commandBuffer, const char *name)
+            : profiler_(profiler), commandBuffer_(commandBuffer)
+        {
+            profiler_.BeginScope(commandBuffer_, name);
+        }
+        ~Scope()
+        {
+            profiler_.EndScope(commandBuffer_);
+        }
+
+    private:
+        GpuProfiler &profiler_;
+        VkCommandBuffer commandBuffer_;
+    };
+
+private:
+    struct RecordedScope {
+        const char *name{nullptr};
+        uint32_t depth{0};
+        // query of the begin timestamp, the end timestamp is the next one
+        uint32_t query{0};
+    };
+
+    struct Frame {
+        VkQueryPool queryPool{VK_NULL_HANDLE};
+        std::vector<RecordedScope> scopes;
+        // set by BeginFrame, cleared once the results are read
+        bool recorded{false};
+    };
+
+    struct History {
+        std::array<double, kHistorySize> samples{};
+        uint32_t count{0};
+        uint32_t next{0};
+        double lastMs{0.0};
+    };
+
+    VulkanDevice *device_{nullptr};
+    std::vector<Frame> frames_;
+    uint32_t current_{0};
+    // open scopes of the current frame, indices into its scopes
+    std::vector<uint32_t> open_;
+    uint64_t timestampMask_{0};
+    double nanosecondsPerTick_{1.0};
+    std::vector<uint64_t> results_;
+    std::vector<TimelineEntry> timeline_;
+    double frameMs_{0.0};
+    std::unordered_map<std::string, History> history_;
+};
+
+} // namespace gdf
@@ -1,9 +1,16 @@
 #pragma once
+#include "Base/LinearArena.h"
 #include "Base/Window.h"
+#include "Graphics/DeletionQueue.h"
+#include "Graphics/FrameSync.h"
+#include "Graphics/GpuProfiler.h"
+#include "Graphics/ParallelRecorder.h"
+#include "Graphics/StagingRing.h"
 #include "Graphics/VulkanApi.h"
 #include "Log/Logger.h"
 #include "VulkanDevice.h"
-#include <deque>
+#include <atomic>
+#include <memory>
 #include <mutex>
 
 #ifdef GDF_DEBUG
@@ -12,7 +19,6 @@
 #define GDF_ENABLE_VALIDATION_LAYER false
 #endif // GDF_DEBUG
 
-#define MAX_FRAMES_IN_FLIGHT 2
 struct ImDrawData;
 
 namespace gdf
@@ -30,40 +36,76 @@ class Graphics : public NonCopyable
 public:
     Graphics() = default;
     ~Graphics() = default;
-    void Initialize(Window *pWindow = nullptr, bool enableValidationLayer = GDF_ENABLE_VALIDATION_LAYER);
+    // Without a window Graphics runs headless, rendering into a ring of offscreen images of headlessExtent
+    void Initialize(Window *pWindow = nullptr,
+                    bool enableValidationLayer = GDF_ENABLE_VALIDATION_LAYER,
+                    VkExtent2D headlessExtent = {1280, 720});
 
     void FrameBegin();
     void DrawFrame();
     void FrameEnd();
+    // Resets the pool of the current frame slot, its previous submission must have finished
+    void ResetFrameCommandPool();
+    // Next primary of the current frame slot, valid until the slot's pool is reset
+    VkCommandBuffer AllocateFrameCommandBuffer();
+    // Scene render pass of the frame into commandBuffer
+    void RecordMainPass(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+    // Draws [first, last) of the scene, inline into the primary or into a secondary of parallelRecorder_
+    void RecordSceneDraws(VkCommandBuffer commandBuffer, uint32_t first, uint32_t last);
+    // 0 records the scene inline on the calling thread, otherwise into secondaries on threadCount threads.
+    // Call after Initialize, waits for the frames in flight when the count changes.
+    void SetRecordingThreads(uint32_t threadCount);
 
     void Cleanup();
 
+    bool headless() const
+    {
+        return pWindow_ == nullptr;
+    }
+    // Headless only, copies every frame drawn from now on into host memory for ReadFrame
+    void EnableReadback(bool enable)
+    {
+        readbackEnabled_ = enable;
+    }
+    // Waits for the last frame drawn with readback enabled and copies its RGBA8 pixels, rows tightly packed
+    bool ReadFrame(std::vector<uint8_t> &pixels);
+    VkExtent2D extent() const
+    {
+        return swapchainExtent_;
+    }
+
     // Initialize Funtion
     void CreateInstance();
     void CreateDebugReporter();
     void CreateDevice(VkPhysicalDeviceFeatures enabledFeatures,
                       std::vector<const char *> enabledExtensions,
                       VkQueueFlags requestedQueueTypes = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT);
-    void CreateCommandPool();
+    void CreatePipelineCache();
+    void CreateFrameCommandPools();
+    void CreateStagingRing();
+    void CreateGpuProfiler();
     void CreateSwapchain();
     void CreateSwapchainImageViews();
+    void CreateOffscreenTargets();
     void CreateDepthResources();
     void CreateRenderPass();
     void CreateGraphicsPipeline();
     void CreateFramebuffers();
-    void CreateCommandBuffers();
     void CreateSyncObjects();
 
     // Cleanup Funtion
     void DestroySyncObjects();
-    void FreeCommandBuffers();
     void DestroyFramebuffers();
     void DestroyGraphicsPipeline();
     void DestroyRenderPass();
     void DestroyDepthResources();
     void DestroySwapchainImageViews();
     void DestroySwapchain();
-    void DestroyCommandPool();
+    void DestroyOffscreenTargets();
+    void DestroyGpuProfiler();
+    void DestroyStagingRing();
+    void DestroyFrameCommandPools();
+    void DestroyPipelineCache();
     void DestroyDevice();
     void DestroyDebugReporter();
     void DestroyInstance();
@@ -83,23 +125,28 @@ public:
     void ImGuiResourceCreate();
     void ImGuiResourceDestroy();
     void ImGuiFrameBegin();
-    void ImGuiFrameRender(uint32_t imageIndex);
+    void ImGuiFrameRender(VkCommandBuffer commandBuffer, uint32_t imageIndex);
     void ImGuiFrameEnd();
     void ImGuiCreateDescriptorPool();
     void ImGuiCreateRenderPass();
     void ImGuiCreateFramebuffer();
-    void ImGuiCreateCommandBuffer();
     void ImGuiUploadFonts();
     void ImGuiUpdateMinImageCount(uint32_t minImageCount);
     static void ImGuiCheckVkResultCallback(VkResult result);
 
     ImDrawData *imGuiDrawData_{nullptr};
     VkAllocationCallbacks *imguiAllocator_{nullptr};
-    VkPipelineCache imguiPipelineCache_{VK_NULL_HANDLE};
     VkDescriptorPool imguiDescriptorPool_{VK_NULL_HANDLE};
+    // Windowed only. ImGui draws as the second subpass of renderPass_, so the swapchain image is loaded and stored once
+    // and the frame is a single command buffer. Off, it gets imguiRenderPass_ with its own framebuffers and command
+    // buffer. Set before Initialize.
+    bool mergeImGuiPass_{true};
+    bool imguiSubpass() const
+    {
+        return !headless() && mergeImGuiPass_;
+    }
     VkRenderPass imguiRenderPass_{VK_NULL_HANDLE};
     std::vector<VkFramebuffer> imguiFramebuffers_;
-    std::vector<VkCommandBuffer> imguiCommandBuffers_;
 
     // Tool Funtion
     bool IsPhysicalDeviceSuitable(const VkPhysicalDevice physicalDevice);
@@ -118,13 +165,11 @@ public:
     //                  VkDeviceMemory &imageMemory);
     // VkImageView CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags);
 
-    // Command Helper
-    VkCommandBuffer BeginSingleTimeCommand();
-    void EndSingleTimeCommand(VkCommandBuffer commandBuffer);
-
     //
     void DeviceWaitIdle();
 
+    std::string PipelineCachePath();
+
     SwapChainSupportDetails QuerySwapChainSupport();
     VkSurfaceFormatKHR GetAvailableFormat(const std::vector<VkSurfaceFormatKHR> &availableFormats);
     VkPresentModeKHR GetAvailablePresentMode(const std::vector<VkPresentModeKHR> &availablePresentModes);
@@ -148,16 +193,60 @@ public:
         return device_.presentQueue_;
     }
 
+    // Scratch memory for the frame being built, rewound once the GPU is done with the previous use of this
+    // frame slot. Anything placed here must not outlive the frame (see ArenaAllocator / ArenaVector).
+    // Shared upload path, record into stagingRing().commandBuffer() and Submit once per batch of assets
+    StagingRing &stagingRing()
+    {
+        return stagingRing_;
+    }
+    // Streaming uploads on the dedicated transfer queue (the graphics queue if there is none), poll the serial
+    // returned by Submit with IsComplete before using the resources, DrawFrame records the ownership acquires
+    StagingRing &uploadRing()
+    {
+        return uploadRing_;
+    }
+    // GPU timings of the frame passes, open scopes with GpuProfiler::Scope on the frame's command buffers
+    GpuProfiler &gpuProfiler()
+    {
+        return gpuProfiler_;
+    }
+    LinearArena &frameArena()
+    {
+        return frameArenas_[currentFrame_];
+    }
+    // Frame values of the submissions, ask it whether a frame has retired before reusing what the frame used
+    FrameSync &frameSync()
+    {
+        return frameSync_;
+    }
+    uint32_t framesInFlight() const
+    {
+        return framesInFlight_;
+    }
+    // Hand objects a frame may still use over here instead of destroying them, DrawFrame collects the retired ones
+    DeletionQueue &deletionQueue()
+    {
+        return deletionQueue_;
+    }
+
     friend class Swapchain;
     // data
 
     VkInstance instance_{VK_NULL_HANDLE};
     VkDebugReportCallbackEXT fpDebugReportCallbackEXT_{VK_NULL_HANDLE};
     VulkanDevice device_;
-    VkCommandPool commandPool_;
+    // shared by every pipeline, loaded from and saved to PipelineCachePath()
+    VkPipelineCache pipelineCache_{VK_NULL_HANDLE};
+    StagingRing stagingRing_;
+    StagingRing uploadRing_;
+    GpuProfiler gpuProfiler_;
+    ParallelRecorder parallelRecorder_;
+    // draws of the scene, one fullscreen triangle each
+    uint32_t sceneDrawCount_{1};
 
     // SwapchainInfo
-    Window *pWindow_;
+    Window *pWindow_{nullptr};
     VkSurfaceKHR surfaceKHR_{VK_NULL_HANDLE};
     VkSurfaceFormatKHR surfaceFormatKHR_;
     VkPresentModeKHR presentModeKHR_;
@@ -172,25 +261,45 @@ public:
     std::vector<VkImageView> swapchainImageViews_;
     std::vector<VkFramebuffer> swapchainFramebuffers_;
 
+    // Headless targets stand in for the swapchain images, one per frame in flight
+    std::vector<DeviceAllocation> offscreenImageAllocations_;
+    std::vector<VkBuffer> readbackBuffers_;
+    std::vector<DeviceAllocation> readbackAllocations_;
+    bool readbackEnabled_{false};
+    uint32_t readbackImageIndex_{UINT32_MAX};
+    uint64_t readbackFrame_{0};
+
     // Depth Resource
     VkImage depthImage_{VK_NULL_HANDLE};
     VkImageView depthImageView_{VK_NULL_HANDLE};
-    VkDeviceMemory depthImageMemory_{VK_NULL_HANDLE};
+    DeviceAllocation depthImageAllocation_;
 
     // Render Objects
     VkRenderPass renderPass_{VK_NULL_HANDLE};
     VkPipeline graphicsPipeline_{VK_NULL_HANDLE};
     VkPipelineLayout graphicsPipelineLayout_{VK_NULL_HANDLE};
 
-    std::vector<VkCommandBuffer> commandBuffers_;
+    // One transient pool per frame slot, reset in bulk once the slot's fence has signalled.
+    // Command buffers are handed out in order and reused after the reset.
+    struct FrameCommandPool {
+        VkCommandPool commandPool{VK_NULL_HANDLE};
+        std::vector<VkCommandBuffer> commandBuffers;
+        uint32_t usedCount{0};
+    };
+    std::vector<FrameCommandPool> frameCommandPools_;
 
     // Sync Objects
+    // frames the CPU may build ahead of the GPU, every per-frame resource has this many slots. Set before Initialize.
+    uint32_t framesInFlight_{2};
+    FrameSync frameSync_;
+    DeletionQueue deletionQueue_;
     std::vector<VkSemaphore> imageAvailableSemaphores_;
     std::vector<VkSemaphore> renderFinishedSemaphores_;
-    std::vector<VkFence> inFlightFences_;
+    // frameSync_.frameSlot() of the frame being built
     uint32_t currentFrame_{0};
-    // ref Fence Object wait render finished
-    std::vector<VkFence> imagesInFlight_;
+    std::unique_ptr<LinearArena[]> frameArenas_;
+    // frame value that last rendered into each image, 0 for none
+    std::vector<uint64_t> imagesInFlight_;
 
     // what is enable
     bool enableValidationLayer_;
@@ -213,6 +322,9 @@ public:
                                            const char *pLayerPrefix,
                                            const char *pMessage,
                                            void *pUserData);
+    // errors the validation layer reported so far, over every Graphics instance
+    static uint32_t validationErrorCount();
+    static std::atomic<uint32_t> validationErrorCount_;
     static std::string GetShadersPath();
 
 private:
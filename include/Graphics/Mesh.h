@@ -1,5 +1,9 @@
 #pragma once
 #include "Base/Common.h"
+#include "Base/Pool.h"
+#include "Graphics/DeviceMemoryAllocator.h"
+#include "Graphics/VertexLayout.h"
+#include "Graphics/VertexStreams.h"
 #include "Graphics/VulkanApi.h"
 #include "Resource.h"
 #include <glm/glm.hpp>
@@ -14,26 +18,34 @@ namespace tinygltf
 class Node;
 class Model;
 struct Image;
+struct Primitive;
 } // namespace tinygltf
 
 namespace gdf
 {
 
 struct Node;
+struct VulkanDevice;
+class DeletionQueue;
+class StagingRing;
+class WorkerPool;
 
 struct Texture {
-    VkDevice device;
+    VulkanDevice *device{nullptr};
     VkImage image;
     VkImageView imageView;
     VkImageLayout imageLayout;
-    VkDeviceMemory deviceMemory;
+    DeviceAllocation allocation;
     uint32_t width, height;
     uint32_t mipLevels;
     uint32_t layerCount;
     VkDescriptorImageInfo Descriptor;
     VkSampler sampler;
-    bool Create(tinygltf::Image &gltfImage, std::string path, VulkanDevice *device, VkQueue transferQueue);
+    bool Create(tinygltf::Image &gltfImage, std::string path, VulkanDevice *device, StagingRing &staging);
+    // Destroys at once, no submitted frame may still sample the texture
     void Destroy();
+    // Hands the texture over to deletionQueue, destroyed once the frames that may sample it have retired
+    void Destroy(DeletionQueue &deletionQueue);
 };
 
 struct Material {
@@ -102,26 +114,14 @@ struct Node {
     glm::mat4 getMatrix();
 };
 
-struct Vertex {
-
-    enum class Component
-    {
-        Position,
-        Normal,
-        UV,
-        Color,
-        Tangent,
-        Joint0,
-        Weight0
-    };
-
-    glm::vec3 pos;
-    glm::vec3 normal;
-    glm::vec2 uv;
-    glm::vec4 color;
-    glm::vec4 tangent;
-    glm::vec4 joint0;
-    glm::vec4 weight0;
+// Where the loader keeps a model's vertices
+enum class VertexStorage
+{
+    // vertexData only, ready to upload
+    Interleaved,
+    // vertexStreams only, Model::InterleaveVertices builds vertexData when it is needed
+    Streams,
+    Both,
 };
 
 struct Model {
@@ -132,6 +132,11 @@ struct Model {
     std::vector<Node *> nodes;
     std::vector<Node *> linearNodes;
 
+    // the whole node/mesh/primitive graph is allocated from these and released with the model
+    ObjectPool<Node> nodePool;
+    ObjectPool<Mesh> meshPool;
+    ObjectPool<Primitive> primitivePool;
+
     struct {
         uint32_t count;
         VkBuffer buffer;
@@ -144,17 +149,43 @@ struct Model {
         VkDeviceMemory memory;
     } indices;
 
+    // geometry of every primitive in one block, kept on the CPU until it is uploaded. vertices.count vertices of
+    // vertexLayout.stride() bytes, with the attributes any primitive has.
+    VertexLayout vertexLayout;
+    std::vector<uint8_t> vertexData;
+    std::vector<uint32_t> indexData;
+    // the same vertices decoded to floats, one stream per attribute of vertexLayout, when loaded with them
+    VertexStreams vertexStreams;
+
+    // a glTF primitive and the Primitive whose ranges it is decoded into
+    struct PrimitiveDecode {
+        const tinygltf::Primitive *gltfPrimitive;
+        Primitive *primitive;
+    };
+
     // std::vector<Node*>
-    void tinygltfLoadImage(tinygltf::Model gltfModel, VulkanDevice *device, VkQueue transferQueue);
+    void tinygltfLoadImage(tinygltf::Model gltfModel, VulkanDevice *device, StagingRing &staging);
+    // Builds the node graph and lays out every primitive's vertex and index range in decodes, nothing is decoded yet
     void tinygltfLoadNode(Node *parent,
                           const tinygltf::Node &node,
                           uint32_t nodeIndex,
                           const tinygltf::Model &model,
-                          std::vector<uint32_t> &indexBuffer,
-                          std::vector<Vertex> &vertexBuffer,
+                          std::vector<PrimitiveDecode> &decodes,
+                          uint32_t &vertexCount,
+                          uint32_t &indexCount,
                           float globalscale);
 
-    static Model *LoadFromFile(std::string filename);
+    // .gltf through tinygltf, .glb with its binary chunk read straight from a file mapping.
+    // The primitives are decoded on workers when given, the result doesn't depend on its thread count.
+    // Vertex attributes are stored in formats, kQuantizedVertexFormats for the compact layout, and kept as storage says.
+    // Returns null, with the reason logged, when the file fails to parse or its geometry lies outside its buffers.
+    static Model *LoadFromFile(std::string filename,
+                               WorkerPool *workers = nullptr,
+                               const VertexFormats &formats = kFloatVertexFormats,
+                               VertexStorage storage = VertexStorage::Interleaved);
+
+    // Builds vertexData in vertexLayout from vertexStreams, for upload of a model loaded with the streams only
+    void InterleaveVertices();
 
     ~Model();
 };
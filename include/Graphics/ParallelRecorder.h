@@ -0,0 +1,55 @@
+#pragma once
+#include "Base/NonCopyable.h"
+#include "Base/WorkerPool.h"
+#include "Graphics/VulkanApi.h"
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace gdf
+{
+
+struct VulkanDevice;
+
+// Records the draws of a render pass into secondary command buffers on several threads.
+// Items are split into one contiguous range per thread and the secondaries come back in range order, executing them
+// keeps the draw order of a single threaded recording. Every range owns one command pool per frame slot and is
+// recorded by one thread of a WorkerPool at a time, so a slot's pools are reset and re-recorded without locking once
+// the slot's fence has signalled.
+class GDF_EXPORT ParallelRecorder : public NonCopyable
+{
+public:
+    // Records items [first, last) into a secondary begun inside the render pass, called on any recording thread
+    using RecordFunction = std::function<void(VkCommandBuffer commandBuffer, uint32_t first, uint32_t last)>;
+
+    void Create(VulkanDevice *device, uint32_t queueFamilyIndex, uint32_t frameCount, uint32_t threadCount);
+    void Destroy();
+
+    // Records itemCount items for frameSlot and returns the secondaries in item order, ready for vkCmdExecuteCommands.
+    // Blocks until every thread is done, the previous use of frameSlot must have finished on the GPU.
+    std::span<const VkCommandBuffer> Record(uint32_t frameSlot,
+                                            const VkCommandBufferInheritanceInfo &inheritance,
+                                            uint32_t itemCount,
+                                            const RecordFunction &record);
+
+    uint32_t threadCount() const
+    {
+        return threadCount_;
+    }
+
+private:
+    void RecordRange(uint32_t frameSlot,
+                     uint32_t range,
+                     const VkCommandBufferInheritanceInfo &inheritance,
+                     uint32_t itemCount,
+                     const RecordFunction &record);
+
+    VulkanDevice *device_{nullptr};
+    uint32_t threadCount_{0};
+    // [frameSlot * threadCount_ + range]
+    std::vector<VkCommandPool> commandPools_;
+    std::vector<VkCommandBuffer> commandBuffers_;
+    WorkerPool workers_;
+};
+
+} // namespace gdf
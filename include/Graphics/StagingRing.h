@@ -0,0 +1,106 @@
+#pragma once
+#include "Base/NonCopyable.h"
+#include "Graphics/DeviceMemoryAllocator.h"
+#include "Graphics/VulkanApi.h"
+#include <array>
+#include <vector>
+
+namespace gdf
+{
+
+struct VulkanDevice;
+
+// Persistently mapped upload buffer used as a ring. Uploads copy their data into the ring and record the copy into
+// the command buffer of the current batch, Submit sends the whole batch with one fence and the ring space of a batch
+// is reclaimed once its fence has signalled. Only a full ring, or Flush, ever makes the CPU wait.
+// When the ring submits to another queue family than the one using the resources (a dedicated transfer queue), every
+// upload releases ownership at the end of its batch and RecordAcquires records the matching acquire barriers on the
+// owner's queue once the batch has finished.
+// Not thread safe, record uploads from one thread.
+class GDF_EXPORT StagingRing : public NonCopyable
+{
+public:
+    static constexpr VkDeviceSize kDefaultSize = 64 * 1024 * 1024;
+    static constexpr uint32_t kBatchCount = 4;
+
+    struct Region {
+        void *mapped{nullptr};
+        VkBuffer buffer{VK_NULL_HANDLE};
+        VkDeviceSize offset{0};
+    };
+
+    // ownerQueueFamilyIndex is the family that uses the uploaded resources, UINT32_MAX for queueFamilyIndex itself
+    void Create(VulkanDevice *device,
+                VkQueue queue,
+                uint32_t queueFamilyIndex,
+                uint32_t ownerQueueFamilyIndex = UINT32_MAX,
+                VkDeviceSize size = kDefaultSize);
+    void Destroy();
+
+    // Reserves size bytes of the ring for a copy recorded into commandBuffer(), waits for older batches if full
+    Region Allocate(VkDeviceSize size, VkDeviceSize alignment = 16);
+    // Command buffer of the batch being recorded, begun on first use
+    VkCommandBuffer commandBuffer();
+
+    void UploadBuffer(VkBuffer buffer, VkDeviceSize offset, const void *data, VkDeviceSize size);
+    // Whole-image upload of the first mip level, the image ends up in finalLayout
+    void UploadImage(VkImage image,
+                     uint32_t width,
+                     uint32_t height,
+                     const void *data,
+                     VkDeviceSize size,
+                     VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    // Submits the recorded batch and returns at once with its serial, or the last serial if nothing was recorded
+    uint64_t Submit();
+    // Submits and waits until every batch has finished on the GPU
+    void Flush();
+    // True once the batch is finished and, with an ownership transfer, its acquires have been recorded
+    bool IsComplete(uint64_t serial);
+    // Records the acquire barriers of finished batches into a command buffer of the owner queue, never waits
+    void RecordAcquires(VkCommandBuffer ownerCommandBuffer);
+
+    bool transfersOwnership() const
+    {
+        return queueFamilyIndex_ != ownerQueueFamilyIndex_;
+    }
+
+private:
+    struct Batch {
+        VkCommandBuffer commandBuffer{VK_NULL_HANDLE};
+        VkFence fence{VK_NULL_HANDLE};
+        // ring position at submit, everything before it is free once the fence signals
+        VkDeviceSize end{0};
+        uint64_t serial{0};
+        bool recording{false};
+        bool pending{false};
+        std::vector<VkBufferMemoryBarrier> bufferAcquires;
+        std::vector<VkImageMemoryBarrier> imageAcquires;
+    };
+
+    void Retire(bool wait);
+
+    VulkanDevice *device_{nullptr};
+    VkQueue queue_{VK_NULL_HANDLE};
+    uint32_t queueFamilyIndex_{UINT32_MAX};
+    uint32_t ownerQueueFamilyIndex_{UINT32_MAX};
+    VkCommandPool commandPool_{VK_NULL_HANDLE};
+    VkBuffer buffer_{VK_NULL_HANDLE};
+    DeviceAllocation allocation_;
+    VkDeviceSize size_{0};
+    // monotonic positions, the ring offset is position % size_
+    VkDeviceSize head_{0};
+    VkDeviceSize tail_{0};
+    std::array<Batch, kBatchCount> batches_;
+    uint32_t current_{0};
+    // oldest batch that may still be pending
+    uint32_t oldest_{0};
+    uint64_t submittedSerial_{0};
+    uint64_t retiredSerial_{0};
+    uint64_t completedSerial_{0};
+    // acquires of retired batches not yet recorded on the owner queue
+    std::vector<VkBufferMemoryBarrier> bufferAcquires_;
+    std::vector<VkImageMemoryBarrier> imageAcquires_;
+};
+
+} // namespace gdf
@@ -0,0 +1,140 @@
+#pragma once
+#include "Base/Common.h"
+#include "Graphics/VulkanApi.h"
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace gdf
+{
+
+// Every attribute a vertex can have, as the loader decodes it
+struct Vertex {
+
+    enum class Component
+    {
+        Position,
+        Normal,
+        UV,
+        Color,
+        Tangent,
+        Joint0,
+        Weight0
+    };
+
+    glm::vec3 pos;
+    glm::vec3 normal;
+    glm::vec2 uv;
+    glm::vec4 color;
+    glm::vec4 tangent;
+    glm::vec4 joint0;
+    glm::vec4 weight0;
+};
+
+constexpr uint32_t kVertexComponentCount = 7;
+
+// How an attribute is stored in the vertex buffer. Shaders get the decoded value from the attribute's VkFormat
+// except for the two encodings that need a few lines of shader code.
+enum class VertexFormat
+{
+    // 32-bit floats, any attribute
+    Float,
+    // 16-bit unorm relative to the primitive's bounds, positions only: pos = min + value.xyz * size
+    Unorm16,
+    // octahedral unit vector in two 16-bit snorm, normals and tangents. A tangent keeps its handedness in z.
+    //   n = vec3(e.xy, 1 - abs(e.x) - abs(e.y)); n.xy -= (step(0, n.xy) * 2 - 1) * max(-n.z, 0); normalize(n)
+    Octahedral16,
+    // half floats, uvs and colors
+    Half,
+    // 8-bit unorm, colors and weights
+    Unorm8,
+    // unsigned integers, joints
+    Uint8,
+    Uint16,
+};
+
+// The format of each Vertex::Component
+using VertexFormats = std::array<VertexFormat, kVertexComponentCount>;
+
+constexpr VertexFormats kFloatVertexFormats{VertexFormat::Float,
+                                            VertexFormat::Float,
+                                            VertexFormat::Float,
+                                            VertexFormat::Float,
+                                            VertexFormat::Float,
+                                            VertexFormat::Float,
+                                            VertexFormat::Float};
+// 8 bytes of position, 4 of normal and uv, 8 of tangent, 4 of color, joints and weights
+constexpr VertexFormats kQuantizedVertexFormats{VertexFormat::Unorm16,
+                                                VertexFormat::Octahedral16,
+                                                VertexFormat::Half,
+                                                VertexFormat::Unorm8,
+                                                VertexFormat::Octahedral16,
+                                                VertexFormat::Uint8,
+                                                VertexFormat::Unorm8};
+
+// The attributes a model's vertices carry and where they sit in a vertex. Attributes no primitive has are left out.
+// Shader locations are the Vertex::Component values whatever the layout, a shader reads only what it declares.
+class GDF_EXPORT VertexLayout
+{
+public:
+    struct Attribute {
+        Vertex::Component component;
+        VertexFormat format;
+        VkFormat vkFormat;
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    static uint32_t ComponentBit(Vertex::Component component)
+    {
+        return 1u << static_cast<uint32_t>(component);
+    }
+
+    // Floats the loader decodes for a component, 3 for a position
+    static uint32_t ComponentCount(Vertex::Component component);
+    // The value a vertex gets when its primitive lacks the component
+    static const float *DefaultValue(Vertex::Component component);
+    // Whether format can store component, Float fits any
+    static bool FormatFits(Vertex::Component component, VertexFormat format);
+
+    VertexLayout() = default;
+    // components is a mask of ComponentBit, a format that doesn't fit its component falls back to Float
+    VertexLayout(uint32_t components, const VertexFormats &formats);
+
+    const Attribute *Find(Vertex::Component component) const;
+
+    // Writes count values of ComponentCount floats each, tightly packed, into attribute of count vertices.
+    // Positions are quantized relative to min and size, the bounds of their primitive.
+    void Encode(const Attribute &attribute,
+                const float *values,
+                uint32_t count,
+                const glm::vec3 &min,
+                const glm::vec3 &size,
+                uint8_t *vertices) const;
+
+    VkVertexInputBindingDescription BindingDescription(uint32_t binding) const;
+    std::vector<VkVertexInputAttributeDescription> AttributeDescriptions(uint32_t binding) const;
+
+    const std::vector<Attribute> &attributes() const
+    {
+        return attributes_;
+    }
+
+    uint32_t components() const
+    {
+        return components_;
+    }
+
+    uint32_t stride() const
+    {
+        return stride_;
+    }
+
+private:
+    std::vector<Attribute> attributes_;
+    uint32_t components_{0};
+    uint32_t stride_{0};
+};
+
+} // namespace gdf
@@ -0,0 +1,59 @@
+#pragma once
+#include "Base/Common.h"
+#include "Graphics/VertexLayout.h"
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace gdf
+{
+
+// A model's vertices as one float stream per component instead of interleaved, so a CPU pass over a few attributes
+// (bounds, culling, picking, skinning) reads only those. Every stream starts 16-byte aligned.
+class GDF_EXPORT VertexStreams
+{
+public:
+    static constexpr size_t kAlignment = 16;
+
+    VertexStreams() = default;
+    // components is a mask of VertexLayout::ComponentBit, the streams start zeroed
+    VertexStreams(uint32_t components, uint32_t vertexCount);
+
+    // vertexCount values of ComponentCount floats each, tightly packed, null for a component the streams lack
+    float *Stream(Vertex::Component component);
+    const float *Stream(Vertex::Component component) const;
+
+    // Writes vertices first..first + count into vertexData, the interleaved vertices of layout, for upload.
+    // Quantized positions are relative to min and size, the bounds of the vertices' primitive.
+    // The streams must have every component of layout.
+    void Interleave(const VertexLayout &layout,
+                    uint32_t first,
+                    uint32_t count,
+                    const glm::vec3 &min,
+                    const glm::vec3 &size,
+                    uint8_t *vertexData) const;
+
+    uint32_t components() const
+    {
+        return components_;
+    }
+
+    uint32_t vertexCount() const
+    {
+        return vertexCount_;
+    }
+
+private:
+    struct alignas(kAlignment) Block {
+        float values[kAlignment / sizeof(float)];
+    };
+
+    std::vector<Block> blocks_;
+    // where each stream starts, in floats from the first block
+    std::array<size_t, kVertexComponentCount> offsets_{};
+    uint32_t components_{0};
+    uint32_t vertexCount_{0};
+};
+
+} // namespace gdf
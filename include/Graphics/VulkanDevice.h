@@ -1,4 +1,5 @@
 #pragma once
+#include "DeviceMemoryAllocator.h"
 #include "VulkanApi.h"
 #include <vector>
 
@@ -28,6 +29,8 @@ struct VulkanDevice {
     std::vector<std::string> supportedExtensions;
     /** @brief Set to true when the debug marker extension is detected */
     bool enableDebugMarkers = false;
+    /** @brief Set to true when VK_KHR_timeline_semaphore is enabled on the logical device */
+    bool enableTimelineSemaphore = false;
 
 #ifdef __APPLE__
     bool enablePortabilitySubsetExtension_{false};
@@ -38,6 +41,8 @@ struct VulkanDevice {
     VkQueue computeQueue_{VK_NULL_HANDLE};
     VkQueue transferQueue_{VK_NULL_HANDLE};
     VkQueue presentQueue_{VK_NULL_HANDLE};
+    /** @brief Sub-allocator every resource of this device takes its memory from, ready after CreateLogicalDevice */
+    DeviceMemoryAllocator memoryAllocator;
     /** @brief Contains queue family indices */
     struct {
         uint32_t graphics{UINT32_MAX};
@@ -71,7 +76,7 @@ struct VulkanDevice {
                      VkImageUsageFlags usage,
                      VkMemoryPropertyFlags properties,
                      VkImage &image,
-                     VkDeviceMemory &imageMemory);
+                     DeviceAllocation &imageAllocation);
     VkImageView CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags);
 
     // Req infomation
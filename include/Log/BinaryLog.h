@@ -0,0 +1,46 @@
+#pragma once
+#include "Log/LogSink.h"
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+namespace gdf
+{
+
+// Binary log file layout (native endianness, decode on the same architecture):
+//   "GDFBLOG1"
+//   'C' u32 categoryId u16 size bytes       category name, written once per category
+//   'F' u32 formatId u32 size bytes         format string, written once per format pointer
+//   'R' u32 categoryId u8 level u32 formatId u16 size bytes   deferred record with LogArgBuffer payload
+//   'T' u32 categoryId u8 level u32 size bytes                already formatted record
+class BinaryFileSink : public LogSink
+{
+public:
+    BinaryFileSink(const std::string &path);
+
+    virtual void Log(const LogCategory *category, const LogLevel level, const std::string_view message);
+    virtual bool LogDeferred(const LogCategory *category, const LogLevel level, const char *format, const LogArgBuffer &args);
+    virtual void Exception();
+
+    // records are silently discarded when the file couldn't be opened
+    bool isOpen()
+    {
+        return file_.is_open();
+    }
+
+private:
+    uint32_t CategoryId(const LogCategory *category);
+    uint32_t FormatId(const char *format);
+
+    std::ofstream file_;
+    std::unordered_map<const LogCategory *, uint32_t> categoryIds_;
+    // deferred formats are LogFormat constants, one pointer is always the same text
+    std::unordered_map<const char *, uint32_t> formatIds_;
+};
+
+// Turns a binary log back into the text CerrSink would have printed, returns false on a malformed stream
+bool DecodeBinaryLog(std::istream &in, std::ostream &out);
+
+} // namespace gdf
@@ -0,0 +1,51 @@
+#pragma once
+#include "Base/MappedFile.h"
+#include "Log/LogSink.h"
+#include <chrono>
+#include <string>
+
+namespace gdf
+{
+
+// Appends "[category][level] message" lines into a memory-mapped file of maxFileSize bytes.
+// When the file is full, or rotationInterval has passed, it is renamed to path.1 (path.1 to path.2, ...)
+// keeping at most maxBackups old files, and a fresh one is mapped. Exception() syncs the mapping to disk.
+class GDF_EXPORT FileSink : public LogSink
+{
+public:
+    FileSink(const std::string &path,
+             size_t maxFileSize = 16 * 1024 * 1024,
+             std::chrono::seconds rotationInterval = std::chrono::seconds::zero(),
+             size_t maxBackups = 4);
+    ~FileSink();
+
+    virtual void Log(const LogCategory *category, const LogLevel level, const std::string_view message);
+    virtual void Exception();
+
+    // records are discarded when the file couldn't be created, the failure is reported on stderr
+    bool isOpen() const
+    {
+        return file_.isOpen();
+    }
+
+    size_t usedSize() const
+    {
+        return used_;
+    }
+
+private:
+    // A sink can't log through the logger that calls it, these report failures on stderr
+    void Open();
+    void Close();
+    void Rotate();
+
+    std::string path_;
+    size_t maxFileSize_;
+    std::chrono::seconds rotationInterval_;
+    size_t maxBackups_;
+    MappedFile file_;
+    size_t used_{0};
+    std::chrono::steady_clock::time_point openedAt_;
+};
+
+} // namespace gdf
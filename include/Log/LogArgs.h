@@ -0,0 +1,122 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace gdf
+{
+
+enum class LogArgType : uint8_t
+{
+    Bool,
+    Char,
+    Int32,
+    UInt32,
+    Int64,
+    UInt64,
+    Float,
+    Double,
+    String,
+    Pointer,
+};
+
+// Arguments of a deferred log record, packed as [type][payload] with strings copied inline as [type][u16 size][bytes]
+struct LogArgBuffer {
+    static constexpr size_t kCapacity = 192;
+
+    uint16_t size{0};
+    std::byte data[kCapacity];
+
+    bool Append(LogArgType type, const void *value, size_t valueSize)
+    {
+        if (size + 1 + valueSize > kCapacity)
+            return false;
+        data[size] = static_cast<std::byte>(type);
+        std::memcpy(data + size + 1, value, valueSize);
+        size += static_cast<uint16_t>(1 + valueSize);
+        return true;
+    }
+
+    bool AppendString(std::string_view value)
+    {
+        if (size + 1 + sizeof(uint16_t) + value.size() > kCapacity)
+            return false;
+        uint16_t length = static_cast<uint16_t>(value.size());
+        data[size] = static_cast<std::byte>(LogArgType::String);
+        std::memcpy(data + size + 1, &length, sizeof(length));
+        std::memcpy(data + size + 1 + sizeof(length), value.data(), value.size());
+        size += static_cast<uint16_t>(1 + sizeof(length) + value.size());
+        return true;
+    }
+};
+
+template <typename T>
+inline constexpr bool kIsDeferrableLogArg =
+    std::is_same_v<T, bool> || std::is_same_v<T, char> || std::is_same_v<T, signed char> ||
+    std::is_same_v<T, unsigned char> || std::is_same_v<T, short> || std::is_same_v<T, unsigned short> ||
+    std::is_same_v<T, int> || std::is_same_v<T, unsigned int> || std::is_same_v<T, long> ||
+    std::is_same_v<T, unsigned long> || std::is_same_v<T, long long> || std::is_same_v<T, unsigned long long> ||
+    std::is_same_v<T, float> || std::is_same_v<T, double> || std::is_same_v<T, const char *> ||
+    std::is_same_v<T, char *> || std::is_same_v<T, std::string_view> || std::is_same_v<T, std::string> ||
+    std::is_same_v<T, const void *> || std::is_same_v<T, void *>;
+
+// Type an argument is captured as, string literals and char arrays become const char *
+template <typename T>
+using LogArgDecay = std::decay_t<const std::remove_reference_t<T>>;
+
+template <typename T>
+bool EncodeLogArg(LogArgBuffer &buffer, const T &value)
+{
+    static_assert(kIsDeferrableLogArg<T>, "log argument type can't be deferred");
+    if constexpr (std::is_same_v<T, bool>) {
+        return buffer.Append(LogArgType::Bool, &value, sizeof(value));
+    } else if constexpr (std::is_same_v<T, char>) {
+        return buffer.Append(LogArgType::Char, &value, sizeof(value));
+    } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+        if constexpr (sizeof(T) <= sizeof(int32_t)) {
+            int32_t widened = value;
+            return buffer.Append(LogArgType::Int32, &widened, sizeof(widened));
+        } else {
+            int64_t widened = value;
+            return buffer.Append(LogArgType::Int64, &widened, sizeof(widened));
+        }
+    } else if constexpr (std::is_integral_v<T>) {
+        if constexpr (sizeof(T) <= sizeof(uint32_t)) {
+            uint32_t widened = value;
+            return buffer.Append(LogArgType::UInt32, &widened, sizeof(widened));
+        } else {
+            uint64_t widened = value;
+            return buffer.Append(LogArgType::UInt64, &widened, sizeof(widened));
+        }
+    } else if constexpr (std::is_same_v<T, float>) {
+        return buffer.Append(LogArgType::Float, &value, sizeof(value));
+    } else if constexpr (std::is_same_v<T, double>) {
+        return buffer.Append(LogArgType::Double, &value, sizeof(value));
+    } else if constexpr (std::is_same_v<T, const void *> || std::is_same_v<T, void *>) {
+        const void *pointer = value;
+        return buffer.Append(LogArgType::Pointer, &pointer, sizeof(pointer));
+    } else if constexpr (std::is_same_v<T, const char *> || std::is_same_v<T, char *>) {
+        return value != nullptr && buffer.AppendString(value);
+    } else {
+        return buffer.AppendString(value);
+    }
+}
+
+template <typename... Args>
+bool EncodeLogArgs(LogArgBuffer &buffer, const Args &...args)
+{
+    return (EncodeLogArg<LogArgDecay<Args>>(buffer, args) && ...);
+}
+
+// Formats a deferred record the same way fmt::format would have on the producer
+std::string FormatLogArgs(std::string_view format, const std::byte *data, size_t size);
+
+inline std::string FormatLogArgs(std::string_view format, const LogArgBuffer &args)
+{
+    return FormatLogArgs(format, args.data, args.size);
+}
+
+} // namespace gdf
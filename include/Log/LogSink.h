@@ -1,4 +1,5 @@
 #pragma once
+#include "LogArgs.h"
 #include "LogCategory.h"
 
 namespace gdf
@@ -9,6 +10,13 @@ public:
     virtual ~LogSink() = default;
     virtual void Log(const LogCategory *category, const LogLevel level, const std::string_view message) = 0;
     virtual void Exception() = 0;
+
+    // Deferred records (see Logger::deferredFormatting) are offered here first, a sink that returns false gets
+    // the formatted text through Log instead. format is a LogFormat constant and stays valid for the whole program.
+    virtual bool LogDeferred(const LogCategory *category, const LogLevel level, const char *format, const LogArgBuffer &args)
+    {
+        return false;
+    }
 };
 
 } // namespace gdf
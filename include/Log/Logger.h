@@ -1,10 +1,17 @@
 #pragma once
+#include "Base/BoundedQueue.h"
 #include "Base/Singleton.h"
+#include "Log/LogArgs.h"
 #include "Log/LogSink.h"
 #include "LogCategory.h"
+#include <atomic>
+#include <condition_variable>
 #include <fmt/core.h>
 #include <iostream>
 #include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
 #include <vector>
 
 namespace std
@@ -21,6 +28,34 @@ std::string to_string(gdf::LogLevel);
 
 namespace gdf
 {
+
+// What an async producer does when the record queue is full
+enum class LogOverflowPolicy : uint8_t
+{
+    Drop,      // discard the new record, unless it is an Error or Fatal record which waits like under Block
+    Block,     // wait until the drain thread frees a slot
+    Overwrite, // discard the oldest queued record
+};
+
+// A format known at compile time: string literals and other constant strings convert, a runtime char array doesn't.
+// It outlives any record, so deferred records and binary sinks can keep the pointer.
+class LogFormat
+{
+public:
+    template <size_t N>
+    consteval LogFormat(const char (&format)[N]) : format_(format)
+    {
+    }
+
+    const char *c_str() const
+    {
+        return format_;
+    }
+
+private:
+    const char *format_;
+};
+
 class GDF_EXPORT Logger : public Singleton<Logger>
 {
 public:
@@ -28,18 +63,111 @@ public:
 
     void Log(const LogCategory *category, const LogLevel level, const std::string_view message);
 
+    // Runtime formats are formatted at once. A char array format must be a LogFormat, wrap a runtime buffer in a
+    // std::string_view to log it.
+    template <typename Message, typename... Args>
+    requires(sizeof...(Args) > 0 && !std::is_array_v<std::remove_cvref_t<Message>> &&
+             std::is_convertible_v<const Message &, std::string_view>)
+    void Log(const LogCategory *category, const LogLevel level, const Message &message, Args &&...args)
+    {
+        Dispatch(category, level, fmt::vformat(std::string_view{message}, fmt::make_format_args(args...)));
+    }
+
+    // Picked for string literal formats (what GDF_LOG passes), the pointer is kept as is in deferred records
     template <typename... Args>
-    void Log(const LogCategory *category, const LogLevel level, const std::string_view message, Args &&...args)
+    requires(sizeof...(Args) > 0)
+    void Log(const LogCategory *category, const LogLevel level, LogFormat format, Args &&...args)
     {
-        Log(category, level, fmt::format(message, std::forward<Args>(args)...));
+        if constexpr ((kIsDeferrableLogArg<LogArgDecay<Args>> && ...)) {
+            if (deferredFormatting_.load(std::memory_order_relaxed)) {
+                Record record{category, level, format.c_str()};
+                if (EncodeLogArgs(record.args, args...)) {
+                    Submit(std::move(record));
+                    return;
+                }
+            }
+        }
+        Dispatch(category, level, fmt::vformat(format.c_str(), fmt::make_format_args(args...)));
     }
 
     bool RegisterSink(LogSink *pSink);
     bool DeregisterSink(LogSink *pSink);
 
+    // Async mode: producers only push records into a bounded lock-free queue and a drain thread calls the sinks.
+    // Switch modes while no other thread is logging (at startup or shutdown).
+    void EnableAsync(size_t capacity = 8192, LogOverflowPolicy overflowPolicy = LogOverflowPolicy::Block);
+    void DisableAsync();
+    // Block until every record queued before the call has reached the sinks
+    void Flush();
+
+    bool isAsync()
+    {
+        return async_.load(std::memory_order_acquire);
+    }
+
+    uint64_t droppedCount()
+    {
+        return droppedCount_.load(std::memory_order_relaxed);
+    }
+
+    // Deferred formatting: GDF_LOG only captures the format pointer and the arguments, text is produced
+    // by the consumer (drain thread, a sink that never needs it, or the offline decoder)
+    void deferredFormatting(bool enable)
+    {
+        deferredFormatting_.store(enable, std::memory_order_relaxed);
+    }
+
+    bool deferredFormatting()
+    {
+        return deferredFormatting_.load(std::memory_order_relaxed);
+    }
+
 private:
+    struct Record {
+        Record() = default;
+        Record(const LogCategory *category, LogLevel level, std::string &&message)
+            : category(category), level(level), message(std::move(message))
+        {
+        }
+        Record(const LogCategory *category, LogLevel level, const char *format)
+            : category(category), level(level), format(format)
+        {
+        }
+
+        const LogCategory *category{nullptr};
+        LogLevel level{LogLevel::None};
+        // set for deferred records from a LogFormat, message is empty and the text is args formatted with it
+        const char *format{nullptr};
+        std::string message;
+        LogArgBuffer args;
+    };
+
+    void Dispatch(const LogCategory *category, const LogLevel level, std::string &&message);
+    void Submit(Record &&record);
+    void Deliver(const Record &record);
+    void LogSync(const LogCategory *category, const LogLevel level, const std::string_view message);
+    void Enqueue(Record &&record);
+    void WakeDrainThread();
+    void DrainLoop();
+
     std::mutex sync;
     std::vector<LogSink *> sinks;
+
+    // async
+    std::atomic<bool> async_{false};
+    std::atomic<bool> deferredFormatting_{false};
+    LogOverflowPolicy overflowPolicy_{LogOverflowPolicy::Block};
+    std::unique_ptr<BoundedQueue<Record>> queue_;
+    std::thread drainThread_;
+    std::atomic<bool> draining_{false};
+    std::atomic<bool> drainSleeping_{false};
+    std::mutex drainMutex_;
+    std::condition_variable drainCondition_;
+    std::mutex flushMutex_;
+    std::condition_variable flushCondition_;
+    std::atomic<uint64_t> pushedCount_{0};
+    std::atomic<uint64_t> consumedCount_{0};
+    std::atomic<uint64_t> droppedCount_{0};
 };
 
-} // namespace gdf
\ No newline at end of file
+} // namespace gdf
@@ -11,8 +11,8 @@ GDF_DECLARE_LOG_CATEGORY(gdfLog, LogLevel::All, LogLevel::Info)
 
 // last error
 
-// call in main thread
-void Initialize();
+// call in main thread, headless programs skip the window system so they run without a display
+void Initialize(bool windowSystem = true);
 // call in main thread
 void Cleanup();
 
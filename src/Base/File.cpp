@@ -1,5 +1,6 @@
 #include "Base/File.h"
 #include <cstdio>
+#include <filesystem>
 #include <fstream>
 
 #ifdef _WIN32
@@ -9,6 +10,9 @@
 #include <limits.h>
 #include <mach-o/dyld.h>
 #include <sys/syslimits.h>
+#else
+#include <climits>
+#include <unistd.h>
 #endif
 
 namespace gdf
@@ -26,6 +30,26 @@ std::vector<char> File::ReadBytes(const std::string &filename)
     file.close();
     return buffer;
 }
+
+bool File::WriteBytesAtomic(const std::string &filename, const void *data, size_t size)
+{
+    std::string temporary = filename + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            return false;
+        file.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+        if (!file.good())
+            return false;
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, filename, error);
+    if (error) {
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
 std::string File::GetExePath()
 {
 #ifdef _WIN32
@@ -0,0 +1,189 @@
+#include "Base/MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace gdf
+{
+
+MappedFile::~MappedFile()
+{
+    if (isOpen())
+        Close(size_);
+}
+
+#ifdef _WIN32
+bool MappedFile::Open(const std::string &path, size_t size)
+{
+    HANDLE file = CreateFileA(path.c_str(),
+                              GENERIC_READ | GENERIC_WRITE,
+                              FILE_SHARE_READ,
+                              NULL,
+                              CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL,
+                              NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER fileSize;
+    fileSize.QuadPart = static_cast<LONGLONG>(size);
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE, fileSize.HighPart, fileSize.LowPart, NULL);
+    if (mapping == NULL) {
+        CloseHandle(file);
+        return false;
+    }
+    void *data = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size);
+    if (data == NULL) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    file_ = file;
+    mapping_ = mapping;
+    data_ = static_cast<char *>(data);
+    size_ = size;
+    readOnly_ = false;
+    return true;
+}
+
+bool MappedFile::OpenRead(const std::string &path)
+{
+    HANDLE file =
+        CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL) {
+        CloseHandle(file);
+        return false;
+    }
+    void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == NULL) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    file_ = file;
+    mapping_ = mapping;
+    data_ = static_cast<char *>(data);
+    size_ = static_cast<size_t>(fileSize.QuadPart);
+    readOnly_ = true;
+    return true;
+}
+
+bool MappedFile::Close(size_t usedSize)
+{
+    UnmapViewOfFile(data_);
+    CloseHandle(mapping_);
+    bool truncated = true;
+    if (!readOnly_) {
+        LARGE_INTEGER fileSize;
+        fileSize.QuadPart = static_cast<LONGLONG>(usedSize < size_ ? usedSize : size_);
+        truncated = SetFilePointerEx(file_, fileSize, NULL, FILE_BEGIN) && SetEndOfFile(file_);
+    }
+    CloseHandle(file_);
+    data_ = nullptr;
+    size_ = 0;
+    file_ = nullptr;
+    mapping_ = nullptr;
+    return truncated;
+}
+
+void MappedFile::Sync()
+{
+    FlushViewOfFile(data_, size_);
+    FlushFileBuffers(file_);
+}
+#else
+namespace
+{
+// Grows the file to size bytes. ftruncate alone leaves a sparse file whose blocks are only allocated when a page of
+// the mapping is first written, and a full disk then raises SIGBUS in whatever thread wrote it.
+bool Allocate(int file, size_t size)
+{
+#ifdef __linux__
+    int error = posix_fallocate(file, 0, static_cast<off_t>(size));
+    // file systems without fallocate fall back to a sparse file
+    if (error != EOPNOTSUPP && error != EINVAL)
+        return error == 0;
+#endif
+    return ftruncate(file, static_cast<off_t>(size)) == 0;
+}
+} // namespace
+
+bool MappedFile::Open(const std::string &path, size_t size)
+{
+    int file = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (file < 0)
+        return false;
+    if (!Allocate(file, size)) {
+        close(file);
+        return false;
+    }
+    void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    if (data == MAP_FAILED) {
+        close(file);
+        return false;
+    }
+    file_ = file;
+    data_ = static_cast<char *>(data);
+    size_ = size;
+    readOnly_ = false;
+    return true;
+}
+
+bool MappedFile::OpenRead(const std::string &path)
+{
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0)
+        return false;
+    struct stat status;
+    if (fstat(file, &status) != 0 || status.st_size == 0) {
+        close(file);
+        return false;
+    }
+    size_t size = static_cast<size_t>(status.st_size);
+    void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    if (data == MAP_FAILED) {
+        close(file);
+        return false;
+    }
+    // readers go through most of the file, start reading it in before the first page faults
+    madvise(data, size, MADV_WILLNEED);
+    file_ = file;
+    data_ = static_cast<char *>(data);
+    size_ = size;
+    readOnly_ = true;
+    return true;
+}
+
+bool MappedFile::Close(size_t usedSize)
+{
+    munmap(data_, size_);
+    bool truncated = readOnly_ || ftruncate(file_, static_cast<off_t>(usedSize < size_ ? usedSize : size_)) == 0;
+    close(file_);
+    data_ = nullptr;
+    size_ = 0;
+    file_ = -1;
+    return truncated;
+}
+
+void MappedFile::Sync()
+{
+    msync(data_, size_, MS_SYNC);
+}
+#endif
+
+} // namespace gdf
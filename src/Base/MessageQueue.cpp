@@ -0,0 +1,23 @@
+#include "Base/MessageQueue.h"
+#include <algorithm>
+#include <cstring>
+
+namespace gdf
+{
+
+MessageCollector::MessageCollector(size_t capacity) : queue_(capacity)
+{
+}
+
+MessageCollector::Message::Message(std::string_view message)
+    : size(static_cast<uint16_t>(std::min(message.size(), kMaxMessageSize)))
+{
+    std::memcpy(text, message.data(), size);
+}
+
+bool MessageCollector::AddMessage(std::string_view message)
+{
+    return queue_.TryEmplace(message);
+}
+
+} // namespace gdf
@@ -0,0 +1,196 @@
+#include "Base/OffsetAllocator.h"
+#include <algorithm>
+#include <bit>
+
+namespace gdf
+{
+
+OffsetAllocator::OffsetAllocator(uint64_t size) : size_(size)
+{
+    for (auto &firstLevel : bins_)
+        std::fill(std::begin(firstLevel), std::end(firstLevel), kInvalidNode);
+    if (size_ > 0)
+        InsertFree(NewNode(0, size_));
+}
+
+OffsetAllocator::Allocation OffsetAllocator::Allocate(uint64_t size, uint64_t alignment)
+{
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+    if (size == 0)
+        size = 1;
+    // asking for the worst case padding up front means any range found fits without a second search
+    uint32_t index = FindFreeNode(size + alignment - 1);
+    if (index == kInvalidNode)
+        return Allocation{};
+    RemoveFree(index);
+
+    uint64_t offset = nodes_[index].offset;
+    uint64_t alignedOffset = (offset + alignment - 1) & ~(alignment - 1);
+    if (alignedOffset != offset) {
+        // the padding in front stays a free range of its own
+        uint32_t front = NewNode(offset, alignedOffset - offset);
+        Node &node = nodes_[index];
+        nodes_[front].prevRange = node.prevRange;
+        nodes_[front].nextRange = index;
+        if (node.prevRange != kInvalidNode)
+            nodes_[node.prevRange].nextRange = front;
+        node.prevRange = front;
+        node.offset = alignedOffset;
+        node.size -= alignedOffset - offset;
+        InsertFree(front);
+    }
+    if (nodes_[index].size > size) {
+        uint32_t back = NewNode(alignedOffset + size, nodes_[index].size - size);
+        Node &node = nodes_[index];
+        nodes_[back].prevRange = index;
+        nodes_[back].nextRange = node.nextRange;
+        if (node.nextRange != kInvalidNode)
+            nodes_[node.nextRange].prevRange = back;
+        node.nextRange = back;
+        node.size = size;
+        InsertFree(back);
+    }
+    usedSize_ += size;
+    allocationCount_++;
+    return Allocation{alignedOffset, index};
+}
+
+void OffsetAllocator::Free(Allocation allocation)
+{
+    if (!allocation.valid())
+        return;
+    uint32_t index = allocation.node;
+    assert(!nodes_[index].free);
+    usedSize_ -= nodes_[index].size;
+    allocationCount_--;
+
+    uint32_t prev = nodes_[index].prevRange;
+    if (prev != kInvalidNode && nodes_[prev].free) {
+        RemoveFree(prev);
+        Node &node = nodes_[index];
+        nodes_[prev].size += node.size;
+        nodes_[prev].nextRange = node.nextRange;
+        if (node.nextRange != kInvalidNode)
+            nodes_[node.nextRange].prevRange = prev;
+        unusedNodes_.push_back(index);
+        index = prev;
+    }
+    uint32_t next = nodes_[index].nextRange;
+    if (next != kInvalidNode && nodes_[next].free) {
+        RemoveFree(next);
+        Node &node = nodes_[index];
+        node.size += nodes_[next].size;
+        node.nextRange = nodes_[next].nextRange;
+        if (node.nextRange != kInvalidNode)
+            nodes_[node.nextRange].prevRange = index;
+        unusedNodes_.push_back(next);
+    }
+    InsertFree(index);
+}
+
+OffsetAllocator::Statistics OffsetAllocator::statistics() const
+{
+    Statistics statistics;
+    statistics.size = size_;
+    statistics.usedSize = usedSize_;
+    statistics.freeSize = size_ - usedSize_;
+    statistics.allocationCount = allocationCount_;
+    for (uint32_t firstLevel = 0; firstLevel < kFirstLevelCount; firstLevel++) {
+        for (uint32_t secondLevel = 0; secondLevel < kSecondLevelCount; secondLevel++) {
+            for (uint32_t index = bins_[firstLevel][secondLevel]; index != kInvalidNode; index = nodes_[index].nextFree) {
+                statistics.freeRangeCount++;
+                statistics.largestFreeRange = std::max(statistics.largestFreeRange, nodes_[index].size);
+            }
+        }
+    }
+    return statistics;
+}
+
+void OffsetAllocator::Mapping(uint64_t size, uint32_t &firstLevel, uint32_t &secondLevel)
+{
+    // sizes below kSecondLevelCount get exact bins, above that every power of two is split in kSecondLevelCount bins
+    if (size < kSecondLevelCount) {
+        firstLevel = 0;
+        secondLevel = static_cast<uint32_t>(size);
+    } else {
+        uint32_t log2 = 63 - std::countl_zero(size);
+        firstLevel = log2 - kSecondLevelBits + 1;
+        secondLevel = static_cast<uint32_t>(size >> (log2 - kSecondLevelBits)) - kSecondLevelCount;
+    }
+}
+
+uint32_t OffsetAllocator::FindFreeNode(uint64_t size) const
+{
+    // round up to the next bin boundary so every range in the bin found is large enough
+    if (size >= kSecondLevelCount) {
+        uint64_t round = (uint64_t{1} << (63 - std::countl_zero(size) - kSecondLevelBits)) - 1;
+        if (size > UINT64_MAX - round)
+            return kInvalidNode;
+        size += round;
+    }
+    uint32_t firstLevel, secondLevel;
+    Mapping(size, firstLevel, secondLevel);
+    uint32_t secondLevelMap = secondLevelBitmaps_[firstLevel] & (~0u << secondLevel);
+    if (secondLevelMap == 0) {
+        uint64_t firstLevelMap = firstLevel + 1 < 64 ? firstLevelBitmap_ & (~uint64_t{0} << (firstLevel + 1)) : 0;
+        if (firstLevelMap == 0)
+            return kInvalidNode;
+        firstLevel = std::countr_zero(firstLevelMap);
+        secondLevelMap = secondLevelBitmaps_[firstLevel];
+    }
+    secondLevel = std::countr_zero(secondLevelMap);
+    return bins_[firstLevel][secondLevel];
+}
+
+uint32_t OffsetAllocator::NewNode(uint64_t offset, uint64_t size)
+{
+    uint32_t index;
+    if (!unusedNodes_.empty()) {
+        index = unusedNodes_.back();
+        unusedNodes_.pop_back();
+        nodes_[index] = Node{};
+    } else {
+        index = static_cast<uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+    }
+    nodes_[index].offset = offset;
+    nodes_[index].size = size;
+    return index;
+}
+
+void OffsetAllocator::InsertFree(uint32_t index)
+{
+    Node &node = nodes_[index];
+    uint32_t firstLevel, secondLevel;
+    Mapping(node.size, firstLevel, secondLevel);
+    node.free = true;
+    node.prevFree = kInvalidNode;
+    node.nextFree = bins_[firstLevel][secondLevel];
+    if (node.nextFree != kInvalidNode)
+        nodes_[node.nextFree].prevFree = index;
+    bins_[firstLevel][secondLevel] = index;
+    firstLevelBitmap_ |= uint64_t{1} << firstLevel;
+    secondLevelBitmaps_[firstLevel] |= 1u << secondLevel;
+}
+
+void OffsetAllocator::RemoveFree(uint32_t index)
+{
+    Node &node = nodes_[index];
+    if (node.prevFree != kInvalidNode) {
+        nodes_[node.prevFree].nextFree = node.nextFree;
+    } else {
+        uint32_t firstLevel, secondLevel;
+        Mapping(node.size, firstLevel, secondLevel);
+        bins_[firstLevel][secondLevel] = node.nextFree;
+        if (node.nextFree == kInvalidNode) {
+            secondLevelBitmaps_[firstLevel] &= ~(1u << secondLevel);
+            if (secondLevelBitmaps_[firstLevel] == 0)
+                firstLevelBitmap_ &= ~(uint64_t{1} << firstLevel);
+        }
+    }
+    if (node.nextFree != kInvalidNode)
+        nodes_[node.nextFree].prevFree = node.prevFree;
+    node.free = false;
+}
+
+} // namespace gdf
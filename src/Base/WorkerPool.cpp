@@ -0,0 +1,113 @@
+#include "Base/WorkerPool.h"
+#include "DeveloperTool/CpuProfiler.h"
+#include <algorithm>
+
+namespace gdf
+{
+
+WorkerPool::~WorkerPool()
+{
+    if (threadCount_ != 0)
+        Destroy();
+}
+
+void WorkerPool::Create(uint32_t threadCount, const char *threadName)
+{
+    threadCount_ = std::max(threadCount, 1u);
+    threadName_ = threadName;
+    stopping_ = false;
+    jobSerial_ = 0;
+    workerException_ = nullptr;
+    for (uint32_t thread = 1; thread < threadCount_; thread++)
+        workers_.emplace_back(&WorkerPool::WorkerLoop, this);
+}
+
+void WorkerPool::Destroy()
+{
+    {
+        std::scoped_lock<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    startCondition_.notify_all();
+    for (auto &worker : workers_)
+        worker.join();
+    workers_.clear();
+    threadCount_ = 0;
+}
+
+void WorkerPool::ParallelFor(uint32_t itemCount, uint32_t grainSize, const RangeFunction &function)
+{
+    grainSize = std::max(grainSize, 1u);
+    if (workers_.empty() || itemCount <= grainSize) {
+        if (itemCount != 0)
+            function(0, itemCount);
+        return;
+    }
+    {
+        std::scoped_lock<std::mutex> lock(mutex_);
+        nextItem_.store(0, std::memory_order_relaxed);
+        jobItemCount_ = itemCount;
+        jobGrainSize_ = grainSize;
+        jobFunction_ = &function;
+        pendingWorkers_ = static_cast<uint32_t>(workers_.size());
+        jobSerial_++;
+    }
+    startCondition_.notify_all();
+
+    std::exception_ptr exception;
+    try {
+        RunChunks();
+    } catch (...) {
+        exception = std::current_exception();
+        // hand out no more chunks, the job has failed anyway
+        nextItem_.store(itemCount, std::memory_order_relaxed);
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    doneCondition_.wait(lock, [this] { return pendingWorkers_ == 0; });
+    jobFunction_ = nullptr;
+    if (!exception)
+        std::swap(exception, workerException_);
+    workerException_ = nullptr;
+    if (exception)
+        std::rethrow_exception(exception);
+}
+
+void WorkerPool::WorkerLoop()
+{
+    GDF_PROFILE_THREAD(threadName_);
+    uint64_t seenSerial = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            startCondition_.wait(lock, [&] { return stopping_ || jobSerial_ != seenSerial; });
+            if (stopping_)
+                return;
+            seenSerial = jobSerial_;
+        }
+        std::exception_ptr exception;
+        try {
+            RunChunks();
+        } catch (...) {
+            exception = std::current_exception();
+            nextItem_.store(jobItemCount_, std::memory_order_relaxed);
+        }
+        std::scoped_lock<std::mutex> lock(mutex_);
+        if (exception && !workerException_)
+            workerException_ = exception;
+        if (--pendingWorkers_ == 0)
+            doneCondition_.notify_one();
+    }
+}
+
+void WorkerPool::RunChunks()
+{
+    for (;;) {
+        uint64_t first = nextItem_.fetch_add(jobGrainSize_, std::memory_order_relaxed);
+        if (first >= jobItemCount_)
+            return;
+        uint64_t last = std::min<uint64_t>(first + jobGrainSize_, jobItemCount_);
+        (*jobFunction_)(static_cast<uint32_t>(first), static_cast<uint32_t>(last));
+    }
+}
+
+} // namespace gdf
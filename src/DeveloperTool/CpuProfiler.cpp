@@ -0,0 +1,259 @@
+#include "DeveloperTool/CpuProfiler.h"
+
+#ifdef GDF_ENABLE_PROFILER
+#include "Base/File.h"
+#include "imgui.h"
+#include <algorithm>
+#include <chrono>
+#include <nlohmann/json.hpp>
+
+namespace gdf
+{
+
+namespace
+{
+std::atomic<uint64_t> profilerGeneration{0};
+
+struct ThreadState {
+    void *buffer{nullptr};
+    uint64_t generation{0};
+    const char *name{nullptr};
+};
+thread_local ThreadState threadState;
+} // namespace
+
+CpuProfiler::CpuProfiler() : generation_(++profilerGeneration), lastMark_(Now())
+{
+    frameHistory_.resize(kFrameHistorySize);
+}
+
+CpuProfiler::~CpuProfiler() = default;
+
+uint64_t CpuProfiler::Now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void CpuProfiler::SetThreadName(const char *name)
+{
+    threadState.name = name;
+    if (CpuProfiler *pProfiler = pInstance()) {
+        ThreadBuffer *buffer = pProfiler->threadBuffer();
+        std::scoped_lock<std::mutex> lock(pProfiler->threadsMutex_);
+        buffer->name = name;
+    }
+}
+
+CpuProfiler::ThreadBuffer *CpuProfiler::threadBuffer()
+{
+    if (threadState.generation == generation_)
+        return static_cast<ThreadBuffer *>(threadState.buffer);
+    // first zone of this thread, the only time the hot path takes the lock
+    std::scoped_lock<std::mutex> lock(threadsMutex_);
+    auto &buffer = threads_.emplace_back(std::make_unique<ThreadBuffer>());
+    buffer->index = static_cast<uint32_t>(threads_.size() - 1);
+    buffer->name = threadState.name ? threadState.name : "Thread " + std::to_string(buffer->index);
+    threadState.buffer = buffer.get();
+    threadState.generation = generation_;
+    return buffer.get();
+}
+
+void CpuProfiler::BeginZone()
+{
+    threadBuffer()->depth++;
+}
+
+void CpuProfiler::EndZone(const char *name, uint64_t begin)
+{
+    uint64_t end = Now();
+    ThreadBuffer *buffer = threadBuffer();
+    buffer->depth--;
+    uint64_t write = buffer->write.load(std::memory_order_relaxed);
+    if (write - buffer->read.load(std::memory_order_acquire) >= kThreadBufferSize) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer->events[write % kThreadBufferSize] = Event{
+        .name = name,
+        .begin = begin,
+        .end = end,
+        .depth = buffer->depth,
+        .thread = buffer->index,
+    };
+    buffer->write.store(write + 1, std::memory_order_release);
+}
+
+void CpuProfiler::Drain(std::vector<Event> &events)
+{
+    std::scoped_lock<std::mutex> lock(threadsMutex_);
+    for (auto &buffer : threads_) {
+        uint64_t read = buffer->read.load(std::memory_order_relaxed);
+        uint64_t write = buffer->write.load(std::memory_order_acquire);
+        for (; read != write; read++)
+            events.push_back(buffer->events[read % kThreadBufferSize]);
+        buffer->read.store(write, std::memory_order_release);
+    }
+}
+
+void CpuProfiler::FrameMark()
+{
+    uint64_t now = Now();
+    drained_.clear();
+    Drain(drained_);
+    if (capturing_) {
+        size_t count = std::min(drained_.size(), kMaxCaptureEvents - captureEvents_.size());
+        captureEvents_.insert(captureEvents_.end(), drained_.begin(), drained_.begin() + count);
+    }
+    if (!paused_) {
+        // the rings are drained once per frame, so everything drained ended within this frame
+        std::swap(frameEvents_, drained_);
+        frameBegin_ = lastMark_;
+        frameEnd_ = now;
+        frameHistory_[frameHistoryNext_] = static_cast<float>(frameEnd_ - frameBegin_) * 1e-6f;
+        frameHistoryNext_ = (frameHistoryNext_ + 1) % kFrameHistorySize;
+    }
+    lastMark_ = now;
+}
+
+uint64_t CpuProfiler::droppedCount() const
+{
+    std::scoped_lock<std::mutex> lock(threadsMutex_);
+    uint64_t dropped = 0;
+    for (auto &buffer : threads_)
+        dropped += buffer->dropped.load(std::memory_order_relaxed);
+    return dropped;
+}
+
+void CpuProfiler::BeginCapture()
+{
+    captureEvents_.clear();
+    captureEvents_.reserve(64 * 1024);
+    capturing_ = true;
+}
+
+bool CpuProfiler::ExportChromeTrace(const std::string &path)
+{
+    if (capturing_) {
+        drained_.clear();
+        Drain(drained_);
+        size_t count = std::min(drained_.size(), kMaxCaptureEvents - captureEvents_.size());
+        captureEvents_.insert(captureEvents_.end(), drained_.begin(), drained_.begin() + count);
+    }
+    capturing_ = false;
+
+    uint64_t base = UINT64_MAX;
+    for (const auto &event : captureEvents_)
+        base = std::min(base, event.begin);
+    nlohmann::json traceEvents = nlohmann::json::array();
+    {
+        std::scoped_lock<std::mutex> lock(threadsMutex_);
+        for (const auto &buffer : threads_) {
+            traceEvents.push_back({
+                {"name", "thread_name"},
+                {"ph", "M"},
+                {"pid", 0},
+                {"tid", buffer->index},
+                {"args", {{"name", buffer->name}}},
+            });
+        }
+    }
+    // complete events, timestamps and durations in microseconds
+    for (const auto &event : captureEvents_) {
+        traceEvents.push_back({
+            {"name", event.name},
+            {"cat", "cpu"},
+            {"ph", "X"},
+            {"ts", static_cast<double>(event.begin - base) * 1e-3},
+            {"dur", static_cast<double>(event.end - event.begin) * 1e-3},
+            {"pid", 0},
+            {"tid", event.thread},
+        });
+    }
+    nlohmann::json trace{
+        {"traceEvents", std::move(traceEvents)},
+        {"displayTimeUnit", "ms"},
+    };
+    captureEvents_.clear();
+    captureEvents_.shrink_to_fit();
+    std::string text = trace.dump();
+    return File::WriteBytesAtomic(path, text.data(), text.size());
+}
+
+void CpuProfiler::DrawImGui()
+{
+    if (!ImGui::Begin("CPU Profiler")) {
+        ImGui::End();
+        return;
+    }
+
+    double frameMs = static_cast<double>(frameEnd_ - frameBegin_) * 1e-6;
+    ImGui::Text("Frame %.3f ms, %zu zones, %llu dropped",
+                frameMs,
+                frameEvents_.size(),
+                static_cast<unsigned long long>(droppedCount()));
+    ImGui::Checkbox("Pause", &paused_);
+    ImGui::SameLine();
+    if (!capturing_) {
+        if (ImGui::Button("Start Capture"))
+            BeginCapture();
+    } else {
+        std::string path = File::GetExeDir() + std::string(File::Separator()) + "cpu_trace.json";
+        if (ImGui::Button("Save Capture"))
+            ExportChromeTrace(path);
+        ImGui::SameLine();
+        ImGui::Text("%zu zones -> %s", captureEvents_.size(), path.c_str());
+    }
+    ImGui::PlotLines("##FrameHistory",
+                     frameHistory_.data(),
+                     static_cast<int>(frameHistory_.size()),
+                     static_cast<int>(frameHistoryNext_),
+                     "frame ms",
+                     0.0f,
+                     FLT_MAX,
+                     ImVec2{0.0f, 40.0f});
+
+    std::vector<std::string> threadNames;
+    {
+        std::scoped_lock<std::mutex> lock(threadsMutex_);
+        for (const auto &buffer : threads_)
+            threadNames.push_back(buffer->name);
+    }
+    // one block per thread, a zone one row below the zone it is nested in
+    const float rowHeight = ImGui::GetTextLineHeightWithSpacing();
+    const float width = std::max(ImGui::GetContentRegionAvail().x, 1.0f);
+    const double scale = frameEnd_ > frameBegin_ ? width / static_cast<double>(frameEnd_ - frameBegin_) : 0.0;
+    ImDrawList *drawList = ImGui::GetWindowDrawList();
+    for (uint32_t thread = 0; thread < threadNames.size(); thread++) {
+        uint32_t rows = 0;
+        for (const auto &event : frameEvents_) {
+            if (event.thread == thread)
+                rows = std::max(rows, event.depth + 1);
+        }
+        if (rows == 0)
+            continue;
+        ImGui::TextUnformatted(threadNames[thread].c_str());
+        ImVec2 origin = ImGui::GetCursorScreenPos();
+        for (const auto &event : frameEvents_) {
+            if (event.thread != thread)
+                continue;
+            uint64_t begin = std::max(event.begin, frameBegin_);
+            float x0 = static_cast<float>(static_cast<double>(begin - frameBegin_) * scale);
+            float x1 = static_cast<float>(static_cast<double>(event.end - frameBegin_) * scale);
+            ImVec2 min{origin.x + x0, origin.y + rowHeight * event.depth};
+            ImVec2 max{origin.x + std::max(x1, x0 + 1.0f), min.y + rowHeight - 1.0f};
+            ImU32 color = ImColor::HSV(static_cast<float>(event.depth % 6) / 6.0f, 0.5f, 0.75f);
+            drawList->AddRectFilled(min, max, color);
+            drawList->PushClipRect(min, max, true);
+            drawList->AddText(ImVec2{min.x + 2.0f, min.y}, IM_COL32_WHITE, event.name);
+            drawList->PopClipRect();
+            if (ImGui::IsMouseHoveringRect(min, max))
+                ImGui::SetTooltip("%s\n%.3f ms", event.name, static_cast<double>(event.end - event.begin) * 1e-6);
+        }
+        ImGui::Dummy(ImVec2{width, rowHeight * rows});
+    }
+    ImGui::End();
+}
+
+} // namespace gdf
+#endif // GDF_ENABLE_PROFILER
@@ -1,6 +1,8 @@
 #include "DeveloperTool/DeveloperConsole.h"
 #include "Log/Logger.h"
 #include "fmt/core.h"
+#include <algorithm>
+#include <cstring>
 
 namespace gdf
 {
@@ -9,6 +11,7 @@ GDF_DEFINE_EXPORT_LOG_CATEGORY(ConsoleCommand)
 
 DeveloperConsole::DeveloperConsole(size_t maxEntries) : maxEntries_(maxEntries)
 {
+    Reserve(maxEntries_);
 }
 
 bool DeveloperConsole::RunCommand(std::string_view commandCall)
@@ -24,10 +27,37 @@ bool DeveloperConsole::RunCommand(std::string_view commandCall)
 void DeveloperConsole::Log(const LogCategory *category, const LogLevel level, const std::string_view message)
 {
     std::scoped_lock<std::mutex> lock(sync_);
-    entries_.emplace_back(Entry{category, level, message});
-    if (entries_.size() > maxEntries_) {
-        entries_.pop_front();
+    if (maxEntries_ == 0)
+        return;
+    size_t size = std::min(message.size(), arena_.size());
+    if (count_ == maxEntries_)
+        PopOldest();
+    // empty entries take no arena bytes, the oldest entry with some decides and goes with the empty ones before it
+    auto popThrough = [this](size_t index) {
+        for (size_t i = 0; i <= index; i++)
+            PopOldest();
+    };
+    if (writeOffset_ + size > arena_.size()) {
+        // the entries past the write offset are the oldest ones, they go before anything at the start is reused
+        for (size_t index = OldestWithBytes(); index < count_; index = OldestWithBytes()) {
+            if (entries_[(head_ + index) % maxEntries_].offset < writeOffset_)
+                break;
+            popThrough(index);
+        }
+        writeOffset_ = 0;
     }
+    // entries sit in the arena in log order, so only the oldest ones can be in the way
+    for (size_t index = OldestWithBytes(); index < count_; index = OldestWithBytes()) {
+        const Entry &oldest = entries_[(head_ + index) % maxEntries_];
+        if (oldest.offset >= writeOffset_ + size || oldest.offset + oldest.size <= writeOffset_)
+            break;
+        popThrough(index);
+    }
+    std::memcpy(arena_.data() + writeOffset_, message.data(), size);
+    entries_[(head_ + count_) % maxEntries_] =
+        Entry{category, level, static_cast<uint32_t>(writeOffset_), static_cast<uint32_t>(size)};
+    count_++;
+    writeOffset_ += size;
 }
 
 void DeveloperConsole::Exception()
@@ -37,12 +67,68 @@ void DeveloperConsole::Exception()
 void DeveloperConsole::maxEntries(size_t maxEntries)
 {
     std::scoped_lock<std::mutex> lock(sync_);
+    std::vector<char> arena = std::move(arena_);
+    std::vector<Entry> entries = std::move(entries_);
+    size_t oldMaxEntries = maxEntries_;
+    size_t head = head_;
+    size_t count = count_;
     maxEntries_ = maxEntries;
-    while (entries_.size() > maxEntries_) {
-        entries_.pop_front();
+    Reserve(maxEntries_);
+    // keep the newest entries that fit, repacked from the start of the new arena
+    size_t keep = std::min(count, maxEntries_);
+    size_t first = count - keep;
+    size_t bytes = 0;
+    for (size_t i = count; i > first; i--) {
+        const Entry &entry = entries[(head + i - 1) % oldMaxEntries];
+        if (bytes + entry.size > arena_.size()) {
+            first = i;
+            break;
+        }
+        bytes += entry.size;
+    }
+    for (size_t i = first; i < count; i++) {
+        const Entry &entry = entries[(head + i) % oldMaxEntries];
+        std::memcpy(arena_.data() + writeOffset_, arena.data() + entry.offset, entry.size);
+        entries_[count_++] = Entry{entry.category, entry.level, static_cast<uint32_t>(writeOffset_), entry.size};
+        writeOffset_ += entry.size;
     }
 }
 
+size_t DeveloperConsole::entryCount()
+{
+    std::scoped_lock<std::mutex> lock(sync_);
+    return count_;
+}
+
+size_t DeveloperConsole::memoryUsage()
+{
+    std::scoped_lock<std::mutex> lock(sync_);
+    return arena_.size() + entries_.size() * sizeof(Entry);
+}
+
+void DeveloperConsole::Reserve(size_t maxEntries)
+{
+    arena_.assign(maxEntries * kArenaBytesPerEntry, '\0');
+    entries_.assign(maxEntries, Entry{});
+    head_ = 0;
+    count_ = 0;
+    writeOffset_ = 0;
+}
+
+void DeveloperConsole::PopOldest()
+{
+    head_ = (head_ + 1) % maxEntries_;
+    count_--;
+}
+
+size_t DeveloperConsole::OldestWithBytes() const
+{
+    size_t index = 0;
+    while (index < count_ && entries_[(head_ + index) % maxEntries_].size == 0)
+        index++;
+    return index;
+}
+
 DeveloperConsole &DeveloperConsole::Instance()
 {
     static DeveloperConsole instance;
@@ -0,0 +1,559 @@
+#include "Graphics/AccessorDecode.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define GDF_ACCESSOR_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC compiles any intrinsic without flags, GCC and Clang need the set enabled per function
+#if defined(GDF_ACCESSOR_X86) && !defined(_MSC_VER)
+#define GDF_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define GDF_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define GDF_TARGET_SSE41
+#define GDF_TARGET_AVX2
+#endif
+
+namespace gdf
+{
+
+namespace
+{
+constexpr float kFill[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+
+template <int ComponentType>
+using TypeConstant = std::integral_constant<int, ComponentType>;
+template <uint32_t Components>
+using ComponentsConstant = std::integral_constant<uint32_t, Components>;
+
+template <typename T>
+T LoadUnaligned(const uint8_t *source)
+{
+    T value;
+    std::memcpy(&value, source, sizeof(T));
+    return value;
+}
+
+inline float *DestinationAt(float *destination, size_t stride, uint32_t index)
+{
+    return reinterpret_cast<float *>(reinterpret_cast<uint8_t *>(destination) + stride * index);
+}
+
+// Calls function(TypeConstant, ComponentsConstant) for the kernels' component types, false for any other type
+template <typename Function>
+bool DispatchDecode(int componentType, uint32_t components, Function &&function)
+{
+    auto withComponents = [&](auto type) {
+        switch (components) {
+        case 1:
+            function(type, ComponentsConstant<1>{});
+            break;
+        case 2:
+            function(type, ComponentsConstant<2>{});
+            break;
+        case 3:
+            function(type, ComponentsConstant<3>{});
+            break;
+        case 4:
+            function(type, ComponentsConstant<4>{});
+            break;
+        }
+    };
+    switch (componentType) {
+    case kComponentFloat:
+        withComponents(TypeConstant<kComponentFloat>{});
+        return true;
+    case kComponentByte:
+        withComponents(TypeConstant<kComponentByte>{});
+        return true;
+    case kComponentUnsignedByte:
+        withComponents(TypeConstant<kComponentUnsignedByte>{});
+        return true;
+    case kComponentShort:
+        withComponents(TypeConstant<kComponentShort>{});
+        return true;
+    case kComponentUnsignedShort:
+        withComponents(TypeConstant<kComponentUnsignedShort>{});
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Scalar kernels, also the tails of the vector ones. Divisions rather than reciprocal multiplies keep them
+// bit-identical to the vector kernels.
+template <int ComponentType>
+float LoadComponent(const uint8_t *component, bool normalized)
+{
+    if constexpr (ComponentType == kComponentFloat) {
+        return LoadUnaligned<float>(component);
+    } else if constexpr (ComponentType == kComponentUnsignedByte) {
+        float value = static_cast<float>(component[0]);
+        return normalized ? value / 255.0f : value;
+    } else if constexpr (ComponentType == kComponentByte) {
+        float value = static_cast<float>(LoadUnaligned<int8_t>(component));
+        return normalized ? std::max(value / 127.0f, -1.0f) : value;
+    } else if constexpr (ComponentType == kComponentUnsignedShort) {
+        float value = static_cast<float>(LoadUnaligned<uint16_t>(component));
+        return normalized ? value / 65535.0f : value;
+    } else if constexpr (ComponentType == kComponentShort) {
+        float value = static_cast<float>(LoadUnaligned<int16_t>(component));
+        return normalized ? std::max(value / 32767.0f, -1.0f) : value;
+    } else {
+        return static_cast<float>(LoadUnaligned<uint32_t>(component));
+    }
+}
+
+template <int ComponentType, uint32_t Components>
+void DecodeElement(const AccessorStream &source, uint32_t index, float *destination)
+{
+    const uint8_t *element = source.data + source.stride * index;
+    for (uint32_t c = 0; c < Components; c++) {
+        destination[c] = c < source.componentCount
+                             ? LoadComponent<ComponentType>(element + c * AccessorComponentSize(ComponentType),
+                                                            source.normalized)
+                             : kFill[c];
+    }
+}
+
+template <int ComponentType, uint32_t Components>
+void DecodeLoopScalar(
+    const AccessorStream &source, float *destination, size_t destinationStride, uint32_t first, uint32_t count)
+{
+    for (uint32_t i = first; i < count; i++)
+        DecodeElement<ComponentType, Components>(source, i, DestinationAt(destination, destinationStride, i));
+}
+
+void DecodeScalar(const AccessorStream &source,
+                  float *destination,
+                  size_t destinationStride,
+                  uint32_t destinationComponents,
+                  uint32_t count)
+{
+    bool dispatched = DispatchDecode(source.componentType, destinationComponents, [&](auto type, auto components) {
+        DecodeLoopScalar<decltype(type)::value, decltype(components)::value>(source, destination, destinationStride, 0, count);
+    });
+    // u32 components only appear unnormalized and in no vertex attribute the loader reads, they get no kernel
+    if (!dispatched && source.componentType == kComponentUnsignedInt) {
+        DispatchDecode(kComponentFloat, destinationComponents, [&](auto, auto components) {
+            DecodeLoopScalar<kComponentUnsignedInt, decltype(components)::value>(
+                source, destination, destinationStride, 0, count);
+        });
+    }
+}
+
+void NormalizeScalar(float *vectors, size_t stride, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        float *vector = DestinationAt(vectors, stride, i);
+        float scale = 1.0f / std::sqrt(vector[0] * vector[0] + vector[1] * vector[1] + vector[2] * vector[2]);
+        vector[0] *= scale;
+        vector[1] *= scale;
+        vector[2] *= scale;
+    }
+}
+
+template <typename Index>
+void WidenLoopScalar(const uint8_t *source, uint32_t first, uint32_t count, uint32_t base, uint32_t *destination)
+{
+    for (uint32_t i = first; i < count; i++)
+        destination[i] = static_cast<uint32_t>(LoadUnaligned<Index>(source + i * sizeof(Index))) + base;
+}
+
+void WidenScalar(const uint8_t *source, int componentType, uint32_t count, uint32_t base, uint32_t *destination)
+{
+    switch (componentType) {
+    case kComponentUnsignedByte:
+        WidenLoopScalar<uint8_t>(source, 0, count, base, destination);
+        break;
+    case kComponentUnsignedShort:
+        WidenLoopScalar<uint16_t>(source, 0, count, base, destination);
+        break;
+    case kComponentUnsignedInt:
+        WidenLoopScalar<uint32_t>(source, 0, count, base, destination);
+        break;
+    }
+}
+
+// Elements a vector kernel may load whole: a load always reads four components, which runs past the end of the
+// stream for the last elements of a narrower one
+uint32_t VectorCount(const AccessorStream &source, uint32_t count)
+{
+    size_t componentSize = AccessorComponentSize(source.componentType);
+    size_t loadSize = 4 * componentSize;
+    size_t elementSize = source.componentCount * componentSize;
+    if (loadSize <= elementSize || count == 0)
+        return count;
+    size_t skip = (loadSize - elementSize + source.stride - 1) / source.stride;
+    return count > skip ? static_cast<uint32_t>(count - skip) : 0;
+}
+
+#ifdef GDF_ACCESSOR_X86
+template <int ComponentType>
+GDF_TARGET_SSE41 inline __m128 LoadSSE41(const uint8_t *element, bool normalized)
+{
+    if constexpr (ComponentType == kComponentFloat) {
+        return _mm_loadu_ps(reinterpret_cast<const float *>(element));
+    } else if constexpr (ComponentType == kComponentUnsignedByte) {
+        __m128 value = _mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(LoadUnaligned<int32_t>(element))));
+        return normalized ? _mm_div_ps(value, _mm_set1_ps(255.0f)) : value;
+    } else if constexpr (ComponentType == kComponentByte) {
+        __m128 value = _mm_cvtepi32_ps(_mm_cvtepi8_epi32(_mm_cvtsi32_si128(LoadUnaligned<int32_t>(element))));
+        return normalized ? _mm_max_ps(_mm_div_ps(value, _mm_set1_ps(127.0f)), _mm_set1_ps(-1.0f)) : value;
+    } else if constexpr (ComponentType == kComponentUnsignedShort) {
+        __m128i packed = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(element));
+        __m128 value = _mm_cvtepi32_ps(_mm_cvtepu16_epi32(packed));
+        return normalized ? _mm_div_ps(value, _mm_set1_ps(65535.0f)) : value;
+    } else {
+        __m128i packed = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(element));
+        __m128 value = _mm_cvtepi32_ps(_mm_cvtepi16_epi32(packed));
+        return normalized ? _mm_max_ps(_mm_div_ps(value, _mm_set1_ps(32767.0f)), _mm_set1_ps(-1.0f)) : value;
+    }
+}
+
+template <uint32_t Components>
+GDF_TARGET_SSE41 inline void StoreSSE41(float *destination, __m128 value)
+{
+    if constexpr (Components == 4) {
+        _mm_storeu_ps(destination, value);
+    } else if constexpr (Components == 3) {
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(destination), _mm_castps_si128(value));
+        _mm_store_ss(destination + 2, _mm_movehl_ps(value, value));
+    } else if constexpr (Components == 2) {
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(destination), _mm_castps_si128(value));
+    } else {
+        _mm_store_ss(destination, value);
+    }
+}
+
+// all ones in the lanes the stream has, the others take the fill value
+GDF_TARGET_SSE41 inline __m128 KeepMaskSSE41(uint32_t componentCount)
+{
+    __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+    return _mm_castsi128_ps(_mm_cmplt_epi32(lanes, _mm_set1_epi32(static_cast<int>(componentCount))));
+}
+
+template <int ComponentType, uint32_t Components>
+GDF_TARGET_SSE41 void DecodeLoopSSE41(
+    const AccessorStream &source, float *destination, size_t destinationStride, uint32_t first, uint32_t vectorCount)
+{
+    __m128 fill = _mm_loadu_ps(kFill);
+    __m128 keep = KeepMaskSSE41(source.componentCount);
+    for (uint32_t i = first; i < vectorCount; i++) {
+        __m128 value = LoadSSE41<ComponentType>(source.data + source.stride * i, source.normalized);
+        StoreSSE41<Components>(DestinationAt(destination, destinationStride, i), _mm_blendv_ps(fill, value, keep));
+    }
+}
+
+void DecodeSSE41(const AccessorStream &source,
+                 float *destination,
+                 size_t destinationStride,
+                 uint32_t destinationComponents,
+                 uint32_t count)
+{
+    uint32_t vectorCount = VectorCount(source, count);
+    bool dispatched = DispatchDecode(source.componentType, destinationComponents, [&](auto type, auto components) {
+        constexpr int kType = decltype(type)::value;
+        constexpr uint32_t kComponents = decltype(components)::value;
+        DecodeLoopSSE41<kType, kComponents>(source, destination, destinationStride, 0, vectorCount);
+        DecodeLoopScalar<kType, kComponents>(source, destination, destinationStride, vectorCount, count);
+    });
+    if (!dispatched)
+        DecodeScalar(source, destination, destinationStride, destinationComponents, count);
+}
+
+GDF_TARGET_SSE41 void NormalizeSSE41(float *vectors, size_t stride, uint32_t count)
+{
+    __m128 one = _mm_set1_ps(1.0f);
+    for (uint32_t i = 0; i < count; i++) {
+        float *vector = DestinationAt(vectors, stride, i);
+        // exactly three floats, the vector may end the buffer
+        __m128 xy = _mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(vector)));
+        __m128 value = _mm_movelh_ps(xy, _mm_load_ss(vector + 2));
+        __m128 length = _mm_sqrt_ps(_mm_dp_ps(value, value, 0x7F));
+        StoreSSE41<3>(vector, _mm_mul_ps(value, _mm_div_ps(one, length)));
+    }
+}
+
+GDF_TARGET_SSE41 void WidenSSE41(const uint8_t *source, int componentType, uint32_t count, uint32_t base, uint32_t *destination)
+{
+    __m128i offset = _mm_set1_epi32(static_cast<int>(base));
+    __m128i *output = reinterpret_cast<__m128i *>(destination);
+    uint32_t i = 0;
+    switch (componentType) {
+    case kComponentUnsignedByte:
+        for (; i + 16 <= count; i += 16) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i));
+            _mm_storeu_si128(output + i / 4, _mm_add_epi32(_mm_cvtepu8_epi32(bytes), offset));
+            _mm_storeu_si128(output + i / 4 + 1, _mm_add_epi32(_mm_cvtepu8_epi32(_mm_srli_si128(bytes, 4)), offset));
+            _mm_storeu_si128(output + i / 4 + 2, _mm_add_epi32(_mm_cvtepu8_epi32(_mm_srli_si128(bytes, 8)), offset));
+            _mm_storeu_si128(output + i / 4 + 3, _mm_add_epi32(_mm_cvtepu8_epi32(_mm_srli_si128(bytes, 12)), offset));
+        }
+        WidenLoopScalar<uint8_t>(source, i, count, base, destination);
+        break;
+    case kComponentUnsignedShort:
+        for (; i + 8 <= count; i += 8) {
+            __m128i shorts = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i * 2));
+            _mm_storeu_si128(output + i / 4, _mm_add_epi32(_mm_cvtepu16_epi32(shorts), offset));
+            _mm_storeu_si128(output + i / 4 + 1, _mm_add_epi32(_mm_cvtepu16_epi32(_mm_srli_si128(shorts, 8)), offset));
+        }
+        WidenLoopScalar<uint16_t>(source, i, count, base, destination);
+        break;
+    case kComponentUnsignedInt:
+        for (; i + 4 <= count; i += 4) {
+            __m128i ints = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i * 4));
+            _mm_storeu_si128(output + i / 4, _mm_add_epi32(ints, offset));
+        }
+        WidenLoopScalar<uint32_t>(source, i, count, base, destination);
+        break;
+    }
+}
+
+// two elements per 256 bit register, the conversions are where the wider registers pay off
+template <int ComponentType>
+GDF_TARGET_AVX2 inline __m256 LoadPairAVX2(const uint8_t *first, const uint8_t *second, bool normalized)
+{
+    if constexpr (ComponentType == kComponentFloat) {
+        __m128 low = _mm_loadu_ps(reinterpret_cast<const float *>(first));
+        __m128 high = _mm_loadu_ps(reinterpret_cast<const float *>(second));
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(low), high, 1);
+    } else if constexpr (ComponentType == kComponentUnsignedByte || ComponentType == kComponentByte) {
+        __m128i packed = _mm_unpacklo_epi32(_mm_cvtsi32_si128(LoadUnaligned<int32_t>(first)),
+                                            _mm_cvtsi32_si128(LoadUnaligned<int32_t>(second)));
+        if constexpr (ComponentType == kComponentUnsignedByte) {
+            __m256 value = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(packed));
+            return normalized ? _mm256_div_ps(value, _mm256_set1_ps(255.0f)) : value;
+        } else {
+            __m256 value = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(packed));
+            return normalized ? _mm256_max_ps(_mm256_div_ps(value, _mm256_set1_ps(127.0f)), _mm256_set1_ps(-1.0f))
+                              : value;
+        }
+    } else {
+        __m128i packed = _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(first)),
+                                            _mm_loadl_epi64(reinterpret_cast<const __m128i *>(second)));
+        if constexpr (ComponentType == kComponentUnsignedShort) {
+            __m256 value = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(packed));
+            return normalized ? _mm256_div_ps(value, _mm256_set1_ps(65535.0f)) : value;
+        } else {
+            __m256 value = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(packed));
+            return normalized ? _mm256_max_ps(_mm256_div_ps(value, _mm256_set1_ps(32767.0f)), _mm256_set1_ps(-1.0f))
+                              : value;
+        }
+    }
+}
+
+template <int ComponentType, uint32_t Components>
+GDF_TARGET_AVX2 void DecodeLoopAVX2(
+    const AccessorStream &source, float *destination, size_t destinationStride, uint32_t vectorCount)
+{
+    __m128 fill128 = _mm_loadu_ps(kFill);
+    __m256 fill = _mm256_insertf128_ps(_mm256_castps128_ps256(fill128), fill128, 1);
+    __m128 keep128 = KeepMaskSSE41(source.componentCount);
+    __m256 keep = _mm256_insertf128_ps(_mm256_castps128_ps256(keep128), keep128, 1);
+    uint32_t i = 0;
+    for (; i + 2 <= vectorCount; i += 2) {
+        const uint8_t *element = source.data + source.stride * i;
+        __m256 pair = LoadPairAVX2<ComponentType>(element, element + source.stride, source.normalized);
+        __m256 value = _mm256_blendv_ps(fill, pair, keep);
+        StoreSSE41<Components>(DestinationAt(destination, destinationStride, i), _mm256_castps256_ps128(value));
+        StoreSSE41<Components>(DestinationAt(destination, destinationStride, i + 1), _mm256_extractf128_ps(value, 1));
+    }
+    DecodeLoopSSE41<ComponentType, Components>(source, destination, destinationStride, i, vectorCount);
+}
+
+void DecodeAVX2(const AccessorStream &source,
+                float *destination,
+                size_t destinationStride,
+                uint32_t destinationComponents,
+                uint32_t count)
+{
+    uint32_t vectorCount = VectorCount(source, count);
+    bool dispatched = DispatchDecode(source.componentType, destinationComponents, [&](auto type, auto components) {
+        constexpr int kType = decltype(type)::value;
+        constexpr uint32_t kComponents = decltype(components)::value;
+        DecodeLoopAVX2<kType, kComponents>(source, destination, destinationStride, vectorCount);
+        DecodeLoopScalar<kType, kComponents>(source, destination, destinationStride, vectorCount, count);
+    });
+    if (!dispatched)
+        DecodeScalar(source, destination, destinationStride, destinationComponents, count);
+}
+
+GDF_TARGET_AVX2 void WidenAVX2(const uint8_t *source, int componentType, uint32_t count, uint32_t base, uint32_t *destination)
+{
+    __m256i offset = _mm256_set1_epi32(static_cast<int>(base));
+    __m256i *output = reinterpret_cast<__m256i *>(destination);
+    uint32_t i = 0;
+    switch (componentType) {
+    case kComponentUnsignedByte:
+        for (; i + 16 <= count; i += 16) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i));
+            _mm256_storeu_si256(output + i / 8, _mm256_add_epi32(_mm256_cvtepu8_epi32(bytes), offset));
+            _mm256_storeu_si256(output + i / 8 + 1, _mm256_add_epi32(_mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 8)), offset));
+        }
+        WidenLoopScalar<uint8_t>(source, i, count, base, destination);
+        break;
+    case kComponentUnsignedShort:
+        for (; i + 16 <= count; i += 16) {
+            __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i * 2));
+            __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i * 2 + 16));
+            _mm256_storeu_si256(output + i / 8, _mm256_add_epi32(_mm256_cvtepu16_epi32(low), offset));
+            _mm256_storeu_si256(output + i / 8 + 1, _mm256_add_epi32(_mm256_cvtepu16_epi32(high), offset));
+        }
+        WidenLoopScalar<uint16_t>(source, i, count, base, destination);
+        break;
+    case kComponentUnsignedInt:
+        for (; i + 8 <= count; i += 8) {
+            __m256i ints = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(source + i * 4));
+            _mm256_storeu_si256(output + i / 8, _mm256_add_epi32(ints, offset));
+        }
+        WidenLoopScalar<uint32_t>(source, i, count, base, destination);
+        break;
+    }
+}
+#endif
+
+struct AccessorKernels {
+    AccessorKernelSet kernelSet;
+    void (*decode)(const AccessorStream &, float *, size_t, uint32_t, uint32_t);
+    void (*normalize)(float *, size_t, uint32_t);
+    void (*widen)(const uint8_t *, int, uint32_t, uint32_t, uint32_t *);
+};
+
+constexpr AccessorKernels kScalarKernels{AccessorKernelSet::Scalar, DecodeScalar, NormalizeScalar, WidenScalar};
+#ifdef GDF_ACCESSOR_X86
+constexpr AccessorKernels kSSE41Kernels{AccessorKernelSet::SSE41, DecodeSSE41, NormalizeSSE41, WidenSSE41};
+// a vec3 fills one 128 bit register, normalizing gains nothing from AVX2
+constexpr AccessorKernels kAVX2Kernels{AccessorKernelSet::AVX2, DecodeAVX2, NormalizeSSE41, WidenAVX2};
+#endif
+
+const AccessorKernels *KernelsOf(AccessorKernelSet kernelSet)
+{
+    switch (kernelSet) {
+#ifdef GDF_ACCESSOR_X86
+    case AccessorKernelSet::SSE41:
+        return &kSSE41Kernels;
+    case AccessorKernelSet::AVX2:
+        return &kAVX2Kernels;
+#endif
+    default:
+        return &kScalarKernels;
+    }
+}
+
+const AccessorKernels *BestKernels()
+{
+#ifdef GDF_ACCESSOR_X86
+    if (AccessorKernelSetSupported(AccessorKernelSet::AVX2))
+        return &kAVX2Kernels;
+    if (AccessorKernelSetSupported(AccessorKernelSet::SSE41))
+        return &kSSE41Kernels;
+#endif
+    return &kScalarKernels;
+}
+
+std::atomic<const AccessorKernels *> &Kernels()
+{
+    static std::atomic<const AccessorKernels *> kernels{BestKernels()};
+    return kernels;
+}
+
+const AccessorKernels &CurrentKernels()
+{
+    return *Kernels().load(std::memory_order_relaxed);
+}
+} // namespace
+
+void DecodeAccessor(const AccessorStream &source,
+                    float *destination,
+                    size_t destinationStride,
+                    uint32_t destinationComponents,
+                    uint32_t count)
+{
+    if (source.componentCount == 0 || source.componentCount > 4 || destinationComponents == 0 ||
+        destinationComponents > 4) {
+        FillAccessor(kFill, destination, destinationStride, std::min(destinationComponents, 4u), count);
+        return;
+    }
+    CurrentKernels().decode(source, destination, destinationStride, destinationComponents, count);
+}
+
+void FillAccessor(
+    const float *value, float *destination, size_t destinationStride, uint32_t destinationComponents, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+        std::memcpy(DestinationAt(destination, destinationStride, i), value, destinationComponents * sizeof(float));
+}
+
+void NormalizeVectors(float *vectors, size_t stride, uint32_t count)
+{
+    CurrentKernels().normalize(vectors, stride, count);
+}
+
+void WidenIndices(const uint8_t *source, int componentType, uint32_t count, uint32_t base, uint32_t *destination)
+{
+    CurrentKernels().widen(source, componentType, count, base, destination);
+}
+
+AccessorKernelSet accessorKernelSet()
+{
+    return CurrentKernels().kernelSet;
+}
+
+bool AccessorKernelSetSupported(AccessorKernelSet kernelSet)
+{
+    if (kernelSet == AccessorKernelSet::Scalar)
+        return true;
+#if defined(GDF_ACCESSOR_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+    __cpuid(info, 1);
+    bool sse41 = (info[2] & (1 << 19)) != 0;
+    if (kernelSet == AccessorKernelSet::SSE41)
+        return sse41;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    // the OS must also save the YMM registers
+    if (maxLeaf < 7 || !sse41 || !osxsave || !avx || (_xgetbv(0) & 6) != 6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#elif defined(GDF_ACCESSOR_X86)
+    __builtin_cpu_init();
+    if (kernelSet == AccessorKernelSet::SSE41)
+        return __builtin_cpu_supports("sse4.1");
+    return __builtin_cpu_supports("sse4.1") && __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+bool SetAccessorKernelSet(AccessorKernelSet kernelSet)
+{
+    if (!AccessorKernelSetSupported(kernelSet))
+        return false;
+    Kernels().store(KernelsOf(kernelSet), std::memory_order_relaxed);
+    return true;
+}
+
+const char *AccessorKernelSetName(AccessorKernelSet kernelSet)
+{
+    switch (kernelSet) {
+    case AccessorKernelSet::SSE41:
+        return "SSE4.1";
+    case AccessorKernelSet::AVX2:
+        return "AVX2";
+    default:
+        return "scalar";
+    }
+}
+
+} // namespace gdf
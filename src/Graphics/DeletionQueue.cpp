@@ -0,0 +1,145 @@
+#include "Graphics/DeletionQueue.h"
+#include "DeveloperTool/CpuProfiler.h"
+#include "Graphics/FrameSync.h"
+#include "Graphics/VulkanDevice.h"
+
+namespace gdf
+{
+
+void DeletionQueue::Create(VulkanDevice *device, FrameSync *frameSync)
+{
+    device_ = device;
+    frameSync_ = frameSync;
+}
+
+void DeletionQueue::Destroy()
+{
+    for (auto &entry : entries_)
+        DestroyEntry(entry);
+    entries_.clear();
+}
+
+template <typename T>
+void DeletionQueue::Push(Kind kind, T handle, uint64_t lastUsedFrame)
+{
+    if (handle == VK_NULL_HANDLE)
+        return;
+    entries_.push_back(Entry{
+        .frame = lastUsedFrame == kCurrentFrame ? frameSync_->nextFrame() : lastUsedFrame,
+        .kind = kind,
+        .handle = reinterpret_cast<uint64_t>(handle),
+    });
+}
+
+void DeletionQueue::Enqueue(VkBuffer buffer, uint64_t lastUsedFrame)
+{
+    Push(Kind::Buffer, buffer, lastUsedFrame);
+}
+
+void DeletionQueue::Enqueue(VkImage image, uint64_t lastUsedFrame)
+{
+    Push(Kind::Image, image, lastUsedFrame);
+}
+
+void DeletionQueue::Enqueue(VkImageView imageView, uint64_t lastUsedFrame)
+{
+    Push(Kind::ImageView, imageView, lastUsedFrame);
+}
+
+void DeletionQueue::Enqueue(VkSampler sampler, uint64_t lastUsedFrame)
+{
+    Push(Kind::Sampler, sampler, lastUsedFrame);
+}
+
+void DeletionQueue::Enqueue(VkFramebuffer framebuffer, uint64_t lastUsedFrame)
+{
+    Push(Kind::Framebuffer, framebuffer, lastUsedFrame);
+}
+
+void DeletionQueue::Enqueue(VkRenderPass renderPass, uint64_t lastUsedFrame)
+{
+    Push(Kind::RenderPass, renderPass, lastUsedFrame);
+}
+
+void DeletionQueue::Enqueue(VkPipeline pipeline, uint64_t lastUsedFrame)
+{
+    Push(Kind::Pipeline, pipeline, lastUsedFrame);
+}
+
+void DeletionQueue::Enqueue(VkPipelineLayout pipelineLayout, uint64_t lastUsedFrame)
+{
+    Push(Kind::PipelineLayout, pipelineLayout, lastUsedFrame);
+}
+
+void DeletionQueue::Enqueue(VkCommandPool commandPool, uint64_t lastUsedFrame)
+{
+    Push(Kind::CommandPool, commandPool, lastUsedFrame);
+}
+
+void DeletionQueue::Enqueue(VkSwapchainKHR swapchain, uint64_t lastUsedFrame)
+{
+    Push(Kind::Swapchain, swapchain, lastUsedFrame);
+}
+
+void DeletionQueue::Enqueue(const DeviceAllocation &allocation, uint64_t lastUsedFrame)
+{
+    if (allocation.memory == VK_NULL_HANDLE)
+        return;
+    entries_.push_back(Entry{
+        .frame = lastUsedFrame == kCurrentFrame ? frameSync_->nextFrame() : lastUsedFrame,
+        .kind = Kind::Allocation,
+        .allocation = allocation,
+    });
+}
+
+void DeletionQueue::Collect()
+{
+    GDF_PROFILE_FUNCTION();
+    // frames retire in order, the first entry still in use ends the pass
+    while (!entries_.empty() && frameSync_->IsRetired(entries_.front().frame)) {
+        DestroyEntry(entries_.front());
+        entries_.pop_front();
+    }
+}
+
+void DeletionQueue::DestroyEntry(Entry &entry)
+{
+    VkDevice device = *device_;
+    switch (entry.kind) {
+    case Kind::Buffer:
+        vkDestroyBuffer(device, reinterpret_cast<VkBuffer>(entry.handle), nullptr);
+        break;
+    case Kind::Image:
+        vkDestroyImage(device, reinterpret_cast<VkImage>(entry.handle), nullptr);
+        break;
+    case Kind::ImageView:
+        vkDestroyImageView(device, reinterpret_cast<VkImageView>(entry.handle), nullptr);
+        break;
+    case Kind::Sampler:
+        vkDestroySampler(device, reinterpret_cast<VkSampler>(entry.handle), nullptr);
+        break;
+    case Kind::Framebuffer:
+        vkDestroyFramebuffer(device, reinterpret_cast<VkFramebuffer>(entry.handle), nullptr);
+        break;
+    case Kind::RenderPass:
+        vkDestroyRenderPass(device, reinterpret_cast<VkRenderPass>(entry.handle), nullptr);
+        break;
+    case Kind::Pipeline:
+        vkDestroyPipeline(device, reinterpret_cast<VkPipeline>(entry.handle), nullptr);
+        break;
+    case Kind::PipelineLayout:
+        vkDestroyPipelineLayout(device, reinterpret_cast<VkPipelineLayout>(entry.handle), nullptr);
+        break;
+    case Kind::CommandPool:
+        vkDestroyCommandPool(device, reinterpret_cast<VkCommandPool>(entry.handle), nullptr);
+        break;
+    case Kind::Swapchain:
+        vkDestroySwapchainKHR(device, reinterpret_cast<VkSwapchainKHR>(entry.handle), nullptr);
+        break;
+    case Kind::Allocation:
+        device_->memoryAllocator.Free(entry.allocation);
+        break;
+    }
+}
+
+} // namespace gdf
@@ -0,0 +1,170 @@
+#include "Graphics/DeviceMemoryAllocator.h"
+#include <algorithm>
+
+namespace gdf
+{
+
+void DeviceMemoryAllocator::Initialize(VkDevice device,
+                                       const VkPhysicalDeviceMemoryProperties &memoryProperties,
+                                       VkDeviceSize bufferImageGranularity,
+                                       VkDeviceSize blockSize)
+{
+    device_ = device;
+    memoryProperties_ = memoryProperties;
+    separateKinds_ = bufferImageGranularity > 1;
+    blockSize_ = blockSize;
+}
+
+void DeviceMemoryAllocator::Destroy()
+{
+    std::scoped_lock<std::mutex> lock(sync_);
+    for (auto &block : blocks_) {
+        if (block.memory == VK_NULL_HANDLE)
+            continue;
+        if (block.mapped != nullptr)
+            vkUnmapMemory(device_, block.memory);
+        vkFreeMemory(device_, block.memory, nullptr);
+    }
+    blocks_.clear();
+}
+
+DeviceAllocation DeviceMemoryAllocator::Allocate(const VkMemoryRequirements &requirements,
+                                                 uint32_t memoryType,
+                                                 DeviceResourceKind kind,
+                                                 bool dedicated)
+{
+    std::scoped_lock<std::mutex> lock(sync_);
+    DeviceAllocation allocation;
+    allocation.memoryType = memoryType;
+    allocation.size = requirements.size;
+    VkDeviceSize blockSize = BlockSize(memoryType);
+    if (dedicated || requirements.size >= blockSize / 2) {
+        allocation.memory = AllocateMemory(requirements.size, memoryType, &allocation.mapped);
+        dedicatedCount_++;
+        dedicatedBytes_ += requirements.size;
+        return allocation;
+    }
+    if (!separateKinds_)
+        kind = DeviceResourceKind::Linear;
+
+    uint32_t freeSlot = UINT32_MAX;
+    for (uint32_t i = 0; i < blocks_.size(); i++) {
+        Block &block = blocks_[i];
+        if (block.memory == VK_NULL_HANDLE) {
+            freeSlot = std::min(freeSlot, i);
+            continue;
+        }
+        if (block.memoryType != memoryType || block.kind != kind)
+            continue;
+        auto range = block.ranges->Allocate(requirements.size, requirements.alignment);
+        if (range.valid()) {
+            allocation.memory = block.memory;
+            allocation.offset = range.offset;
+            allocation.mapped = block.mapped ? static_cast<char *>(block.mapped) + range.offset : nullptr;
+            allocation.block = i;
+            allocation.range = range;
+            return allocation;
+        }
+    }
+
+    if (freeSlot == UINT32_MAX) {
+        freeSlot = static_cast<uint32_t>(blocks_.size());
+        blocks_.emplace_back();
+    }
+    Block &block = blocks_[freeSlot];
+    block.memory = AllocateMemory(blockSize, memoryType, &block.mapped);
+    block.memoryType = memoryType;
+    block.kind = kind;
+    block.ranges = std::make_unique<OffsetAllocator>(blockSize);
+    auto range = block.ranges->Allocate(requirements.size, requirements.alignment);
+    assert(range.valid());
+    allocation.memory = block.memory;
+    allocation.offset = range.offset;
+    allocation.mapped = block.mapped ? static_cast<char *>(block.mapped) + range.offset : nullptr;
+    allocation.block = freeSlot;
+    allocation.range = range;
+    return allocation;
+}
+
+void DeviceMemoryAllocator::Free(DeviceAllocation &allocation)
+{
+    if (allocation.memory == VK_NULL_HANDLE)
+        return;
+    std::scoped_lock<std::mutex> lock(sync_);
+    if (allocation.block == UINT32_MAX) {
+        if (allocation.mapped != nullptr)
+            vkUnmapMemory(device_, allocation.memory);
+        vkFreeMemory(device_, allocation.memory, nullptr);
+        dedicatedCount_--;
+        dedicatedBytes_ -= allocation.size;
+    } else {
+        Block &block = blocks_[allocation.block];
+        block.ranges->Free(allocation.range);
+        if (block.ranges->empty()) {
+            // keep one empty block per memory type and kind around so alloc/free churn doesn't hit the driver
+            bool anotherEmpty = false;
+            for (uint32_t i = 0; i < blocks_.size() && !anotherEmpty; i++) {
+                Block &other = blocks_[i];
+                anotherEmpty = i != allocation.block && other.memory != VK_NULL_HANDLE &&
+                               other.memoryType == block.memoryType && other.kind == block.kind && other.ranges->empty();
+            }
+            if (anotherEmpty) {
+                if (block.mapped != nullptr)
+                    vkUnmapMemory(device_, block.memory);
+                vkFreeMemory(device_, block.memory, nullptr);
+                block = Block{};
+            }
+        }
+    }
+    allocation = DeviceAllocation{};
+}
+
+DeviceMemoryAllocator::Statistics DeviceMemoryAllocator::statistics()
+{
+    std::scoped_lock<std::mutex> lock(sync_);
+    Statistics statistics;
+    statistics.dedicatedCount = dedicatedCount_;
+    statistics.dedicatedBytes = dedicatedBytes_;
+    statistics.allocationCount = dedicatedCount_;
+    VkDeviceSize freeBytes = 0;
+    VkDeviceSize largestFreeBytes = 0;
+    for (auto &block : blocks_) {
+        if (block.memory == VK_NULL_HANDLE)
+            continue;
+        auto rangeStatistics = block.ranges->statistics();
+        statistics.blockCount++;
+        statistics.blockBytes += rangeStatistics.size;
+        statistics.usedBytes += rangeStatistics.usedSize;
+        statistics.allocationCount += rangeStatistics.allocationCount;
+        statistics.largestFreeRange = std::max(statistics.largestFreeRange, rangeStatistics.largestFreeRange);
+        freeBytes += rangeStatistics.freeSize;
+        largestFreeBytes += rangeStatistics.largestFreeRange;
+    }
+    statistics.usedBytes += dedicatedBytes_;
+    statistics.fragmentation =
+        freeBytes == 0 ? 0.0f : 1.0f - static_cast<float>(largestFreeBytes) / static_cast<float>(freeBytes);
+    return statistics;
+}
+
+VkDeviceMemory DeviceMemoryAllocator::AllocateMemory(VkDeviceSize size, uint32_t memoryType, void **mapped)
+{
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = memoryType;
+    VkDeviceMemory memory;
+    VK_ASSERT_SUCCESSED(vkAllocateMemory(device_, &allocInfo, nullptr, &memory))
+    *mapped = nullptr;
+    if (memoryProperties_.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+        VK_ASSERT_SUCCESSED(vkMapMemory(device_, memory, 0, VK_WHOLE_SIZE, 0, mapped))
+    return memory;
+}
+
+VkDeviceSize DeviceMemoryAllocator::BlockSize(uint32_t memoryType)
+{
+    // small heaps (integrated GPUs, the 256MB BAR heap) would be eaten by a few full sized blocks
+    VkDeviceSize heapSize = memoryProperties_.memoryHeaps[memoryProperties_.memoryTypes[memoryType].heapIndex].size;
+    return std::min(blockSize_, heapSize / 8);
+}
+
+} // namespace gdf
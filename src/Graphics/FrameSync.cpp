@@ -0,0 +1,146 @@
+#include "Graphics/FrameSync.h"
+#include "Graphics/Graphics.h"
+#include "Graphics/VulkanDevice.h"
+#include <algorithm>
+#include <array>
+
+namespace gdf
+{
+
+void FrameSync::Create(VulkanDevice *device, uint32_t framesInFlight)
+{
+    device_ = device;
+    framesInFlight_ = std::max(framesInFlight, 1u);
+    submittedFrame_ = 0;
+    retiredFrame_ = 0;
+
+    if (device_->enableTimelineSemaphore) {
+        fpGetSemaphoreCounterValueKHR_ = reinterpret_cast<PFN_vkGetSemaphoreCounterValueKHR>(
+            vkGetDeviceProcAddr(*device_, "vkGetSemaphoreCounterValueKHR"));
+        fpWaitSemaphoresKHR_ =
+            reinterpret_cast<PFN_vkWaitSemaphoresKHR>(vkGetDeviceProcAddr(*device_, "vkWaitSemaphoresKHR"));
+    }
+    if (fpGetSemaphoreCounterValueKHR_ != nullptr && fpWaitSemaphoresKHR_ != nullptr) {
+        VkSemaphoreTypeCreateInfoKHR semaphoreTypeCI{
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR,
+            .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR,
+            .initialValue = 0,
+        };
+        VkSemaphoreCreateInfo semaphoreCI{
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+            .pNext = &semaphoreTypeCI,
+        };
+        VK_ASSERT_SUCCESSED(vkCreateSemaphore(*device_, &semaphoreCI, nullptr, &timelineSemaphore_));
+        return;
+    }
+
+    GDF_LOG(GraphicsLog, LogLevel::Info, "VK_KHR_timeline_semaphore unavailable, frames are tracked with fences");
+    VkFenceCreateInfo fenceCI{
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+    };
+    fences_.resize(framesInFlight_);
+    fenceFrames_.assign(framesInFlight_, 0);
+    for (auto &fence : fences_)
+        VK_ASSERT_SUCCESSED(vkCreateFence(*device_, &fenceCI, nullptr, &fence));
+}
+
+void FrameSync::Destroy()
+{
+    if (timelineSemaphore_ != VK_NULL_HANDLE)
+        vkDestroySemaphore(*device_, timelineSemaphore_, nullptr);
+    timelineSemaphore_ = VK_NULL_HANDLE;
+    fpGetSemaphoreCounterValueKHR_ = nullptr;
+    fpWaitSemaphoresKHR_ = nullptr;
+    for (auto fence : fences_)
+        vkDestroyFence(*device_, fence, nullptr);
+    fences_.clear();
+    fenceFrames_.clear();
+}
+
+void FrameSync::WaitFrameSlot()
+{
+    if (nextFrame() > framesInFlight_)
+        Wait(nextFrame() - framesInFlight_);
+}
+
+void FrameSync::Submit(VkQueue queue, const VkSubmitInfo &submitInfo)
+{
+    // the slot's fence is reset below, its previous frame must be done
+    WaitFrameSlot();
+    uint64_t frame = nextFrame();
+    if (!timeline()) {
+        VkFence fence = fences_[frameSlot()];
+        VK_ASSERT_SUCCESSED(vkResetFences(*device_, 1, &fence));
+        VK_ASSERT_SUCCESSED(vkQueueSubmit(queue, 1, &submitInfo, fence));
+        fenceFrames_[frameSlot()] = frame;
+        submittedFrame_ = frame;
+        return;
+    }
+
+    if (submitInfo.signalSemaphoreCount >= kMaxSignalSemaphores)
+        THROW_EXCEPT("Too many signal semaphores in a frame submission!");
+    // values of binary semaphores are ignored, only the last one, the timeline, needs its value
+    std::array<VkSemaphore, kMaxSignalSemaphores> signalSemaphores{};
+    std::array<uint64_t, kMaxSignalSemaphores> signalValues{};
+    std::copy_n(submitInfo.pSignalSemaphores, submitInfo.signalSemaphoreCount, signalSemaphores.begin());
+    signalSemaphores[submitInfo.signalSemaphoreCount] = timelineSemaphore_;
+    signalValues[submitInfo.signalSemaphoreCount] = frame;
+    VkTimelineSemaphoreSubmitInfoKHR timelineSubmitInfo{
+        .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR,
+        .pNext = submitInfo.pNext,
+        .waitSemaphoreValueCount = 0,
+        .pWaitSemaphoreValues = nullptr,
+        .signalSemaphoreValueCount = submitInfo.signalSemaphoreCount + 1,
+        .pSignalSemaphoreValues = signalValues.data(),
+    };
+    VkSubmitInfo timelineInfo = submitInfo;
+    timelineInfo.pNext = &timelineSubmitInfo;
+    timelineInfo.signalSemaphoreCount = submitInfo.signalSemaphoreCount + 1;
+    timelineInfo.pSignalSemaphores = signalSemaphores.data();
+    VK_ASSERT_SUCCESSED(vkQueueSubmit(queue, 1, &timelineInfo, VK_NULL_HANDLE));
+    submittedFrame_ = frame;
+}
+
+bool FrameSync::IsRetired(uint64_t frame)
+{
+    if (frame <= retiredFrame_)
+        return true;
+    if (frame > submittedFrame_)
+        return false;
+    if (timeline()) {
+        uint64_t value = 0;
+        VK_ASSERT_SUCCESSED(fpGetSemaphoreCounterValueKHR_(*device_, timelineSemaphore_, &value));
+        retiredFrame_ = std::max(retiredFrame_, value);
+        return frame <= retiredFrame_;
+    }
+    // a slot is only reused once its previous frame retired, so the slot's fence belongs to frame or a newer one
+    uint32_t slot = static_cast<uint32_t>((frame - 1) % framesInFlight_);
+    if (vkGetFenceStatus(*device_, fences_[slot]) != VK_SUCCESS)
+        return false;
+    retiredFrame_ = std::max(retiredFrame_, fenceFrames_[slot]);
+    return true;
+}
+
+void FrameSync::Wait(uint64_t frame)
+{
+    if (frame <= retiredFrame_)
+        return;
+    if (frame > submittedFrame_)
+        THROW_EXCEPT("Waiting for a frame that was never submitted!");
+    if (timeline()) {
+        VkSemaphoreWaitInfoKHR waitInfo{
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR,
+            .semaphoreCount = 1,
+            .pSemaphores = &timelineSemaphore_,
+            .pValues = &frame,
+        };
+        VK_ASSERT_SUCCESSED(fpWaitSemaphoresKHR_(*device_, &waitInfo, UINT64_MAX));
+        retiredFrame_ = frame;
+        return;
+    }
+    uint32_t slot = static_cast<uint32_t>((frame - 1) % framesInFlight_);
+    VK_ASSERT_SUCCESSED(vkWaitForFences(*device_, 1, &fences_[slot], VK_TRUE, UINT64_MAX));
+    retiredFrame_ = std::max(retiredFrame_, fenceFrames_[slot]);
+}
+
+} // namespace gdf
@@ -0,0 +1,233 @@
+#include "Graphics/GpuProfiler.h"
+#include "Graphics/Graphics.h"
+#include "Graphics/VulkanDevice.h"
+#include "imgui.h"
+#include <algorithm>
+
+namespace gdf
+{
+
+void GpuProfiler::Create(VulkanDevice *device, uint32_t queueFamilyIndex, uint32_t frameCount)
+{
+    device_ = device;
+    uint32_t validBits = device_->queueFamilyProperties[queueFamilyIndex].timestampValidBits;
+    if (validBits == 0 || device_->properties.limits.timestampPeriod == 0.0f) {
+        GDF_LOG(GraphicsLog,
+                LogLevel::Warning,
+                "Queue family {} has no timestamp support, GPU profiler disabled",
+                queueFamilyIndex);
+        return;
+    }
+    timestampMask_ = validBits >= 64 ? UINT64_MAX : (uint64_t{1} << validBits) - 1;
+    nanosecondsPerTick_ = device_->properties.limits.timestampPeriod;
+
+    VkQueryPoolCreateInfo queryPoolCI{
+        .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .queryType = VK_QUERY_TYPE_TIMESTAMP,
+        .queryCount = kMaxScopes * 2,
+    };
+    frames_.resize(frameCount);
+    for (auto &frame : frames_) {
+        VK_ASSERT_SUCCESSED(vkCreateQueryPool(*device_, &queryPoolCI, nullptr, &frame.queryPool));
+        frame.scopes.reserve(kMaxScopes);
+    }
+    results_.resize(kMaxScopes * 2);
+}
+
+void GpuProfiler::Destroy()
+{
+    for (auto &frame : frames_)
+        vkDestroyQueryPool(*device_, frame.queryPool, nullptr);
+    frames_.clear();
+    open_.clear();
+    timeline_.clear();
+    history_.clear();
+}
+
+void GpuProfiler::Resolve(uint32_t frameSlot)
+{
+    if (!enabled())
+        return;
+    Frame &frame = frames_[frameSlot];
+    if (!frame.recorded)
+        return;
+    frame.recorded = false;
+    if (frame.scopes.empty())
+        return;
+
+    uint32_t queryCount = static_cast<uint32_t>(frame.scopes.size()) * 2;
+    // no WAIT bit, the fence has signalled so the results are there and a NOT_READY means a scope was never submitted
+    VkResult result = vkGetQueryPoolResults(*device_,
+                                            frame.queryPool,
+                                            0,
+                                            queryCount,
+                                            queryCount * sizeof(uint64_t),
+                                            results_.data(),
+                                            sizeof(uint64_t),
+                                            VK_QUERY_RESULT_64_BIT);
+    if (result != VK_SUCCESS)
+        return;
+
+    uint64_t frameBegin = UINT64_MAX;
+    uint64_t frameEnd = 0;
+    for (uint32_t i = 0; i < queryCount; i++) {
+        results_[i] &= timestampMask_;
+        frameBegin = std::min(frameBegin, results_[i]);
+        frameEnd = std::max(frameEnd, results_[i]);
+    }
+    auto toMs = [this](uint64_t ticks) { return static_cast<double>(ticks) * nanosecondsPerTick_ * 1e-6; };
+
+    timeline_.clear();
+    frameMs_ = toMs(frameEnd - frameBegin);
+    for (const auto &scope : frame.scopes) {
+        uint64_t begin = results_[scope.query];
+        uint64_t end = std::max(results_[scope.query + 1], begin);
+        TimelineEntry entry{
+            .name = scope.name,
+            .depth = scope.depth,
+            .beginMs = toMs(begin - frameBegin),
+            .durationMs = toMs(end - begin),
+        };
+        timeline_.push_back(entry);
+
+        History &history = history_[scope.name];
+        history.samples[history.next] = entry.durationMs;
+        history.next = (history.next + 1) % kHistorySize;
+        history.count = std::min(history.count + 1, kHistorySize);
+        history.lastMs = entry.durationMs;
+    }
+}
+
+void GpuProfiler::BeginFrame(uint32_t frameSlot, VkCommandBuffer commandBuffer)
+{
+    if (!enabled())
+        return;
+    Resolve(frameSlot);
+    current_ = frameSlot;
+    Frame &frame = frames_[current_];
+    frame.scopes.clear();
+    frame.recorded = true;
+    open_.clear();
+    vkCmdResetQueryPool(commandBuffer, frame.queryPool, 0, kMaxScopes * 2);
+}
+
+void GpuProfiler::BeginScope(VkCommandBuffer commandBuffer, const char *name)
+{
+    if (!enabled())
+        return;
+    Frame &frame = frames_[current_];
+    if (frame.scopes.size() == kMaxScopes) {
+        // keep EndScope balanced, the scope just isn't measured
+        open_.push_back(UINT32_MAX);
+        return;
+    }
+    RecordedScope scope{
+        .name = name,
+        .depth = static_cast<uint32_t>(open_.size()),
+        .query = static_cast<uint32_t>(frame.scopes.size()) * 2,
+    };
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.queryPool, scope.query);
+    open_.push_back(static_cast<uint32_t>(frame.scopes.size()));
+    frame.scopes.push_back(scope);
+}
+
+void GpuProfiler::EndScope(VkCommandBuffer commandBuffer)
+{
+    if (!enabled() || open_.empty())
+        return;
+    uint32_t index = open_.back();
+    open_.pop_back();
+    if (index == UINT32_MAX)
+        return;
+    Frame &frame = frames_[current_];
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame.queryPool, frame.scopes[index].query + 1);
+}
+
+std::vector<GpuProfiler::ScopeStatistics> GpuProfiler::statistics() const
+{
+    std::vector<ScopeStatistics> statistics;
+    statistics.reserve(history_.size());
+    std::vector<double> sorted;
+    for (const auto &[name, history] : history_) {
+        if (history.count == 0)
+            continue;
+        sorted.assign(history.samples.begin(), history.samples.begin() + history.count);
+        std::sort(sorted.begin(), sorted.end());
+        auto percentile = [&sorted](double p) {
+            return sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * static_cast<double>(sorted.size())))];
+        };
+        ScopeStatistics scope;
+        scope.name = name;
+        scope.sampleCount = history.count;
+        scope.lastMs = history.lastMs;
+        for (double sample : sorted)
+            scope.averageMs += sample;
+        scope.averageMs /= static_cast<double>(sorted.size());
+        scope.p50Ms = percentile(0.50);
+        scope.p95Ms = percentile(0.95);
+        scope.p99Ms = percentile(0.99);
+        statistics.push_back(std::move(scope));
+    }
+    std::sort(statistics.begin(), statistics.end(), [](const auto &a, const auto &b) { return a.name < b.name; });
+    return statistics;
+}
+
+void GpuProfiler::DrawImGui()
+{
+    if (!ImGui::Begin("GPU Profiler")) {
+        ImGui::End();
+        return;
+    }
+    if (!enabled()) {
+        ImGui::TextUnformatted("Timestamps are not supported on this queue");
+        ImGui::End();
+        return;
+    }
+
+    ImGui::Text("Frame %.3f ms", frameMs_);
+    // one bar per scope, nested scopes one row further down
+    const float rowHeight = ImGui::GetTextLineHeightWithSpacing();
+    const float width = std::max(ImGui::GetContentRegionAvail().x, 1.0f);
+    uint32_t rows = 1;
+    for (const auto &entry : timeline_)
+        rows = std::max(rows, entry.depth + 1);
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImDrawList *drawList = ImGui::GetWindowDrawList();
+    double scale = frameMs_ > 0.0 ? width / frameMs_ : 0.0;
+    for (size_t i = 0; i < timeline_.size(); i++) {
+        const auto &entry = timeline_[i];
+        ImVec2 min{origin.x + static_cast<float>(entry.beginMs * scale), origin.y + rowHeight * entry.depth};
+        ImVec2 max{std::max(min.x + 1.0f, min.x + static_cast<float>(entry.durationMs * scale)), min.y + rowHeight - 1.0f};
+        ImU32 color = ImColor::HSV(static_cast<float>(i % 8) / 8.0f, 0.6f, 0.8f);
+        drawList->AddRectFilled(min, max, color);
+        drawList->PushClipRect(min, max, true);
+        drawList->AddText(ImVec2{min.x + 2.0f, min.y}, IM_COL32_WHITE, entry.name);
+        drawList->PopClipRect();
+        if (ImGui::IsMouseHoveringRect(min, max))
+            ImGui::SetTooltip("%s\n%.3f ms", entry.name, entry.durationMs);
+    }
+    ImGui::Dummy(ImVec2{width, rowHeight * rows});
+
+    if (ImGui::BeginTable("GpuProfilerScopes", 6, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders)) {
+        ImGui::TableSetupColumn("Scope");
+        ImGui::TableSetupColumn("Last");
+        ImGui::TableSetupColumn("Avg");
+        ImGui::TableSetupColumn("P50");
+        ImGui::TableSetupColumn("P95");
+        ImGui::TableSetupColumn("P99");
+        ImGui::TableHeadersRow();
+        for (const auto &scope : statistics()) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(scope.name.c_str());
+            for (double value : {scope.lastMs, scope.averageMs, scope.p50Ms, scope.p95Ms, scope.p99Ms}) {
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", value);
+            }
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
+
+} // namespace gdf
@@ -1,5 +1,6 @@
 #include "Graphics/Graphics.h"
 #include "Base/File.h"
+#include "DeveloperTool/CpuProfiler.h"
 #include "Git.h"
 #include "ImGui/DockSpace.h"
 #include "imgui.h"
@@ -8,6 +9,8 @@
 #include <algorithm>
 #include <array>
 #include <cstdio>
+#include <cstring>
+#include <filesystem>
 #include <iterator>
 #include <vulkan/vulkan_core.h>
 
@@ -22,10 +25,16 @@ namespace gdf
 
 GDF_DEFINE_EXPORT_LOG_CATEGORY(GraphicsLog);
 
-void Graphics::Initialize(Window *pWindow, bool enableValidationLayer)
+std::atomic<uint32_t> Graphics::validationErrorCount_{0};
+
+void Graphics::Initialize(Window *pWindow, bool enableValidationLayer, VkExtent2D headlessExtent)
 {
     pWindow_ = pWindow;
     enableValidationLayer_ = enableValidationLayer;
+    swapchainExtent_ = headlessExtent;
+    framesInFlight_ = std::max(framesInFlight_, 1u);
+    currentFrame_ = 0;
+    frameArenas_ = std::make_unique<LinearArena[]>(framesInFlight_);
     CreateInstance();
     // Setup DebugReportCallback
     if (enableValidationLayer_)
@@ -33,50 +42,174 @@ void Graphics::Initialize(Window *pWindow, bool enableValidationLayer)
     if (pWindow)
         pWindow_->GetVkSurfaceKHR(instance_, &surfaceKHR_);
     CreateDevice({}, {});
-    CreateCommandPool();
-    CreateSwapchain();
+    CreatePipelineCache();
+    CreateFrameCommandPools();
+    CreateStagingRing();
+    CreateGpuProfiler();
+    if (headless())
+        CreateOffscreenTargets();
+    else
+        CreateSwapchain();
     CreateDepthResources();
     CreateRenderPass();
     CreateGraphicsPipeline();
     CreateFramebuffers();
-    CreateCommandBuffers();
     CreateSyncObjects();
+    deletionQueue_.Create(&device_, &frameSync_);
 
-    ImGuiCreate();
+    // ImGui needs the GLFW window for its input and platform backend
+    if (!headless())
+        ImGuiCreate();
 }
 
 void Graphics::FrameBegin()
 {
-    ImGuiFrameBegin();
+    GDF_PROFILE_FUNCTION();
+    {
+        GDF_PROFILE_ZONE("Wait Frame Slot");
+        // the frame slot is free again once its previous frame retires, DrawFrame's own wait then returns at once
+        frameSync_.WaitFrameSlot();
+    }
+    frameArenas_[currentFrame_].Reset();
+    // the slot's timings are final now, resolve them before the profiler panel is drawn
+    gpuProfiler_.Resolve(currentFrame_);
+    if (!headless())
+        ImGuiFrameBegin();
 }
 
 void Graphics::DrawFrame()
 {
+    GDF_PROFILE_FUNCTION();
     if (RequireRecreateSwapchain_)
         RecreateSwapchain();
-    vkWaitForFences(device_, 1, &inFlightFences_[currentFrame_], VK_TRUE, UINT64_MAX);
-    uint32_t imageIndex;
-    VkResult result = vkAcquireNextImageKHR(
-        device_, swapchainKHR_, UINT64_MAX, imageAvailableSemaphores_[currentFrame_], VK_NULL_HANDLE, &imageIndex);
-    if (result == VK_ERROR_OUT_OF_DATE_KHR) {
-        GDF_LOG(GraphicsLog, LogLevel::Warning, "vkAcquireNextImageKHR -> VK_ERROR_OUT_OF_DATE_KHR");
-        RecreateSwapchain();
+    frameSync_.WaitFrameSlot();
+    deletionQueue_.Collect();
+    ResetFrameCommandPool();
+    // headless, the offscreen image of a frame slot is free once the slot's previous frame has retired
+    uint32_t imageIndex = currentFrame_;
+    VkResult result = VK_SUCCESS;
+    if (!headless()) {
+        GDF_PROFILE_ZONE("vkAcquireNextImageKHR");
+        result = vkAcquireNextImageKHR(
+            device_, swapchainKHR_, UINT64_MAX, imageAvailableSemaphores_[currentFrame_], VK_NULL_HANDLE, &imageIndex);
+        if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+            GDF_LOG(GraphicsLog, LogLevel::Warning, "vkAcquireNextImageKHR -> VK_ERROR_OUT_OF_DATE_KHR");
+            RecreateSwapchain();
+            return;
+        } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+            THROW_EXCEPT("Failed to acquire swap chain image!");
+        }
+    }
+
+    // an image may come back before the frame slot that last drew it has been waited for
+    frameSync_.Wait(imagesInFlight_[imageIndex]);
+    imagesInFlight_[imageIndex] = frameSync_.nextFrame();
+
+    VkCommandBuffer commandBuffer = AllocateFrameCommandBuffer();
+    VkCommandBufferBeginInfo beginInfo{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    };
+    VK_ASSERT_SUCCESSED(vkBeginCommandBuffer(commandBuffer, &beginInfo))
+    // uploads that finished on the transfer queue become usable from this frame on
+    uploadRing_.RecordAcquires(commandBuffer);
+    gpuProfiler_.BeginFrame(currentFrame_, commandBuffer);
+    gpuProfiler_.BeginScope(commandBuffer, "Main Pass");
+    RecordMainPass(commandBuffer, imageIndex);
+    gpuProfiler_.EndScope(commandBuffer);
+
+    if (headless()) {
+        if (readbackEnabled_) {
+            VkBufferImageCopy copy{
+                .bufferOffset = 0,
+                .bufferRowLength = 0,
+                .bufferImageHeight = 0,
+                .imageSubresource =
+                    {
+                        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                        .mipLevel = 0,
+                        .baseArrayLayer = 0,
+                        .layerCount = 1,
+                    },
+                .imageOffset = {0, 0, 0},
+                .imageExtent = {swapchainExtent_.width, swapchainExtent_.height, 1},
+            };
+            // the render pass leaves the image in TRANSFER_SRC_OPTIMAL when headless
+            vkCmdCopyImageToBuffer(commandBuffer,
+                                   swapchainImages_[imageIndex],
+                                   VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                   readbackBuffers_[imageIndex],
+                                   1,
+                                   &copy);
+            VkBufferMemoryBarrier barrier{
+                .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+                .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .buffer = readbackBuffers_[imageIndex],
+                .offset = 0,
+                .size = VK_WHOLE_SIZE,
+            };
+            vkCmdPipelineBarrier(commandBuffer,
+                                 VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                 VK_PIPELINE_STAGE_HOST_BIT,
+                                 0,
+                                 0,
+                                 nullptr,
+                                 1,
+                                 &barrier,
+                                 0,
+                                 nullptr);
+            readbackImageIndex_ = imageIndex;
+            readbackFrame_ = frameSync_.nextFrame();
+        }
+        VK_ASSERT_SUCCESSED(vkEndCommandBuffer(commandBuffer));
+        GDF_PROFILE_ZONE("vkQueueSubmit");
+        auto submitInfo = GraphicsTools::MakeSubmitInfo(0, nullptr, nullptr, 1, &commandBuffer, 0, nullptr);
+        frameSync_.Submit(device_.graphicsQueue_, submitInfo);
+        currentFrame_ = frameSync_.frameSlot();
         return;
-    } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
-        THROW_EXCEPT("Failed to acquire swap chain image!");
     }
 
-    if (imagesInFlight_[imageIndex] != VK_NULL_HANDLE) {
-        vkWaitForFences(device_, 1, &imagesInFlight_[imageIndex], VK_TRUE, UINT64_MAX);
+    VK_ASSERT_SUCCESSED(vkEndCommandBuffer(commandBuffer));
+
+    // the merged ImGui subpass was recorded with the scene, otherwise ImGui gets its own pass and command buffer
+    VkCommandBuffer commandBuffers[] = {commandBuffer, VK_NULL_HANDLE};
+    uint32_t commandBufferCount = 1;
+    if (!imguiSubpass()) {
+        commandBuffers[commandBufferCount] = AllocateFrameCommandBuffer();
+        ImGuiFrameRender(commandBuffers[commandBufferCount++], imageIndex);
+    }
+    VkSemaphore waitSemaphores[] = {imageAvailableSemaphores_[currentFrame_]};
+    VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
+    VkSemaphore signalSemaphores[] = {renderFinishedSemaphores_[currentFrame_]};
+    auto submitInfo = GraphicsTools::MakeSubmitInfo(
+        1, waitSemaphores, waitStages, commandBufferCount, commandBuffers, 1, signalSemaphores);
+    {
+        GDF_PROFILE_ZONE("vkQueueSubmit");
+        frameSync_.Submit(device_.graphicsQueue_, submitInfo);
     }
-    imagesInFlight_[imageIndex] = inFlightFences_[currentFrame_];
-    vkResetFences(device_, 1, &inFlightFences_[currentFrame_]);
 
-    // VK_ASSERT_SUCCESSED(vkResetCommandPool(device_, commandPool_, 0));
-    VkCommandBufferBeginInfo beginInfo{};
-    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    VK_ASSERT_SUCCESSED(vkBeginCommandBuffer(commandBuffers_[imageIndex], &beginInfo))
+    auto presentInfoKHR = GraphicsTools::MakePresentInfoKHR(1, signalSemaphores, &swapchainKHR_, &imageIndex);
+
+    {
+        GDF_PROFILE_ZONE("vkQueuePresentKHR");
+        result = vkQueuePresentKHR(device_.presentQueue_, &presentInfoKHR);
+    }
+    // the frame is submitted either way, the next one uses the next slot
+    currentFrame_ = frameSync_.frameSlot();
+    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
+        GDF_LOG(GraphicsLog, LogLevel::Warning, "vkQueuePresentKHR -> {}", GraphicsTools::VkResultString(result));
+        RecreateSwapchain();
+    } else if (result != VK_SUCCESS) {
+        THROW_EXCEPT("Failed to present swap chain image!");
+    }
+}
 
+void Graphics::RecordMainPass(VkCommandBuffer commandBuffer, uint32_t imageIndex)
+{
+    GDF_PROFILE_FUNCTION();
     VkRenderPassBeginInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
     renderPassInfo.renderPass = renderPass_;
@@ -91,55 +224,105 @@ void Graphics::DrawFrame()
     renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
     renderPassInfo.pClearValues = clearValues.data();
 
-    vkCmdBeginRenderPass(commandBuffers_[imageIndex], &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-
-    vkCmdBindPipeline(commandBuffers_[imageIndex], VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline_);
-
-    vkCmdDraw(commandBuffers_[imageIndex], 3, 1, 0, 0);
-
-    vkCmdEndRenderPass(commandBuffers_[imageIndex]);
+    if (parallelRecorder_.threadCount() == 0) {
+        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+        RecordSceneDraws(commandBuffer, 0, sceneDrawCount_);
+    } else {
+        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+        VkCommandBufferInheritanceInfo inheritance{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+            .renderPass = renderPass_,
+            .subpass = 0,
+            .framebuffer = swapchainFramebuffers_[imageIndex],
+        };
+        auto secondaries = parallelRecorder_.Record(
+            currentFrame_, inheritance, sceneDrawCount_, [this](VkCommandBuffer commandBuffer, uint32_t first, uint32_t last) {
+                RecordSceneDraws(commandBuffer, first, last);
+            });
+        vkCmdExecuteCommands(commandBuffer, static_cast<uint32_t>(secondaries.size()), secondaries.data());
+    }
 
-    VK_ASSERT_SUCCESSED(vkEndCommandBuffer(commandBuffers_[imageIndex]));
+    if (imguiSubpass()) {
+        vkCmdNextSubpass(commandBuffer, VK_SUBPASS_CONTENTS_INLINE);
+        gpuProfiler_.BeginScope(commandBuffer, "ImGui Subpass");
+        ImGui_ImplVulkan_RenderDrawData(imGuiDrawData_, commandBuffer);
+        gpuProfiler_.EndScope(commandBuffer);
+    }
+    vkCmdEndRenderPass(commandBuffer);
+}
 
-    ImGuiFrameRender(imageIndex);
-    VkCommandBuffer commandBuffers[] = {commandBuffers_[imageIndex], imguiCommandBuffers_[imageIndex]};
-    VkSemaphore waitSemaphores[] = {imageAvailableSemaphores_[currentFrame_]};
-    VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-    VkSemaphore signalSemaphores[] = {renderFinishedSemaphores_[currentFrame_]};
-    auto submitInfo = GraphicsTools::MakeSubmitInfo(1, waitSemaphores, waitStages, 2, commandBuffers, 1, signalSemaphores);
-    VK_ASSERT_SUCCESSED(vkQueueSubmit(device_.graphicsQueue_, 1, &submitInfo, inFlightFences_[currentFrame_]))
+void Graphics::RecordSceneDraws(VkCommandBuffer commandBuffer, uint32_t first, uint32_t last)
+{
+    // secondaries inherit no state, every range binds its own
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline_);
+    VkViewport viewport{
+        .x = 0.0f,
+        .y = 0.0f,
+        .width = float(swapchainExtent_.width),
+        .height = float(swapchainExtent_.height),
+        .minDepth = 0.0f,
+        .maxDepth = 1.0f,
+    };
+    VkRect2D scissor{
+        .offset = {0, 0},
+        .extent = swapchainExtent_,
+    };
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-    auto presentInfoKHR = GraphicsTools::MakePresentInfoKHR(1, signalSemaphores, &swapchainKHR_, &imageIndex);
+    for (uint32_t i = first; i < last; i++)
+        vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+}
 
-    result = vkQueuePresentKHR(device_.presentQueue_, &presentInfoKHR);
-    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
-        GDF_LOG(GraphicsLog, LogLevel::Warning, "vkQueuePresentKHR -> {}", GraphicsTools::VkResultString(result));
-        RecreateSwapchain();
+void Graphics::SetRecordingThreads(uint32_t threadCount)
+{
+    if (threadCount == parallelRecorder_.threadCount())
         return;
-    } else if (result != VK_SUCCESS) {
-        THROW_EXCEPT("Failed to present swap chain image!");
-    }
-    currentFrame_ = (currentFrame_ + 1) % MAX_FRAMES_IN_FLIGHT;
+    // the pools of frames still in flight go away with the old recorder
+    frameSync_.Wait(frameSync_.submittedFrame());
+    parallelRecorder_.Destroy();
+    if (threadCount > 0)
+        parallelRecorder_.Create(&device_, device_.queueFamilyIndices.graphics, framesInFlight_, threadCount);
 }
 
 void Graphics::FrameEnd()
 {
-    ImGuiFrameEnd();
+    if (!headless())
+        ImGuiFrameEnd();
+}
+
+bool Graphics::ReadFrame(std::vector<uint8_t> &pixels)
+{
+    if (!headless() || readbackImageIndex_ == UINT32_MAX)
+        return false;
+    frameSync_.Wait(readbackFrame_);
+    const DeviceAllocation &allocation = readbackAllocations_[readbackImageIndex_];
+    pixels.resize(static_cast<size_t>(swapchainExtent_.width) * swapchainExtent_.height * 4);
+    std::memcpy(pixels.data(), allocation.mapped, pixels.size());
+    return true;
 }
 
 void Graphics::Cleanup()
 {
     DeviceWaitIdle();
-    ImGuiDestroy();
+    if (!headless())
+        ImGuiDestroy();
 
     DestroySyncObjects();
-    FreeCommandBuffers();
     DestroyFramebuffers();
     DestroyGraphicsPipeline();
     DestroyRenderPass();
+    deletionQueue_.Destroy();
     DestroyDepthResources();
-    DestroySwapchain();
-    DestroyCommandPool();
+    if (headless())
+        DestroyOffscreenTargets();
+    else
+        DestroySwapchain();
+    parallelRecorder_.Destroy();
+    DestroyGpuProfiler();
+    DestroyStagingRing();
+    DestroyFrameCommandPools();
+    DestroyPipelineCache();
     DestroyDevice();
     if (surfaceKHR_ != VK_NULL_HANDLE)
         vkDestroySurfaceKHR(instance_, surfaceKHR_, nullptr);
@@ -158,8 +341,21 @@ void Graphics::CreateInstance()
         enableGetPhysicalDeviceProperty2Extension_ = true;
     }
 #endif
-    if (!Window::GetRequiredInstanceExtensions(instanceExtensions_))
+    if (!headless() && !Window::GetRequiredInstanceExtensions(instanceExtensions_))
         THROW_EXCEPT("Required window instance extensions faild!");
+    // VK_KHR_timeline_semaphore builds on it, FrameSync falls back to fences without it
+    uint32_t extensionCount = 0;
+    vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
+    std::vector<VkExtensionProperties> extensions(extensionCount);
+    vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, extensions.data());
+    auto isProperties2 = [](const char *extensionName) {
+        return !strcmp(extensionName, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+    };
+    if (std::none_of(instanceExtensions_.begin(), instanceExtensions_.end(), isProperties2) &&
+        std::any_of(extensions.begin(), extensions.end(), [&](const VkExtensionProperties &extension) {
+            return isProperties2(extension.extensionName);
+        }))
+        instanceExtensions_.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
     // Instance
     if (enableValidationLayer_) {
         instanceExtensions_.push_back(VK_EXT_DEBUG_REPORT_EXTENSION_NAME);
@@ -217,14 +413,94 @@ void Graphics::CreateDevice(VkPhysicalDeviceFeatures enabledFeatures,
     device_.CreateLogicalDevice(enabledFeatures, surfaceKHR_, enabledExtensions, instanceExtensions_);
 }
 
-void Graphics::CreateCommandPool()
+void Graphics::CreatePipelineCache()
+{
+    // a cache from another driver or device is rejected by the header check and we start empty
+    std::vector<char> cacheData;
+    std::string path = PipelineCachePath();
+    std::error_code error;
+    if (std::filesystem::exists(path, error)) {
+        cacheData = File::ReadBytes(path);
+        struct {
+            uint32_t headerSize;
+            uint32_t headerVersion;
+            uint32_t vendorID;
+            uint32_t deviceID;
+            uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+        } header;
+        bool valid = cacheData.size() >= sizeof(header);
+        if (valid) {
+            std::memcpy(&header, cacheData.data(), sizeof(header));
+            valid = header.headerSize >= sizeof(header) && header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+                    header.vendorID == device_.properties.vendorID && header.deviceID == device_.properties.deviceID &&
+                    std::memcmp(header.pipelineCacheUUID, device_.properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+        }
+        if (!valid) {
+            GDF_LOG(GraphicsLog, LogLevel::Info, "Ignoring pipeline cache {} built for another device", path);
+            cacheData.clear();
+        }
+    }
+    VkPipelineCacheCreateInfo pipelineCacheCI{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .initialDataSize = cacheData.size(),
+        .pInitialData = cacheData.data(),
+    };
+    VK_ASSERT_SUCCESSED(vkCreatePipelineCache(device_, &pipelineCacheCI, nullptr, &pipelineCache_))
+}
+
+void Graphics::CreateFrameCommandPools()
 {
+    // buffers are never reset one by one, the whole pool of a frame slot is
     VkCommandPoolCreateInfo poolInfo{
         .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
-        .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+        .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
         .queueFamilyIndex = device_.queueFamilyIndices.graphics,
     };
-    VK_ASSERT_SUCCESSED(vkCreateCommandPool(device_, &poolInfo, nullptr, &commandPool_))
+    frameCommandPools_.resize(framesInFlight_);
+    for (auto &frameCommandPool : frameCommandPools_)
+        VK_ASSERT_SUCCESSED(vkCreateCommandPool(device_, &poolInfo, nullptr, &frameCommandPool.commandPool))
+}
+
+void Graphics::ResetFrameCommandPool()
+{
+    FrameCommandPool &frameCommandPool = frameCommandPools_[currentFrame_];
+    VK_ASSERT_SUCCESSED(vkResetCommandPool(device_, frameCommandPool.commandPool, 0))
+    frameCommandPool.usedCount = 0;
+}
+
+VkCommandBuffer Graphics::AllocateFrameCommandBuffer()
+{
+    FrameCommandPool &frameCommandPool = frameCommandPools_[currentFrame_];
+    if (frameCommandPool.usedCount == frameCommandPool.commandBuffers.size()) {
+        VkCommandBufferAllocateInfo CommandBufferAI{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .commandPool = frameCommandPool.commandPool,
+            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1,
+        };
+        VkCommandBuffer commandBuffer;
+        VK_ASSERT_SUCCESSED(vkAllocateCommandBuffers(device_, &CommandBufferAI, &commandBuffer))
+        frameCommandPool.commandBuffers.push_back(commandBuffer);
+    }
+    return frameCommandPool.commandBuffers[frameCommandPool.usedCount++];
+}
+
+void Graphics::CreateStagingRing()
+{
+    auto &indices = device_.queueFamilyIndices;
+    stagingRing_.Create(&device_, device_.graphicsQueue_, indices.graphics);
+    if (indices.transfer != indices.graphics && device_.transferQueue_ != VK_NULL_HANDLE) {
+        uploadRing_.Create(&device_, device_.transferQueue_, indices.transfer, indices.graphics);
+    } else {
+        GDF_LOG(GraphicsLog, LogLevel::Info, "No dedicated transfer queue family, streaming uploads use the graphics queue");
+        uploadRing_.Create(&device_, device_.graphicsQueue_, indices.graphics);
+    }
+}
+
+void Graphics::CreateGpuProfiler()
+{
+    // every profiled pass is submitted to the graphics queue
+    gpuProfiler_.Create(&device_, device_.queueFamilyIndices.graphics, framesInFlight_);
 }
 
 void Graphics::CreateSwapchain()
@@ -294,11 +570,8 @@ void Graphics::CreateSwapchain()
         swapchainCI.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
     }
 
+    // the old swapchain is retired by RecreateSwapchain and destroyed once its frames are done
     VK_ASSERT_SUCCESSED(vkCreateSwapchainKHR(device_, &swapchainCI, nullptr, &swapchainKHR_));
-    if (oldSwapchainKHR != VK_NULL_HANDLE) {
-        DestroySwapchainImageViews();
-        vkDestroySwapchainKHR(device_, oldSwapchainKHR, nullptr);
-    }
     swapchainImageFormat_ = surfaceFormat.format;
     swapchainExtent_ = extent;
     vkGetSwapchainImagesKHR(device_, swapchainKHR_, &swapchainImageCount_, nullptr);
@@ -316,6 +589,42 @@ void Graphics::CreateSwapchainImageViews()
     }
 }
 
+void Graphics::CreateOffscreenTargets()
+{
+    swapchainImageFormat_ = VK_FORMAT_R8G8B8A8_UNORM;
+    swapchainImageCount_ = framesInFlight_;
+    swapchainMinImageCount_ = framesInFlight_;
+    swapchainImages_.resize(swapchainImageCount_);
+    offscreenImageAllocations_.resize(swapchainImageCount_);
+    readbackBuffers_.resize(swapchainImageCount_);
+    readbackAllocations_.resize(swapchainImageCount_);
+    VkDeviceSize readbackSize = static_cast<VkDeviceSize>(swapchainExtent_.width) * swapchainExtent_.height * 4;
+    for (uint32_t i = 0; i < swapchainImageCount_; i++) {
+        device_.CreateImage(swapchainExtent_.width,
+                            swapchainExtent_.height,
+                            swapchainImageFormat_,
+                            VK_IMAGE_TILING_OPTIMAL,
+                            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                            swapchainImages_[i],
+                            offscreenImageAllocations_[i]);
+
+        auto bufferCI =
+            GraphicsTools::MakeBufferCreateInfo(readbackSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_SHARING_MODE_EXCLUSIVE);
+        VK_ASSERT_SUCCESSED(vkCreateBuffer(device_, &bufferCI, nullptr, &readbackBuffers_[i]));
+        VkMemoryRequirements memoryReqs;
+        vkGetBufferMemoryRequirements(device_, readbackBuffers_[i], &memoryReqs);
+        readbackAllocations_[i] = device_.memoryAllocator.Allocate(
+            memoryReqs,
+            device_.FindMemoryType(memoryReqs.memoryTypeBits,
+                                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT),
+            DeviceResourceKind::Linear);
+        VK_ASSERT_SUCCESSED(vkBindBufferMemory(
+            device_, readbackBuffers_[i], readbackAllocations_[i].memory, readbackAllocations_[i].offset));
+    }
+    CreateSwapchainImageViews();
+}
+
 void Graphics::CreateDepthResources()
 {
     VkFormat depthFormat = device_.FindDepthFormat();
@@ -327,7 +636,7 @@ void Graphics::CreateDepthResources()
                         VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
                         depthImage_,
-                        depthImageMemory_);
+                        depthImageAllocation_);
     depthImageView_ = device_.CreateImageView(depthImage_, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT);
 }
 
@@ -341,7 +650,10 @@ void Graphics::CreateRenderPass()
         .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
         .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
         .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-        .finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+        // headless frames are copied out for readback, windowed ones are presented or continue in the ImGui pass
+        .finalLayout = headless()         ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+                       : imguiSubpass() ? VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
+                                        : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
     };
 
     VkAttachmentDescription depthAttachment{};
@@ -358,6 +670,8 @@ void Graphics::CreateRenderPass()
     auto depthAttachmentRef = GraphicsTools::MakeAttachmentReference(1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
 
     auto subpass = GraphicsTools::MakeSubpassDescription(1, &colorAttachmentRef, &depthAttachmentRef);
+    // the ImGui subpass only blends over the color the scene left in the tile, depth is not needed any more
+    auto imguiSubpassDesc = GraphicsTools::MakeSubpassDescription(1, &colorAttachmentRef, nullptr);
     auto dependency = GraphicsTools::MakeSubpassDependency(
         VK_SUBPASS_EXTERNAL,
         0,
@@ -366,17 +680,32 @@ void Graphics::CreateRenderPass()
         0,
         VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
     std::array<VkAttachmentDescription, 2> attachments = {colorAttachment, depthAttachment};
-    std::array<VkSubpassDescription, 1> subpasses = {subpass};
-    std::array<VkSubpassDependency, 1> dependencies = {dependency};
+    std::array<VkSubpassDescription, 2> subpasses = {subpass, imguiSubpassDesc};
+    auto readbackDependency = GraphicsTools::MakeSubpassDependency(0,
+                                                                   VK_SUBPASS_EXTERNAL,
+                                                                   VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                                                   VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                                                   VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                                                                   VK_ACCESS_TRANSFER_READ_BIT);
+    auto imguiDependency = GraphicsTools::MakeSubpassDependency(0,
+                                                                1,
+                                                                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                                                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                                                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                                                                VK_ACCESS_COLOR_ATTACHMENT_READ_BIT |
+                                                                    VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                                                                VK_DEPENDENCY_BY_REGION_BIT);
+    // headless adds the readback dependency, the merged ImGui pass its subpass
+    std::array<VkSubpassDependency, 2> dependencies = {dependency, headless() ? readbackDependency : imguiDependency};
     VkRenderPassCreateInfo renderPassCI{
         .sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
         .pNext = nullptr,
         .flags = 0,
         .attachmentCount = static_cast<uint32_t>(attachments.size()),
         .pAttachments = attachments.data(),
-        .subpassCount = static_cast<uint32_t>(subpasses.size()),
+        .subpassCount = imguiSubpass() ? 2u : 1u,
         .pSubpasses = subpasses.data(),
-        .dependencyCount = static_cast<uint32_t>(dependencies.size()),
+        .dependencyCount = headless() || imguiSubpass() ? 2u : 1u,
         .pDependencies = dependencies.data(),
     };
     VK_ASSERT_SUCCESSED(vkCreateRenderPass(device_, &renderPassCI, nullptr, &renderPass_));
@@ -395,26 +724,17 @@ void Graphics::CreateGraphicsPipeline()
     auto vertexInputStateCI = GraphicsTools::MakePipelineVertexInputStateCreateInfo();
     auto inputAssemblyStateCI = GraphicsTools::MakePipelineInputAssemblyStateCreateInfo();
     auto tessellationStateCI = GraphicsTools::MakePipelineTessellationStateCreateInfo();
-    VkViewport viewport{
-        .x = 0.0f,
-        .y = 0.0f,
-        .width = float(swapchainExtent_.width),
-        .height = float(swapchainExtent_.height),
-        .minDepth = 0.0f,
-        .maxDepth = 1.0f,
-    };
-    VkRect2D scissor{
-        .offset = {0, 0},
-        .extent = swapchainExtent_,
-    };
-    auto viewportStateCI = GraphicsTools::MakePipelineViewportStateCreateInfo(1, &viewport, 1, &scissor);
+    // viewport and scissor are set per frame so a resize doesn't need a new pipeline
+    auto viewportStateCI = GraphicsTools::MakePipelineViewportStateCreateInfo(1, nullptr, 1, nullptr);
     auto rasterizationStateCI = GraphicsTools::MakePipelineRasterizationStateCreateInfo();
     auto multisampleStateCI = GraphicsTools::MakePipelineMultisampleStateCreateInfo();
     auto depthStencilStateCI = GraphicsTools::MakePipelineDepthStencilStateCreateInfo();
     auto colorBlendAttachmentState = GraphicsTools::MakePipelineColorBlendAttachmentState();
     auto colorBlendStateCI =
         GraphicsTools::MakePipelineColorBlendStateCreateInfo(VK_FALSE, VK_LOGIC_OP_COPY, 1, &colorBlendAttachmentState);
-    auto dynamicStateCI = GraphicsTools::MakePipelineDynamicStateCreateInfo();
+    std::array<VkDynamicState, 2> dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    auto dynamicStateCI =
+        GraphicsTools::MakePipelineDynamicStateCreateInfo(static_cast<uint32_t>(dynamicStates.size()), dynamicStates.data());
 
     auto pipelineLayoutCI = GraphicsTools::MakePipelineLayoutCreateInfo();
     VK_ASSERT_SUCCESSED(vkCreatePipelineLayout(device_, &pipelineLayoutCI, nullptr, &graphicsPipelineLayout_));
@@ -439,7 +759,7 @@ void Graphics::CreateGraphicsPipeline()
         //.basePipelineIndex = basePipelineIndex,
     };
     VK_ASSERT_SUCCESSED(
-        vkCreateGraphicsPipelines(device_, VK_NULL_HANDLE, 1, &GraphicsPipelineCI, nullptr, &graphicsPipeline_));
+        vkCreateGraphicsPipelines(device_, pipelineCache_, 1, &GraphicsPipelineCI, nullptr, &graphicsPipeline_));
     vkDestroyShaderModule(device_, vertShaderModule, nullptr);
     vkDestroyShaderModule(device_, fragShaderModule, nullptr);
 }
@@ -462,52 +782,31 @@ void Graphics::CreateFramebuffers()
     }
 }
 
-void Graphics::CreateCommandBuffers()
-{
-    commandBuffers_.resize(swapchainImageCount_);
-
-    VkCommandBufferAllocateInfo CommandBufferAI{
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-        .commandPool = commandPool_,
-        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-        .commandBufferCount = swapchainImageCount_,
-    };
-
-    VK_ASSERT_SUCCESSED(vkAllocateCommandBuffers(device_, &CommandBufferAI, commandBuffers_.data()));
-}
-
 void Graphics::CreateSyncObjects()
 {
-    imageAvailableSemaphores_.resize(MAX_FRAMES_IN_FLIGHT);
-    renderFinishedSemaphores_.resize(MAX_FRAMES_IN_FLIGHT);
-    inFlightFences_.resize(MAX_FRAMES_IN_FLIGHT);
-    imagesInFlight_.resize(swapchainImageCount_, VK_NULL_HANDLE);
+    frameSync_.Create(&device_, framesInFlight_);
+    // the swapchain still needs binary semaphores for acquire and present
+    imageAvailableSemaphores_.resize(framesInFlight_);
+    renderFinishedSemaphores_.resize(framesInFlight_);
+    imagesInFlight_.assign(swapchainImageCount_, 0);
     VkSemaphoreCreateInfo semaphoreCI{
         .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
     };
-    VkFenceCreateInfo fenceCI{
-        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
-        .flags = VK_FENCE_CREATE_SIGNALED_BIT,
-    };
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+    for (size_t i = 0; i < framesInFlight_; i++) {
         VK_ASSERT_SUCCESSED(vkCreateSemaphore(device_, &semaphoreCI, nullptr, &imageAvailableSemaphores_[i]));
         VK_ASSERT_SUCCESSED(vkCreateSemaphore(device_, &semaphoreCI, nullptr, &renderFinishedSemaphores_[i]));
-        VK_ASSERT_SUCCESSED(vkCreateFence(device_, &fenceCI, nullptr, &inFlightFences_[i]));
     }
 }
 
 void Graphics::DestroySyncObjects()
 {
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+    for (size_t i = 0; i < imageAvailableSemaphores_.size(); i++) {
         vkDestroySemaphore(device_, imageAvailableSemaphores_[i], nullptr);
         vkDestroySemaphore(device_, renderFinishedSemaphores_[i], nullptr);
-        vkDestroyFence(device_, inFlightFences_[i], nullptr);
     }
-}
-
-void Graphics::FreeCommandBuffers()
-{
-    vkFreeCommandBuffers(device_, commandPool_, static_cast<uint32_t>(commandBuffers_.size()), commandBuffers_.data());
+    imageAvailableSemaphores_.clear();
+    renderFinishedSemaphores_.clear();
+    frameSync_.Destroy();
 }
 
 void Graphics::DestroyFramebuffers()
@@ -532,7 +831,7 @@ void Graphics::DestroyDepthResources()
 {
     vkDestroyImageView(device_, depthImageView_, nullptr);
     vkDestroyImage(device_, depthImage_, nullptr);
-    vkFreeMemory(device_, depthImageMemory_, nullptr);
+    device_.memoryAllocator.Free(depthImageAllocation_);
 }
 
 void Graphics::DestroySwapchainImageViews()
@@ -548,14 +847,56 @@ void Graphics::DestroySwapchain()
     vkDestroySwapchainKHR(device_, swapchainKHR_, nullptr);
 }
 
-void Graphics::DestroyCommandPool()
+void Graphics::DestroyOffscreenTargets()
+{
+    DestroySwapchainImageViews();
+    for (uint32_t i = 0; i < swapchainImageCount_; i++) {
+        vkDestroyImage(device_, swapchainImages_[i], nullptr);
+        device_.memoryAllocator.Free(offscreenImageAllocations_[i]);
+        vkDestroyBuffer(device_, readbackBuffers_[i], nullptr);
+        device_.memoryAllocator.Free(readbackAllocations_[i]);
+    }
+    swapchainImages_.clear();
+    offscreenImageAllocations_.clear();
+    readbackBuffers_.clear();
+    readbackAllocations_.clear();
+}
+
+void Graphics::DestroyGpuProfiler()
+{
+    gpuProfiler_.Destroy();
+}
+
+void Graphics::DestroyStagingRing()
+{
+    uploadRing_.Destroy();
+    stagingRing_.Destroy();
+}
+
+void Graphics::DestroyFrameCommandPools()
+{
+    // destroying a pool frees its command buffers
+    for (auto &frameCommandPool : frameCommandPools_)
+        vkDestroyCommandPool(device_, frameCommandPool.commandPool, nullptr);
+    frameCommandPools_.clear();
+}
+
+void Graphics::DestroyPipelineCache()
 {
-    vkDestroyCommandPool(device_, commandPool_, nullptr);
+    size_t size = 0;
+    VK_ASSERT_SUCCESSED(vkGetPipelineCacheData(device_, pipelineCache_, &size, nullptr))
+    std::vector<char> cacheData(size);
+    VK_ASSERT_SUCCESSED(vkGetPipelineCacheData(device_, pipelineCache_, &size, cacheData.data()))
+    if (!File::WriteBytesAtomic(PipelineCachePath(), cacheData.data(), size))
+        GDF_LOG(GraphicsLog, LogLevel::Warning, "Failed to save pipeline cache to {}", PipelineCachePath());
+    vkDestroyPipelineCache(device_, pipelineCache_, nullptr);
+    pipelineCache_ = VK_NULL_HANDLE;
 }
 
 void Graphics::DestroyDevice()
 {
     assert(device_.logicalDevice != VK_NULL_HANDLE);
+    device_.memoryAllocator.Destroy();
     vkDestroyDevice(device_, nullptr);
 }
 
@@ -575,8 +916,11 @@ void Graphics::DestroyInstance()
 
 void Graphics::RecreateSwapchain()
 {
-    GDF_LOG(GraphicsLog, LogLevel::Info, "RecreateSwapchain");
     RequireRecreateSwapchain_ = false;
+    // offscreen targets keep the size they were created with
+    if (headless())
+        return;
+    GDF_LOG(GraphicsLog, LogLevel::Info, "RecreateSwapchain");
     int width = 0, height = 0;
     glfwGetFramebufferSize(pWindow_->pGLFWWindow(), &width, &height);
     while (width == 0 || height == 0) {
@@ -584,27 +928,47 @@ void Graphics::RecreateSwapchain()
         glfwWaitEvents();
     }
 
-    // cleanup
-    DeviceWaitIdle();
-
-    ImGuiResourceDestroy();
-
-    FreeCommandBuffers();
-    DestroyFramebuffers();
-    DestroyGraphicsPipeline();
-    DestroyRenderPass();
-    DestroyDepthResources();
-
-    // create
+    // queue the old objects instead of DeviceWaitIdle, frames in flight keep presenting from the old swapchain.
+    // Every frame recorded against them has been submitted by now.
+    uint64_t lastUsedFrame = frameSync_.submittedFrame();
+    for (auto framebuffer : swapchainFramebuffers_)
+        deletionQueue_.Enqueue(framebuffer, lastUsedFrame);
+    for (auto framebuffer : imguiFramebuffers_)
+        deletionQueue_.Enqueue(framebuffer, lastUsedFrame);
+    for (auto imageView : swapchainImageViews_)
+        deletionQueue_.Enqueue(imageView, lastUsedFrame);
+    swapchainFramebuffers_.clear();
+    imguiFramebuffers_.clear();
+    swapchainImageViews_.clear();
+    deletionQueue_.Enqueue(depthImageView_, lastUsedFrame);
+    deletionQueue_.Enqueue(depthImage_, lastUsedFrame);
+    deletionQueue_.Enqueue(depthImageAllocation_, lastUsedFrame);
+    depthImageAllocation_ = DeviceAllocation{};
+    // CreateSwapchain still hands the old swapchain to the driver as oldSwapchain
+    deletionQueue_.Enqueue(swapchainKHR_, lastUsedFrame);
+
+    VkFormat oldImageFormat = swapchainImageFormat_;
     CreateSwapchain();
+    if (swapchainImageFormat_ != oldImageFormat) {
+        // the render passes and the pipeline only depend on the format, which hardly ever changes
+        deletionQueue_.Enqueue(graphicsPipeline_, lastUsedFrame);
+        deletionQueue_.Enqueue(graphicsPipelineLayout_, lastUsedFrame);
+        deletionQueue_.Enqueue(renderPass_, lastUsedFrame);
+        CreateRenderPass();
+        CreateGraphicsPipeline();
+        if (!imguiSubpass()) {
+            deletionQueue_.Enqueue(imguiRenderPass_, lastUsedFrame);
+            ImGuiCreateRenderPass();
+        }
+    }
     CreateDepthResources();
-    CreateRenderPass();
-    CreateGraphicsPipeline();
     CreateFramebuffers();
-    CreateCommandBuffers();
+    if (!imguiSubpass())
+        ImGuiCreateFramebuffer();
+    // command buffers belong to the frame slots, not to the images, so a new image count needs nothing else
+    imagesInFlight_.assign(swapchainImageCount_, 0);
 
     ImGuiUpdateMinImageCount(swapchainMinImageCount_);
-    ImGuiResourceCreate();
 }
 
 void Graphics::ImGuiCreate()
@@ -635,13 +999,14 @@ void Graphics::ImGuiCreate()
     initInfo.Device = device_;
     initInfo.QueueFamily = device_.queueFamilyIndices.graphics;
     initInfo.Queue = device_.graphicsQueue_;
-    initInfo.PipelineCache = imguiPipelineCache_;
+    initInfo.PipelineCache = pipelineCache_;
     initInfo.DescriptorPool = imguiDescriptorPool_;
     initInfo.Allocator = imguiAllocator_;
     initInfo.MinImageCount = swapchainMinImageCount_;
     initInfo.ImageCount = swapchainImageCount_;
     initInfo.CheckVkResultFn = ImGuiCheckVkResultCallback;
-    ImGui_ImplVulkan_Init(&initInfo, imguiRenderPass_);
+    initInfo.Subpass = imguiSubpass() ? 1 : 0;
+    ImGui_ImplVulkan_Init(&initInfo, imguiSubpass() ? renderPass_ : imguiRenderPass_);
 
     ImGuiUploadFonts();
 }
@@ -657,38 +1022,48 @@ void Graphics::ImGuiDestroy()
 
 void Graphics::ImGuiResourceCreate()
 {
+    // the merged subpass draws into renderPass_ and swapchainFramebuffers_
+    if (imguiSubpass())
+        return;
     ImGuiCreateRenderPass();
     ImGuiCreateFramebuffer();
-    ImGuiCreateCommandBuffer();
 }
 
 void Graphics::ImGuiResourceDestroy()
 {
-    vkFreeCommandBuffers(device_, commandPool_, static_cast<uint32_t>(imguiFramebuffers_.size()), imguiCommandBuffers_.data());
     for (size_t i = 0; i < imguiFramebuffers_.size(); i++) {
         vkDestroyFramebuffer(device_, imguiFramebuffers_[i], nullptr);
     }
+    imguiFramebuffers_.clear();
     vkDestroyRenderPass(device_, imguiRenderPass_, nullptr);
+    imguiRenderPass_ = VK_NULL_HANDLE;
 }
 
 void Graphics::ImGuiFrameBegin()
 {
+    GDF_PROFILE_FUNCTION();
     ImGui_ImplVulkan_NewFrame();
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
     ImGuiDockSpace();
     ImGui::ShowDemoWindow();
+    gpuProfiler_.DrawImGui();
+#ifdef GDF_ENABLE_PROFILER
+    if (CpuProfiler::pInstance() != nullptr)
+        CpuProfiler::instance().DrawImGui();
+#endif // GDF_ENABLE_PROFILER
     ImGui::Render();
     imGuiDrawData_ = ImGui::GetDrawData();
 }
 
-void Graphics::ImGuiFrameRender(uint32_t imageIndex)
+void Graphics::ImGuiFrameRender(VkCommandBuffer commandBuffer, uint32_t imageIndex)
 {
+    GDF_PROFILE_FUNCTION();
 
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     beginInfo.flags |= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-    VK_ASSERT_SUCCESSED(vkBeginCommandBuffer(imguiCommandBuffers_[imageIndex], &beginInfo));
+    VK_ASSERT_SUCCESSED(vkBeginCommandBuffer(commandBuffer, &beginInfo));
 
     VkClearValue clearValues{0.0f, 0.0f, 0.0f, 0.0f};
     VkRenderPassBeginInfo renderPassInfo{};
@@ -700,13 +1075,15 @@ void Graphics::ImGuiFrameRender(uint32_t imageIndex)
     renderPassInfo.clearValueCount = static_cast<uint32_t>(1);
     renderPassInfo.pClearValues = &clearValues;
 
-    vkCmdBeginRenderPass(imguiCommandBuffers_[imageIndex], &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+    gpuProfiler_.BeginScope(commandBuffer, "ImGui Pass");
+    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
 
-    ImGui_ImplVulkan_RenderDrawData(imGuiDrawData_, imguiCommandBuffers_[imageIndex]);
+    ImGui_ImplVulkan_RenderDrawData(imGuiDrawData_, commandBuffer);
 
-    vkCmdEndRenderPass(imguiCommandBuffers_[imageIndex]);
+    vkCmdEndRenderPass(commandBuffer);
+    gpuProfiler_.EndScope(commandBuffer);
 
-    VK_ASSERT_SUCCESSED(vkEndCommandBuffer(imguiCommandBuffers_[imageIndex]));
+    VK_ASSERT_SUCCESSED(vkEndCommandBuffer(commandBuffer));
 }
 
 void Graphics::ImGuiFrameEnd()
@@ -802,24 +1179,11 @@ void Graphics::ImGuiCreateFramebuffer()
     }
 }
 
-void Graphics::ImGuiCreateCommandBuffer()
-{
-    imguiCommandBuffers_.resize(swapchainImageCount_);
-
-    VkCommandBufferAllocateInfo CommandBufferAI{
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-        .commandPool = commandPool_,
-        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-        .commandBufferCount = swapchainImageCount_,
-    };
-    VK_ASSERT_SUCCESSED(vkAllocateCommandBuffers(device_, &CommandBufferAI, imguiCommandBuffers_.data()));
-}
-
 void Graphics::ImGuiUploadFonts()
 {
-    VkCommandBuffer commandBuffer = BeginSingleTimeCommand();
-    ImGui_ImplVulkan_CreateFontsTexture(commandBuffer);
-    EndSingleTimeCommand(commandBuffer);
+    ImGui_ImplVulkan_CreateFontsTexture(stagingRing_.commandBuffer());
+    // ImGui owns its upload buffer, it may only be destroyed once the copy has finished
+    stagingRing_.Flush();
     ImGui_ImplVulkan_DestroyFontUploadObjects();
 }
 
@@ -840,6 +1204,9 @@ bool Graphics::IsPhysicalDeviceSuitable(const VkPhysicalDevice physicalDevice)
     vkGetPhysicalDeviceProperties(physicalDevice, &properties);
     if (properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
         return true;
+    // CI and render-farm nodes may only have an integrated GPU or a software ICD such as lavapipe
+    if (headless())
+        return true;
     return false;
 }
 
@@ -946,39 +1313,9 @@ VkShaderModule Graphics::CreateShaderModule(const std::vector<char> &code)
 //     return imageView;
 // }
 
-// Command Helper
-
-inline VkCommandBuffer Graphics::BeginSingleTimeCommand()
-{
-    VkCommandBufferAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandPool = commandPool_;
-    allocInfo.commandBufferCount = 1;
-
-    VkCommandBuffer commandBuffer;
-    VK_ASSERT_SUCCESSED(vkAllocateCommandBuffers(device_, &allocInfo, &commandBuffer));
-
-    VkCommandBufferBeginInfo beginInfo{};
-    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-    VK_ASSERT_SUCCESSED(vkBeginCommandBuffer(commandBuffer, &beginInfo));
-
-    return commandBuffer;
-}
-
-inline void Graphics::EndSingleTimeCommand(VkCommandBuffer commandBuffer)
+std::string Graphics::PipelineCachePath()
 {
-    VK_ASSERT_SUCCESSED(vkEndCommandBuffer(commandBuffer));
-
-    VkSubmitInfo submitInfo{};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &commandBuffer;
-    VK_ASSERT_SUCCESSED(vkQueueSubmit(device_.graphicsQueue_, 1, &submitInfo, VK_NULL_HANDLE));
-    VK_ASSERT_SUCCESSED(vkQueueWaitIdle(device_.graphicsQueue_));
-    vkFreeCommandBuffers(device_, commandPool_, 1, &commandBuffer);
+    return File::GetExeDir() + std::string(File::Separator()) + "pipeline_cache.bin";
 }
 
 void Graphics::DeviceWaitIdle()
@@ -1048,6 +1385,7 @@ VkBool32 Graphics::DebugReportCallbackEXT(VkDebugReportFlagsEXT flags,
                                           void *pUserData)
 {
     if ((flags & VK_DEBUG_REPORT_ERROR_BIT_EXT) != 0) {
+        validationErrorCount_++;
         GDF_LOG(GraphicsLog, LogLevel::Error, "[{}] code {} : {}", pLayerPrefix, messageCode, pMessage);
     }
     if ((flags & VK_DEBUG_REPORT_WARNING_BIT_EXT) != 0 || (flags & VK_DEBUG_REPORT_PERFORMANCE_WARNING_BIT_EXT) != 0) {
@@ -1063,6 +1401,11 @@ VkBool32 Graphics::DebugReportCallbackEXT(VkDebugReportFlagsEXT flags,
     return VK_FALSE;
 }
 
+uint32_t Graphics::validationErrorCount()
+{
+    return validationErrorCount_.load();
+}
+
 std::string Graphics::GetShadersPath()
 {
     return File::GetExeDir() + "/shaders/";
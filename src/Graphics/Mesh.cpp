@@ -8,15 +8,375 @@
 #define JSON_NOEXCEPTION
 #define TINYGLTF_NOEXCEPTION
 #define TINYGLTF_USE_CPP14
+#include "Base/MappedFile.h"
+#include "Base/WorkerPool.h"
+#include "Graphics/AccessorDecode.h"
+#include "Graphics/DeletionQueue.h"
 #include "Graphics/Graphics.h"
 #include "Graphics/Mesh.h"
+#include "Graphics/StagingRing.h"
 #include "Log/Logger.h"
 #include <nlohmann/json.hpp>
+#include <cstring>
+#include <memory>
 #include <tiny_gltf.h>
 
 namespace gdf
 {
-bool Texture::Create(tinygltf::Image &gltfImage, std::string path, VulkanDevice *device, VkQueue transferQueue)
+
+namespace
+{
+constexpr uint32_t kGlbMagic = 0x46546C67;     // "glTF"
+constexpr uint32_t kGlbChunkJson = 0x4E4F534A; // "JSON"
+constexpr uint32_t kGlbChunkBin = 0x004E4942;  // "BIN\0"
+constexpr size_t kGlbHeaderSize = 12;
+constexpr size_t kGlbChunkHeaderSize = 8;
+
+using MappedFiles = std::vector<std::unique_ptr<MappedFile>>;
+
+// The bytes of a glTF buffer, in a file mapping or in tinygltf's own copy
+struct BufferData {
+    const uint8_t *data;
+    size_t size;
+};
+
+// Whether a buffer view lies inside its buffer
+bool BufferViewInBounds(const tinygltf::BufferView &bufferView, const std::vector<BufferData> &buffers)
+{
+    if (bufferView.buffer < 0 || static_cast<size_t>(bufferView.buffer) >= buffers.size())
+        return false;
+    size_t size = buffers[bufferView.buffer].size;
+    return bufferView.byteOffset <= size && bufferView.byteLength <= size - bufferView.byteOffset;
+}
+
+// Loads a .glb without copying its buffers. The BIN chunk and external .bin files stay in read-only mappings and
+// buffers points into them; tinygltf only parses the JSON chunk with the buffers and images taken out, so it never
+// copies them, and the images are decoded here straight from the mapping into gltfModel.images in their order.
+// Returns false for what needs tinygltf's own loader (data URIs, malformed files), the caller falls back to it.
+bool LoadGlbMapped(const std::string &filename,
+                   const std::string &baseDir,
+                   tinygltf::Model &gltfModel,
+                   std::vector<BufferData> &buffers,
+                   MappedFiles &mappedFiles)
+{
+    auto glb = std::make_unique<MappedFile>();
+    if (!glb->OpenRead(filename) || glb->size() < kGlbHeaderSize)
+        return false;
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(glb->data());
+    uint32_t header[3];
+    std::memcpy(header, data, sizeof(header));
+    if (header[0] != kGlbMagic || header[1] != 2 || header[2] > glb->size())
+        return false;
+
+    const char *json = nullptr;
+    size_t jsonSize = 0;
+    const uint8_t *bin = nullptr;
+    size_t binSize = 0;
+    size_t offset = kGlbHeaderSize;
+    while (offset + kGlbChunkHeaderSize <= header[2]) {
+        uint32_t chunk[2];
+        std::memcpy(chunk, data + offset, sizeof(chunk));
+        offset += kGlbChunkHeaderSize;
+        if (chunk[0] > header[2] - offset)
+            return false;
+        if (chunk[1] == kGlbChunkJson && json == nullptr) {
+            json = reinterpret_cast<const char *>(data + offset);
+            jsonSize = chunk[0];
+        } else if (chunk[1] == kGlbChunkBin && bin == nullptr) {
+            bin = data + offset;
+            binSize = chunk[0];
+        }
+        offset += chunk[0];
+    }
+    if (json == nullptr)
+        return false;
+
+    nlohmann::json document = nlohmann::json::parse(json, json + jsonSize, nullptr, false);
+    if (document.is_discarded() || !document.is_object())
+        return false;
+    if (document.contains("buffers")) {
+        for (const nlohmann::json &buffer : document["buffers"]) {
+            if (!buffer.is_object() || !buffer.contains("byteLength") || !buffer["byteLength"].is_number_unsigned())
+                return false;
+            size_t byteLength = buffer["byteLength"].get<size_t>();
+            // the buffer without a uri is the BIN chunk
+            if (!buffer.contains("uri")) {
+                if (bin == nullptr || byteLength > binSize)
+                    return false;
+                buffers.push_back(BufferData{bin, byteLength});
+                continue;
+            }
+            if (!buffer["uri"].is_string())
+                return false;
+            std::string uri = buffer["uri"].get<std::string>();
+            if (uri.compare(0, 5, "data:") == 0)
+                return false;
+            auto external = std::make_unique<MappedFile>();
+            if (!external->OpenRead(baseDir + "/" + uri) || byteLength > external->size())
+                return false;
+            buffers.push_back(BufferData{reinterpret_cast<const uint8_t *>(external->data()), byteLength});
+            mappedFiles.push_back(std::move(external));
+        }
+        document.erase("buffers");
+    }
+    nlohmann::json images = nlohmann::json::array();
+    if (document.contains("images")) {
+        images = std::move(document["images"]);
+        document.erase("images");
+        for (const nlohmann::json &image : images) {
+            if (!image.is_object())
+                return false;
+            if (image.contains("bufferView")) {
+                if (!image["bufferView"].is_number_unsigned())
+                    return false;
+            } else if (!image.contains("uri") || !image["uri"].is_string() ||
+                       image["uri"].get<std::string>().compare(0, 5, "data:") == 0) {
+                return false;
+            }
+        }
+    }
+
+    std::string text = document.dump();
+    tinygltf::TinyGLTF gltfContext;
+    std::string err;
+    std::string warn;
+    bool ret = gltfContext.LoadASCIIFromString(
+        &gltfModel, &err, &warn, text.c_str(), static_cast<unsigned int>(text.size()), baseDir);
+    if (!err.empty())
+        GDF_LOG(GraphicsLog, LogLevel::Error, "Model load error :{}", err);
+    if (!warn.empty())
+        GDF_LOG(GraphicsLog, LogLevel::Error, "Model load warn :{}", warn);
+    if (!ret)
+        return false;
+
+    for (const nlohmann::json &image : images) {
+        tinygltf::Image &gltfImage = gltfModel.images.emplace_back();
+        if (image.contains("name") && image["name"].is_string())
+            gltfImage.name = image["name"].get<std::string>();
+        if (image.contains("mimeType") && image["mimeType"].is_string())
+            gltfImage.mimeType = image["mimeType"].get<std::string>();
+        int width = 0;
+        int height = 0;
+        int component = 0;
+        stbi_uc *pixels = nullptr;
+        if (image.contains("bufferView")) {
+            size_t index = image["bufferView"].get<size_t>();
+            if (index >= gltfModel.bufferViews.size() || !BufferViewInBounds(gltfModel.bufferViews[index], buffers)) {
+                GDF_LOG(GraphicsLog, LogLevel::Error, "Image {} has an invalid bufferView!", gltfImage.name);
+                continue;
+            }
+            const tinygltf::BufferView &bufferView = gltfModel.bufferViews[index];
+            gltfImage.bufferView = static_cast<int>(index);
+            pixels = stbi_load_from_memory(buffers[bufferView.buffer].data + bufferView.byteOffset,
+                                           static_cast<int>(bufferView.byteLength),
+                                           &width,
+                                           &height,
+                                           &component,
+                                           STBI_rgb_alpha);
+        } else {
+            gltfImage.uri = image["uri"].get<std::string>();
+            pixels = stbi_load((baseDir + "/" + gltfImage.uri).c_str(), &width, &height, &component, STBI_rgb_alpha);
+        }
+        if (pixels == nullptr) {
+            GDF_LOG(GraphicsLog, LogLevel::Error, "Failed to decode image {}!", gltfImage.name);
+            continue;
+        }
+        // expanded to RGBA like tinygltf's own image loader does
+        gltfImage.width = width;
+        gltfImage.height = height;
+        gltfImage.component = STBI_rgb_alpha;
+        gltfImage.bits = 8;
+        gltfImage.pixel_type = TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE;
+        gltfImage.image.assign(pixels, pixels + static_cast<size_t>(width) * height * STBI_rgb_alpha);
+        stbi_image_free(pixels);
+    }
+    mappedFiles.push_back(std::move(glb));
+    return true;
+}
+
+// primitives a worker takes at a time, small ones are common and cheap
+constexpr uint32_t kDecodeGrainSize = 16;
+
+// glTF attribute of each Vertex::Component
+constexpr const char *kAttributeNames[kVertexComponentCount] = {
+    "POSITION", "NORMAL", "TEXCOORD_0", "COLOR_0", "TANGENT", "JOINTS_0", "WEIGHTS_0"};
+
+// Mask of the components a primitive has, joints and weights only together
+uint32_t PrimitiveComponents(const tinygltf::Primitive &primitive)
+{
+    uint32_t components = 0;
+    for (uint32_t i = 0; i < kVertexComponentCount; i++) {
+        if (primitive.attributes.count(kAttributeNames[i]) != 0)
+            components |= 1u << i;
+    }
+    uint32_t skin = VertexLayout::ComponentBit(Vertex::Component::Joint0) |
+                    VertexLayout::ComponentBit(Vertex::Component::Weight0);
+    if ((components & skin) != skin)
+        components &= ~skin;
+    return components;
+}
+
+// Elements of one vertex attribute, data is null for an attribute the primitive doesn't have
+AccessorStream FindAttribute(const tinygltf::Model &model,
+                             const std::vector<BufferData> &buffers,
+                             const tinygltf::Primitive &primitive,
+                             Vertex::Component component)
+{
+    auto attribute = primitive.attributes.find(kAttributeNames[static_cast<uint32_t>(component)]);
+    if (attribute == primitive.attributes.end())
+        return {};
+    const tinygltf::Accessor &accessor = model.accessors[attribute->second];
+    const tinygltf::BufferView &bufferView = model.bufferViews[accessor.bufferView];
+    int stride = accessor.ByteStride(bufferView);
+    int componentCount = tinygltf::GetNumComponentsInType(static_cast<uint32_t>(accessor.type));
+    if (stride <= 0 || componentCount <= 0)
+        return {};
+    return AccessorStream{
+        .data = buffers[bufferView.buffer].data + accessor.byteOffset + bufferView.byteOffset,
+        .stride = static_cast<size_t>(stride),
+        .componentType = accessor.componentType,
+        .componentCount = static_cast<uint32_t>(componentCount),
+        .normalized = accessor.normalized,
+    };
+}
+
+// Whether accessor holds at least minCount elements and they lie inside its buffer view, the views are checked already
+bool AccessorInBounds(const tinygltf::Model &model, int accessorIndex, size_t minCount)
+{
+    if (accessorIndex < 0 || static_cast<size_t>(accessorIndex) >= model.accessors.size())
+        return false;
+    const tinygltf::Accessor &accessor = model.accessors[accessorIndex];
+    if (accessor.bufferView < 0 || static_cast<size_t>(accessor.bufferView) >= model.bufferViews.size() ||
+        accessor.count < minCount)
+        return false;
+    const tinygltf::BufferView &bufferView = model.bufferViews[accessor.bufferView];
+    int stride = accessor.ByteStride(bufferView);
+    int componentSize = tinygltf::GetComponentSizeInBytes(static_cast<uint32_t>(accessor.componentType));
+    int componentCount = tinygltf::GetNumComponentsInType(static_cast<uint32_t>(accessor.type));
+    if (stride <= 0 || componentSize <= 0 || componentCount <= 0)
+        return false;
+    if (accessor.count == 0)
+        return accessor.byteOffset <= bufferView.byteLength;
+    // the last element ends at byteOffset + stride * (count - 1) + its size
+    size_t elementSize = static_cast<size_t>(componentSize) * componentCount;
+    if (accessor.byteOffset > bufferView.byteLength || elementSize > bufferView.byteLength - accessor.byteOffset)
+        return false;
+    return accessor.count - 1 <= (bufferView.byteLength - accessor.byteOffset - elementSize) / stride;
+}
+
+// Checks everything the decode reads from the buffers: every buffer view lies inside its buffer, and each primitive
+// that gets decoded has its indices and attributes inside their views with an element per vertex. The buffers may be
+// a file mapping, so a malformed file has to fail here instead of reading past it.
+bool ValidateGeometry(const tinygltf::Model &model, const std::vector<BufferData> &buffers)
+{
+    for (size_t i = 0; i < model.bufferViews.size(); i++) {
+        if (!BufferViewInBounds(model.bufferViews[i], buffers)) {
+            GDF_LOG(GraphicsLog, LogLevel::Error, "Buffer view {} lies outside its buffer!", i);
+            return false;
+        }
+    }
+    for (const tinygltf::Mesh &mesh : model.meshes) {
+        for (const tinygltf::Primitive &primitive : mesh.primitives) {
+            // tinygltfLoadNode skips these without reading them
+            if (primitive.indices <= 0)
+                continue;
+            auto position = primitive.attributes.find("POSITION");
+            if (position == primitive.attributes.end() || !AccessorInBounds(model, position->second, 0) ||
+                model.accessors[position->second].minValues.size() < 3 ||
+                model.accessors[position->second].maxValues.size() < 3) {
+                GDF_LOG(GraphicsLog,
+                        LogLevel::Error,
+                        "Mesh {} has positions outside their buffer view or without bounds!",
+                        mesh.name);
+                return false;
+            }
+            size_t vertexCount = model.accessors[position->second].count;
+            if (!AccessorInBounds(model, primitive.indices, 0)) {
+                GDF_LOG(GraphicsLog, LogLevel::Error, "Mesh {} has indices outside their buffer view!", mesh.name);
+                return false;
+            }
+            uint32_t components = PrimitiveComponents(primitive);
+            for (uint32_t i = 0; i < kVertexComponentCount; i++) {
+                if ((components & (1u << i)) != 0 &&
+                    !AccessorInBounds(model, primitive.attributes.at(kAttributeNames[i]), vertexCount)) {
+                    GDF_LOG(GraphicsLog,
+                            LogLevel::Error,
+                            "Mesh {} has {} outside its buffer view or shorter than POSITION!",
+                            mesh.name,
+                            kAttributeNames[i]);
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Decodes a primitive into the vertex and index ranges tinygltfLoadNode laid out for it, runs on any loader thread.
+// Each attribute of layout is one strided stream through the vectorized accessor kernels, float attributes straight
+// into the vertices and quantized ones through a float buffer first. Attributes the primitive lacks get defaults.
+// With streams the attributes are decoded into them instead and interleaved from there when vertexData is given.
+void DecodePrimitive(const tinygltf::Model &model,
+                     const std::vector<BufferData> &buffers,
+                     const tinygltf::Primitive &gltfPrimitive,
+                     const Primitive &primitive,
+                     const VertexLayout &layout,
+                     VertexStreams *streams,
+                     uint8_t *vertexData,
+                     uint32_t *indices)
+{
+    // one per loader thread, reused across primitives
+    thread_local std::vector<float> decoded;
+
+    uint32_t components = PrimitiveComponents(gltfPrimitive);
+    uint32_t count = primitive.vertexCount;
+    uint8_t *vertices = nullptr;
+    if (vertexData != nullptr)
+        vertices = vertexData + static_cast<size_t>(layout.stride()) * primitive.firstVertex;
+    for (const VertexLayout::Attribute &attribute : layout.attributes()) {
+        uint32_t valueCount = VertexLayout::ComponentCount(attribute.component);
+        AccessorStream stream;
+        if ((components & VertexLayout::ComponentBit(attribute.component)) != 0)
+            stream = FindAttribute(model, buffers, gltfPrimitive, attribute.component);
+
+        bool quantized = streams == nullptr && attribute.format != VertexFormat::Float;
+        float *destination;
+        size_t destinationStride = valueCount * sizeof(float);
+        if (streams != nullptr) {
+            destination = streams->Stream(attribute.component) + static_cast<size_t>(primitive.firstVertex) * valueCount;
+        } else if (quantized) {
+            decoded.resize(static_cast<size_t>(count) * valueCount);
+            destination = decoded.data();
+        } else {
+            destination = reinterpret_cast<float *>(vertices + attribute.offset);
+            destinationStride = layout.stride();
+        }
+        if (stream.data != nullptr)
+            DecodeAccessor(stream, destination, destinationStride, valueCount, count);
+        else
+            FillAccessor(VertexLayout::DefaultValue(attribute.component), destination, destinationStride, valueCount, count);
+        if (attribute.component == Vertex::Component::Normal && stream.data != nullptr)
+            NormalizeVectors(destination, destinationStride, count);
+        if (quantized)
+            layout.Encode(attribute, decoded.data(), count, primitive.dimensions.min, primitive.dimensions.size, vertices);
+    }
+    if (streams != nullptr && vertexData != nullptr)
+        streams->Interleave(
+            layout, primitive.firstVertex, count, primitive.dimensions.min, primitive.dimensions.size, vertexData);
+
+    const tinygltf::Accessor &accessor = model.accessors[gltfPrimitive.indices];
+    const tinygltf::BufferView &bufferView = model.bufferViews[accessor.bufferView];
+    const uint8_t *data = buffers[bufferView.buffer].data + accessor.byteOffset + bufferView.byteOffset;
+    uint32_t *index = indices + primitive.firstIndex;
+    // the first primitive needs no rebasing, its indices go in as one block
+    if (accessor.componentType == TINYGLTF_PARAMETER_TYPE_UNSIGNED_INT && primitive.firstVertex == 0)
+        std::memcpy(index, data, primitive.indexCount * sizeof(uint32_t));
+    else
+        WidenIndices(data, accessor.componentType, primitive.indexCount, primitive.firstVertex, index);
+}
+} // namespace
+
+bool Texture::Create(tinygltf::Image &gltfImage, std::string path, VulkanDevice *device, StagingRing &staging)
 {
     bool isKtx = false;
     // Image points to an external ktx file
@@ -48,67 +408,70 @@ bool Texture::Create(tinygltf::Image &gltfImage, std::string path, VulkanDevice
         }
         VkFormat format = VK_FORMAT_R8G8B8A8_UNORM;
 
+        this->device = device;
         width = gltfImage.width;
         height = gltfImage.height;
-        mipLevels = static_cast<uint32_t>(floor(log2(std::max(width, height))) + 1.0);
-        VkFormatProperties formatProperty;
-        vkGetPhysicalDeviceFormatProperties(*device, format, &formatProperty);
-        assert(formatProperty.optimalTilingFeatures & VK_FORMAT_FEATURE_BLIT_SRC_BIT);
-        assert(formatProperty.optimalTilingFeatures & VK_FORMAT_FEATURE_BLIT_DST_BIT);
-
-        VkMemoryRequirements memoryReqs;
-        VkBuffer stagingBuffer;
-        VkDeviceMemory stagingMemory;
-
-        auto bufferCI =
-            GraphicsTools::MakeBufferCreateInfo(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_SHARING_MODE_EXCLUSIVE);
-        VK_ASSERT_SUCCESSED(vkCreateBuffer(*device, &bufferCI, nullptr, &stagingBuffer));
-        vkGetBufferMemoryRequirements(*device, stagingBuffer, &memoryReqs);
-        auto memoryAI = GraphicsTools::MakeMemoryAllocateInfo(
-            memoryReqs.size,
-            device->FindMemoryType(memoryReqs.memoryTypeBits,
-                                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
-        VK_ASSERT_SUCCESSED(vkAllocateMemory(*device, &memoryAI, nullptr, &stagingMemory));
-        VK_ASSERT_SUCCESSED(vkBindBufferMemory(*device, stagingBuffer, stagingMemory, 0));
-
-        uint8_t *pData;
-        VK_ASSERT_SUCCESSED(vkMapMemory(device->logicalDevice, stagingMemory, 0, memoryReqs.size, 0, (void **)&pData));
-        memcpy(pData, pBuffer, bufferSize);
-        vkUnmapMemory(device->logicalDevice, stagingMemory);
-        // device->CreateImage(width,
-        //                     height,
-        //                     format,
-        //                     VK_,
-        //                     VkImageUsageFlags usage,
-        //                     VkMemoryPropertyFlags properties,
-        //                     VkImage & image,
-        //                     VkDeviceMemory & imageMemory)
+        // only the base level is uploaded, there is no mip generation yet
+        mipLevels = 1;
+        layerCount = 1;
+
+        device->CreateImage(width,
+                            height,
+                            format,
+                            VK_IMAGE_TILING_OPTIMAL,
+                            VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                            image,
+                            allocation);
+        // the copy is recorded into the staging ring's current batch, the caller submits once for all images
+        staging.UploadImage(image, width, height, pBuffer, bufferSize);
+        imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        imageView = device->CreateImageView(image, format, VK_IMAGE_ASPECT_COLOR_BIT);
     }
     return true;
 }
 
 void Texture::Destroy()
 {
+    if (device == nullptr)
+        return;
+    vkDestroyImageView(*device, imageView, nullptr);
+    vkDestroyImage(*device, image, nullptr);
+    device->memoryAllocator.Free(allocation);
+    device = nullptr;
+}
+
+void Texture::Destroy(DeletionQueue &deletionQueue)
+{
+    if (device == nullptr)
+        return;
+    deletionQueue.Enqueue(imageView);
+    deletionQueue.Enqueue(image);
+    deletionQueue.Enqueue(allocation);
+    allocation = DeviceAllocation{};
+    device = nullptr;
 }
 
-void Model::tinygltfLoadImage(tinygltf::Model gltfModel, VulkanDevice *device, VkQueue transferQueue)
+void Model::tinygltfLoadImage(tinygltf::Model gltfModel, VulkanDevice *device, StagingRing &staging)
 {
     for (tinygltf::Image &gltfImage : gltfModel.images) {
         Texture texture;
-        texture.Create(gltfImage, path, device, transferQueue);
+        texture.Create(gltfImage, path, device, staging);
         textures.push_back(texture);
     }
+    staging.Submit();
 }
 
 void Model::tinygltfLoadNode(Node *parent,
                              const tinygltf::Node &node,
                              uint32_t nodeIndex,
                              const tinygltf::Model &model,
-                             std::vector<uint32_t> &indexBuffer,
-                             std::vector<Vertex> &vertexBuffer,
+                             std::vector<PrimitiveDecode> &decodes,
+                             uint32_t &vertexCount,
+                             uint32_t &indexCount,
                              float globalscale)
 {
-    Node *newNode = new Node{};
+    Node *newNode = nodePool.New();
     newNode->name = node.name;
     if (parent) {
         newNode->parent = parent;
@@ -116,172 +479,55 @@ void Model::tinygltfLoadNode(Node *parent,
         nodes.push_back(newNode);
     }
     for (size_t i = 0; i < node.children.size(); i++)
-        tinygltfLoadNode(
-            newNode, model.nodes[node.children[i]], node.children[i], model, indexBuffer, vertexBuffer, globalscale);
+        tinygltfLoadNode(newNode,
+                         model.nodes[node.children[i]],
+                         node.children[i],
+                         model,
+                         decodes,
+                         vertexCount,
+                         indexCount,
+                         globalscale);
     if (parent)
         parent->children.push_back(newNode);
-    newNode->children = {};
     newNode->index = nodeIndex;
     newNode->matrix = glm::mat4(1.0f);
     newNode->mesh = nullptr;
     if (node.mesh > -1) {
         const tinygltf::Mesh &mesh = model.meshes[node.mesh];
-        Mesh *newMesh = new Mesh;
+        Mesh *newMesh = meshPool.New();
         newMesh->name = mesh.name;
         for (size_t i = 0; i < mesh.primitives.size(); i++) {
             const tinygltf::Primitive &primitive = mesh.primitives[i];
             if (primitive.indices <= 0) //不处理非索引的顶点
                 continue;
-            uint32_t indexStart = static_cast<uint32_t>(indexBuffer.size());
-            uint32_t vertexStart = static_cast<uint32_t>(vertexBuffer.size());
-            uint32_t indexCount = 0;
-            uint32_t vertexCount = 0;
-            glm::vec3 minPos{};
-            glm::vec3 maxPos{};
-            bool hasSkin = false;
-            { // Vertices
-                const float *bufferPos = nullptr;
-                const float *bufferNormals = nullptr;
-                const float *bufferTexCoords = nullptr;
-                const float *bufferColors = nullptr;
-                const float *bufferTangents = nullptr;
-                const uint16_t *bufferJoints = nullptr;
-                const float *bufferWeights = nullptr;
-                uint32_t numColorComponents;
-
-                size_t byteStridePos = 0;
-                size_t byteStrideNormals = 0;
-                size_t byteStrideTexCoords = 0;
-                size_t byteStrideColors = 0;
-                size_t byteStrideTangents = 0;
-                size_t byteStrideJoints = 0;
-                size_t byteStrideWeights = 0;
-
-                // Position
-                assert(primitive.attributes.find("POSITION") != primitive.attributes.end());
-                const tinygltf::Accessor &accessorPos = model.accessors[primitive.attributes.find("POSITION")->second];
-                const tinygltf::BufferView &bufferViewPos = model.bufferViews[accessorPos.bufferView];
-                byteStridePos = bufferViewPos.byteStride;
-                bufferPos = reinterpret_cast<const float *>(
-                    &(model.buffers[bufferViewPos.buffer].data[accessorPos.byteOffset + bufferViewPos.byteOffset]));
-                minPos = glm::vec3(accessorPos.minValues[0], accessorPos.minValues[1], accessorPos.minValues[2]);
-                maxPos = glm::vec3(accessorPos.maxValues[0], accessorPos.maxValues[1], accessorPos.maxValues[2]);
-
-#define VERTEX_COMPONENT_X(ComponentName, ComponentByteStride, pBuffer)                                                        \
-    if (primitive.attributes.find(ComponentName) != primitive.attributes.end()) {                                              \
-        const tinygltf::Accessor &accessorNormal = model.accessors[primitive.attributes.find(ComponentName)->second];          \
-        const tinygltf::BufferView &bufferViewNormal = model.bufferViews[accessorNormal.bufferView];                           \
-        ComponentByteStride = bufferViewNormal.byteStride;                                                                     \
-        pBuffer = reinterpret_cast<const float *>(                                                                             \
-            &(model.buffers[bufferViewNormal.buffer].data[accessorNormal.byteOffset + bufferViewNormal.byteOffset]));          \
-    }
-                // Normal
-                VERTEX_COMPONENT_X("NORMAL", byteStrideNormals, bufferNormals);
-                // Texcoord
-                VERTEX_COMPONENT_X("TEXCOORD_0", byteStrideTexCoords, bufferTexCoords);
-                // Color
-                if (primitive.attributes.find("COLOR_0") != primitive.attributes.end()) {
-                    const tinygltf::Accessor &accessorColor = model.accessors[primitive.attributes.find("COLOR_0")->second];
-                    const tinygltf::BufferView &bufferViewColor = model.bufferViews[accessorColor.bufferView];
-                    byteStrideColors = bufferViewColor.byteStride;
-                    // Color buffer are either of type vec3 or vec4
-                    numColorComponents = accessorColor.type == TINYGLTF_PARAMETER_TYPE_FLOAT_VEC3 ? 3 : 4;
-                    bufferColors = reinterpret_cast<const float *>(
-                        &(model.buffers[bufferViewColor.buffer].data[accessorColor.byteOffset + bufferViewColor.byteOffset]));
-                }
-                // Tangent
-                VERTEX_COMPONENT_X("TANGENT", byteStrideTangents, bufferTangents);
-                // Joints
-                if (primitive.attributes.find("JOINTS_0") != primitive.attributes.end()) {
-                    const tinygltf::Accessor &accessorJoint = model.accessors[primitive.attributes.find("JOINTS_0")->second];
-                    const tinygltf::BufferView &bufferViewJoint = model.bufferViews[accessorJoint.bufferView];
-                    byteStrideJoints = bufferViewJoint.byteStride;
-                    bufferJoints = reinterpret_cast<const uint16_t *>(
-                        &(model.buffers[bufferViewJoint.buffer].data[accessorJoint.byteOffset + bufferViewJoint.byteOffset]));
-                }
-                // Weights
-                VERTEX_COMPONENT_X("WEIGHTS_0", byteStrideWeights, bufferWeights);
-#undef VERTEX_COMPONENT_X
-                hasSkin = (bufferJoints && bufferWeights);
-                // write into
-                vertexCount = static_cast<uint32_t>(accessorPos.count);
-                for (size_t i = 0; i < accessorPos.count; i++) {
-                    Vertex vert{};
-#define VERTEX_COMPONENT_OFFSET(Start, ByteStride, Count)                                                                      \
-    (ByteStride == 0 ? (const float *)(((uint8_t *)Start) + (i * Count))                                                       \
-                     : (const float *)(((uint8_t *)Start) + (ByteStride * i)))
-                    vert.pos = glm::make_vec3(VERTEX_COMPONENT_OFFSET(bufferPos, byteStridePos, 3));
-                    vert.normal = glm::normalize(
-                        glm::vec3(bufferNormals ? glm::make_vec3(VERTEX_COMPONENT_OFFSET(bufferNormals, byteStrideNormals, 3))
-                                                : glm::vec3(0.0f)));
-                    vert.uv = bufferTexCoords ? glm::make_vec2(VERTEX_COMPONENT_OFFSET(bufferTexCoords, byteStrideTexCoords, 2))
-                                              : glm::vec3(0.0f);
-                    if (bufferColors) {
-                        switch (numColorComponents) {
-                        case 3:
-                            vert.color =
-                                glm::vec4(glm::make_vec3(VERTEX_COMPONENT_OFFSET(bufferColors, byteStrideColors, 3)), 1.0f);
-                        case 4:
-                            vert.color = glm::make_vec4(VERTEX_COMPONENT_OFFSET(bufferColors, byteStrideColors, 4));
-                        }
-                    } else {
-                        vert.color = glm::vec4(1.0f);
-                    }
-                    vert.tangent =
-                        bufferTangents
-                            ? glm::vec4(glm::make_vec4(VERTEX_COMPONENT_OFFSET(bufferTangents, byteStrideTangents, 4)))
-                            : glm::vec4(0.0f);
-                    vert.joint0 = hasSkin
-                                      ? glm::vec4(glm::make_vec4(VERTEX_COMPONENT_OFFSET(bufferJoints, byteStrideJoints, 4)))
-                                      : glm::vec4(0.0f);
-                    vert.weight0 = hasSkin ? glm::make_vec4(VERTEX_COMPONENT_OFFSET(bufferWeights, byteStrideWeights, 4))
-                                           : glm::vec4(0.0f);
-                    vertexBuffer.push_back(vert);
-#undef VERTEX_COMPONENT_OFFSET
-                }
-            }
-
-            { // Indices
-                const tinygltf::Accessor &accessor = model.accessors[primitive.indices];
-                const tinygltf::BufferView &bufferView = model.bufferViews[accessor.bufferView];
-                const tinygltf::Buffer &buffer = model.buffers[bufferView.buffer];
-
-                indexCount = static_cast<uint32_t>(accessor.count);
-
-                switch (accessor.componentType) {
-                case TINYGLTF_PARAMETER_TYPE_UNSIGNED_INT: {
-                    uint32_t *indices = (uint32_t *)(&(buffer.data[accessor.byteOffset + bufferView.byteOffset]));
-                    for (size_t i = 0; i < accessor.count; i++)
-                        indexBuffer.push_back(indices[i] + vertexStart);
-                    break;
-                }
-                case TINYGLTF_PARAMETER_TYPE_UNSIGNED_SHORT: {
-                    uint16_t *indices = (uint16_t *)(&(buffer.data[accessor.byteOffset + bufferView.byteOffset]));
-                    for (size_t i = 0; i < accessor.count; i++)
-                        indexBuffer.push_back(indices[i] + vertexStart);
-                    break;
-                }
-                case TINYGLTF_PARAMETER_TYPE_UNSIGNED_BYTE: {
-                    uint8_t *indices = (uint8_t *)(&(buffer.data[accessor.byteOffset + bufferView.byteOffset]));
-                    for (size_t i = 0; i < accessor.count; i++)
-                        indexBuffer.push_back(indices[i] + vertexStart);
-                    break;
-                }
-                default:
-                    GDF_LOG(GraphicsLog, LogLevel::Error, "Index component type {} not supported!", accessor.componentType);
-                    return;
-                }
-                //
-                Primitive *newPrimitive = new Primitive();
-                newPrimitive->firstVertex = vertexStart;
-                newPrimitive->vertexCount = vertexCount;
-                newPrimitive->firstIndex = indexStart;
-                newPrimitive->indexCount = indexCount;
-                newPrimitive->material = &(primitive.material > -1 ? materials[primitive.material] : materials.back());
-                newPrimitive->dimensions.max = maxPos;
-                newPrimitive->dimensions.min = minPos;
-                newMesh->primitives.push_back(newPrimitive);
+            assert(primitive.attributes.find("POSITION") != primitive.attributes.end());
+            const tinygltf::Accessor &accessorPos = model.accessors[primitive.attributes.find("POSITION")->second];
+            const tinygltf::Accessor &accessorIndex = model.accessors[primitive.indices];
+            if (accessorIndex.componentType != TINYGLTF_PARAMETER_TYPE_UNSIGNED_INT &&
+                accessorIndex.componentType != TINYGLTF_PARAMETER_TYPE_UNSIGNED_SHORT &&
+                accessorIndex.componentType != TINYGLTF_PARAMETER_TYPE_UNSIGNED_BYTE) {
+                GDF_LOG(GraphicsLog, LogLevel::Error, "Index component type {} not supported!", accessorIndex.componentType);
+                continue;
             }
+            // only the ranges are laid out here, the data is decoded once every primitive has its range
+            Primitive *newPrimitive = primitivePool.New();
+            newPrimitive->firstVertex = vertexCount;
+            newPrimitive->vertexCount = static_cast<uint32_t>(accessorPos.count);
+            newPrimitive->firstIndex = indexCount;
+            newPrimitive->indexCount = static_cast<uint32_t>(accessorIndex.count);
+            newPrimitive->material = &(primitive.material > -1 ? materials[primitive.material] : materials.back());
+            newPrimitive->dimensions.max =
+                glm::vec3(accessorPos.maxValues[0], accessorPos.maxValues[1], accessorPos.maxValues[2]);
+            newPrimitive->dimensions.min =
+                glm::vec3(accessorPos.minValues[0], accessorPos.minValues[1], accessorPos.minValues[2]);
+            newPrimitive->dimensions.size = newPrimitive->dimensions.max - newPrimitive->dimensions.min;
+            newPrimitive->dimensions.center = (newPrimitive->dimensions.min + newPrimitive->dimensions.max) / 2.0f;
+            newPrimitive->dimensions.radius = glm::length(newPrimitive->dimensions.size) / 2.0f;
+            newMesh->primitives.push_back(newPrimitive);
+            primitives.push_back(newPrimitive);
+            decodes.push_back(PrimitiveDecode{&primitive, newPrimitive});
+            vertexCount += newPrimitive->vertexCount;
+            indexCount += newPrimitive->indexCount;
             newNode->mesh = newMesh;
         }
     }
@@ -307,41 +553,117 @@ void Model::tinygltfLoadNode(Node *parent,
     linearNodes.emplace_back(newNode);
 }
 
-Model *Model::LoadFromFile(std::string filename)
+Model *Model::LoadFromFile(std::string filename,
+                           WorkerPool *workers,
+                           const VertexFormats &formats,
+                           VertexStorage storage)
 {
     Model *model = new Model;
-    tinygltf::Model gltfModel;
-    tinygltf::TinyGLTF gltfContext;
-    std::string err;
-    std::string warn;
-    auto ret = gltfContext.LoadASCIIFromFile(&gltfModel, &err, &warn, filename);
-    if (!ret)
-        GDF_LOG(GraphicsLog, LogLevel::Error, "Failed to parse glTF!");
-    if (!err.empty())
-        GDF_LOG(GraphicsLog, LogLevel::Error, "Model load error :{}", err);
-    if (!warn.empty())
-        GDF_LOG(GraphicsLog, LogLevel::Error, "Model load warn :{}", warn);
-
     size_t pos = filename.find_last_of('/');
     model->path = filename.substr(0, pos);
+    std::string baseDir = pos == std::string::npos ? std::string(".") : filename.substr(0, pos);
+    bool isGlb = filename.size() > 4 && filename.compare(filename.size() - 4, 4, ".glb") == 0;
 
-    std::vector<uint32_t> indexBuffer;
-    std::vector<Vertex> vertexBuffer;
+    tinygltf::Model gltfModel;
+    std::vector<BufferData> buffers;
+    // the .glb and its external buffers stay mapped until the geometry has been read out of them
+    MappedFiles mappedFiles;
+    if (!isGlb || !LoadGlbMapped(filename, baseDir, gltfModel, buffers, mappedFiles)) {
+        gltfModel = tinygltf::Model();
+        buffers.clear();
+        mappedFiles.clear();
+        tinygltf::TinyGLTF gltfContext;
+        std::string err;
+        std::string warn;
+        auto ret = isGlb ? gltfContext.LoadBinaryFromFile(&gltfModel, &err, &warn, filename)
+                         : gltfContext.LoadASCIIFromFile(&gltfModel, &err, &warn, filename);
+        if (!err.empty())
+            GDF_LOG(GraphicsLog, LogLevel::Error, "Model load error :{}", err);
+        if (!warn.empty())
+            GDF_LOG(GraphicsLog, LogLevel::Error, "Model load warn :{}", warn);
+        if (!ret) {
+            GDF_LOG(GraphicsLog, LogLevel::Error, "Failed to parse glTF!");
+            delete model;
+            return nullptr;
+        }
+        for (const tinygltf::Buffer &buffer : gltfModel.buffers)
+            buffers.push_back(BufferData{buffer.data.data(), buffer.data.size()});
+    }
+    if (!ValidateGeometry(gltfModel, buffers)) {
+        GDF_LOG(GraphicsLog, LogLevel::Error, "Failed to load {}, its geometry lies outside its buffers!", filename);
+        delete model;
+        return nullptr;
+    }
 
+    std::vector<PrimitiveDecode> decodes;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
     const tinygltf::Scene &scene = gltfModel.scenes[gltfModel.defaultScene > -1 ? gltfModel.defaultScene : 0];
     for (size_t i = 0; i < scene.nodes.size(); i++) {
         const tinygltf::Node &node = gltfModel.nodes[scene.nodes[i]];
-        model->tinygltfLoadNode(nullptr, node, scene.nodes[i], gltfModel, indexBuffer, vertexBuffer, 1.0f);
+        model->tinygltfLoadNode(nullptr, node, scene.nodes[i], gltfModel, decodes, vertexCount, indexCount, 1.0f);
     }
 
+    // one layout for the whole model, with the attributes any of its primitives has
+    uint32_t components = 0;
+    VertexFormats vertexFormats = formats;
+    for (const PrimitiveDecode &decode : decodes) {
+        uint32_t primitiveComponents = PrimitiveComponents(*decode.gltfPrimitive);
+        components |= primitiveComponents;
+        // u16 joint indices may not fit in a byte
+        if ((primitiveComponents & VertexLayout::ComponentBit(Vertex::Component::Joint0)) != 0 &&
+            gltfModel.accessors[decode.gltfPrimitive->attributes.at("JOINTS_0")].componentType ==
+                TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT &&
+            vertexFormats[static_cast<uint32_t>(Vertex::Component::Joint0)] == VertexFormat::Uint8)
+            vertexFormats[static_cast<uint32_t>(Vertex::Component::Joint0)] = VertexFormat::Uint16;
+    }
+    model->vertexLayout = VertexLayout(components, vertexFormats);
+
+    // every primitive only writes its own ranges, the geometry is the same for any number of threads
+    if (storage != VertexStorage::Streams)
+        model->vertexData.resize(static_cast<size_t>(vertexCount) * model->vertexLayout.stride());
+    if (storage != VertexStorage::Interleaved)
+        model->vertexStreams = VertexStreams(components, vertexCount);
+    model->indexData.resize(indexCount);
+    VertexStreams *streams = storage != VertexStorage::Interleaved ? &model->vertexStreams : nullptr;
+    uint8_t *vertexData = storage != VertexStorage::Streams ? model->vertexData.data() : nullptr;
+    auto decode = [&](uint32_t first, uint32_t last) {
+        for (uint32_t i = first; i < last; i++)
+            DecodePrimitive(gltfModel,
+                            buffers,
+                            *decodes[i].gltfPrimitive,
+                            *decodes[i].primitive,
+                            model->vertexLayout,
+                            streams,
+                            vertexData,
+                            model->indexData.data());
+    };
+    if (workers != nullptr)
+        workers->ParallelFor(static_cast<uint32_t>(decodes.size()), kDecodeGrainSize, decode);
+    else
+        decode(0, static_cast<uint32_t>(decodes.size()));
+    model->vertices.count = vertexCount;
+    model->indices.count = indexCount;
+
     return model;
 }
 
+void Model::InterleaveVertices()
+{
+    vertexData.resize(static_cast<size_t>(vertexStreams.vertexCount()) * vertexLayout.stride());
+    for (const Primitive *primitive : primitives)
+        vertexStreams.Interleave(vertexLayout,
+                                 primitive->firstVertex,
+                                 primitive->vertexCount,
+                                 primitive->dimensions.min,
+                                 primitive->dimensions.size,
+                                 vertexData.data());
+}
+
 Model::~Model()
 {
-    for (auto node : nodes)
-        delete node;
     nodes.clear();
+    linearNodes.clear();
 }
 
 } // namespace gdf
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include "Graphics/ParallelRecorder.h"
+#include "DeveloperTool/CpuProfiler.h"
+#include "Graphics/VulkanDevice.h"
+#include <algorithm>
+
+namespace gdf
+{
+
+void ParallelRecorder::Create(VulkanDevice *device, uint32_t queueFamilyIndex, uint32_t frameCount, uint32_t threadCount)
+{
+    device_ = device;
+    threadCount_ = std::max(threadCount, 1u);
+
+    VkCommandPoolCreateInfo commandPoolCI{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+        .queueFamilyIndex = queueFamilyIndex,
+    };
+    commandPools_.resize(frameCount * threadCount_);
+    commandBuffers_.resize(frameCount * threadCount_);
+    for (size_t i = 0; i < commandPools_.size(); i++) {
+        VK_ASSERT_SUCCESSED(vkCreateCommandPool(*device_, &commandPoolCI, nullptr, &commandPools_[i]));
+        VkCommandBufferAllocateInfo allocInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .commandPool = commandPools_[i],
+            .level = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+            .commandBufferCount = 1,
+        };
+        VK_ASSERT_SUCCESSED(vkAllocateCommandBuffers(*device_, &allocInfo, &commandBuffers_[i]));
+    }
+
+    workers_.Create(threadCount_, "Command Recorder");
+}
+
+void ParallelRecorder::Destroy()
+{
+    workers_.Destroy();
+    // destroying a pool frees its command buffers
+    for (auto commandPool : commandPools_)
+        vkDestroyCommandPool(*device_, commandPool, nullptr);
+    commandPools_.clear();
+    commandBuffers_.clear();
+    threadCount_ = 0;
+}
+
+std::span<const VkCommandBuffer> ParallelRecorder::Record(uint32_t frameSlot,
+                                                          const VkCommandBufferInheritanceInfo &inheritance,
+                                                          uint32_t itemCount,
+                                                          const RecordFunction &record)
+{
+    GDF_PROFILE_FUNCTION();
+    // one range per item of the pool, ranges already running keep their pool's command buffer to themselves
+    workers_.ParallelFor(threadCount_, 1, [&](uint32_t first, uint32_t last) {
+        for (uint32_t range = first; range < last; range++)
+            RecordRange(frameSlot, range, inheritance, itemCount, record);
+    });
+    return {commandBuffers_.data() + frameSlot * threadCount_, threadCount_};
+}
+
+void ParallelRecorder::RecordRange(uint32_t frameSlot,
+                                   uint32_t range,
+                                   const VkCommandBufferInheritanceInfo &inheritance,
+                                   uint32_t itemCount,
+                                   const RecordFunction &record)
+{
+    GDF_PROFILE_ZONE("Record Secondary");
+    size_t index = frameSlot * threadCount_ + range;
+    VK_ASSERT_SUCCESSED(vkResetCommandPool(*device_, commandPools_[index], 0));
+
+    VkCommandBufferBeginInfo beginInfo{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+        .pInheritanceInfo = &inheritance,
+    };
+    VK_ASSERT_SUCCESSED(vkBeginCommandBuffer(commandBuffers_[index], &beginInfo));
+    // contiguous ranges, an empty one still leaves a valid empty secondary
+    uint32_t first = static_cast<uint32_t>(uint64_t{itemCount} * range / threadCount_);
+    uint32_t last = static_cast<uint32_t>(uint64_t{itemCount} * (range + 1) / threadCount_);
+    if (first < last)
+        record(commandBuffers_[index], first, last);
+    VK_ASSERT_SUCCESSED(vkEndCommandBuffer(commandBuffers_[index]));
+}
+
+} // namespace gdf
@@ -0,0 +1,338 @@
+#include "Graphics/StagingRing.h"
+#include "Graphics/VulkanDevice.h"
+#include <cstring>
+
+namespace gdf
+{
+
+namespace
+{
+// everything a freshly uploaded resource may be read as
+constexpr VkAccessFlags kBufferReadAccess = VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT |
+                                            VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+constexpr VkPipelineStageFlags kReadStages =
+    VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+} // namespace
+
+void StagingRing::Create(
+    VulkanDevice *device, VkQueue queue, uint32_t queueFamilyIndex, uint32_t ownerQueueFamilyIndex, VkDeviceSize size)
+{
+    device_ = device;
+    queue_ = queue;
+    queueFamilyIndex_ = queueFamilyIndex;
+    ownerQueueFamilyIndex_ = ownerQueueFamilyIndex == UINT32_MAX ? queueFamilyIndex : ownerQueueFamilyIndex;
+    size_ = size;
+    head_ = 0;
+    tail_ = 0;
+
+    auto bufferCI = GraphicsTools::MakeBufferCreateInfo(size_, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_SHARING_MODE_EXCLUSIVE);
+    VK_ASSERT_SUCCESSED(vkCreateBuffer(*device_, &bufferCI, nullptr, &buffer_));
+    VkMemoryRequirements memoryReqs;
+    vkGetBufferMemoryRequirements(*device_, buffer_, &memoryReqs);
+    allocation_ = device_->memoryAllocator.Allocate(
+        memoryReqs,
+        device_->FindMemoryType(memoryReqs.memoryTypeBits,
+                                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT),
+        DeviceResourceKind::Linear,
+        true);
+    VK_ASSERT_SUCCESSED(vkBindBufferMemory(*device_, buffer_, allocation_.memory, allocation_.offset));
+
+    VkCommandPoolCreateInfo commandPoolCI{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+        .queueFamilyIndex = queueFamilyIndex,
+    };
+    VK_ASSERT_SUCCESSED(vkCreateCommandPool(*device_, &commandPoolCI, nullptr, &commandPool_));
+    VkFenceCreateInfo fenceCI{
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+    };
+    for (auto &batch : batches_) {
+        VkCommandBufferAllocateInfo commandBufferAI{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .commandPool = commandPool_,
+            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1,
+        };
+        VK_ASSERT_SUCCESSED(vkAllocateCommandBuffers(*device_, &commandBufferAI, &batch.commandBuffer));
+        VK_ASSERT_SUCCESSED(vkCreateFence(*device_, &fenceCI, nullptr, &batch.fence));
+    }
+    current_ = 0;
+    oldest_ = 0;
+    submittedSerial_ = 0;
+    retiredSerial_ = 0;
+    completedSerial_ = 0;
+}
+
+void StagingRing::Destroy()
+{
+    Flush();
+    for (auto &batch : batches_) {
+        vkDestroyFence(*device_, batch.fence, nullptr);
+        batch = Batch{};
+    }
+    bufferAcquires_.clear();
+    imageAcquires_.clear();
+    vkDestroyCommandPool(*device_, commandPool_, nullptr);
+    vkDestroyBuffer(*device_, buffer_, nullptr);
+    device_->memoryAllocator.Free(allocation_);
+    commandPool_ = VK_NULL_HANDLE;
+    buffer_ = VK_NULL_HANDLE;
+}
+
+StagingRing::Region StagingRing::Allocate(VkDeviceSize size, VkDeviceSize alignment)
+{
+    if (size > size_)
+        THROW_EXCEPT("Staging upload larger than the staging ring!");
+    VkDeviceSize start = (head_ + alignment - 1) & ~(alignment - 1);
+    // a region never wraps around the end of the buffer, skip to the start instead
+    if (start % size_ + size > size_)
+        start = (start / size_ + 1) * size_;
+    while (start + size - tail_ > size_) {
+        // nothing in use, the wasted space before start does not matter
+        if (tail_ == head_) {
+            tail_ = start;
+            break;
+        }
+        // the batch being recorded may hold the space we wait for, it has to go first
+        if (batches_[current_].recording) {
+            Submit();
+            continue;
+        }
+        if (!batches_[oldest_].pending)
+            THROW_EXCEPT("Staging ring exhausted without batches in flight!");
+        Retire(true);
+    }
+    head_ = start + size;
+    Region region;
+    region.buffer = buffer_;
+    region.offset = start % size_;
+    region.mapped = static_cast<char *>(allocation_.mapped) + region.offset;
+    return region;
+}
+
+VkCommandBuffer StagingRing::commandBuffer()
+{
+    Batch &batch = batches_[current_];
+    if (!batch.recording) {
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        VK_ASSERT_SUCCESSED(vkBeginCommandBuffer(batch.commandBuffer, &beginInfo));
+        batch.recording = true;
+    }
+    return batch.commandBuffer;
+}
+
+void StagingRing::UploadBuffer(VkBuffer buffer, VkDeviceSize offset, const void *data, VkDeviceSize size)
+{
+    Region region = Allocate(size);
+    std::memcpy(region.mapped, data, static_cast<size_t>(size));
+    VkCommandBuffer commands = commandBuffer();
+    VkBufferCopy copy{
+        .srcOffset = region.offset,
+        .dstOffset = offset,
+        .size = size,
+    };
+    vkCmdCopyBuffer(commands, buffer_, buffer, 1, &copy);
+
+    VkBufferMemoryBarrier barrier{
+        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = kBufferReadAccess,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .buffer = buffer,
+        .offset = offset,
+        .size = size,
+    };
+    if (transfersOwnership()) {
+        // release half of the ownership transfer, the acquire half carries the access masks of the owner
+        barrier.dstAccessMask = 0;
+        barrier.srcQueueFamilyIndex = queueFamilyIndex_;
+        barrier.dstQueueFamilyIndex = ownerQueueFamilyIndex_;
+        vkCmdPipelineBarrier(commands,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                             0,
+                             0,
+                             nullptr,
+                             1,
+                             &barrier,
+                             0,
+                             nullptr);
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = kBufferReadAccess;
+        batches_[current_].bufferAcquires.push_back(barrier);
+    } else {
+        vkCmdPipelineBarrier(
+            commands, VK_PIPELINE_STAGE_TRANSFER_BIT, kReadStages, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+    }
+}
+
+void StagingRing::UploadImage(
+    VkImage image, uint32_t width, uint32_t height, const void *data, VkDeviceSize size, VkImageLayout finalLayout)
+{
+    Region region = Allocate(size);
+    std::memcpy(region.mapped, data, static_cast<size_t>(size));
+    VkCommandBuffer commands = commandBuffer();
+
+    VkImageMemoryBarrier barrier{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .srcAccessMask = 0,
+        .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+        .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = image,
+        .subresourceRange =
+            {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .baseMipLevel = 0,
+                .levelCount = 1,
+                .baseArrayLayer = 0,
+                .layerCount = 1,
+            },
+    };
+    vkCmdPipelineBarrier(
+        commands, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy copy{
+        .bufferOffset = region.offset,
+        .bufferRowLength = 0,
+        .bufferImageHeight = 0,
+        .imageSubresource =
+            {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .mipLevel = 0,
+                .baseArrayLayer = 0,
+                .layerCount = 1,
+            },
+        .imageOffset = {0, 0, 0},
+        .imageExtent = {width, height, 1},
+    };
+    vkCmdCopyBufferToImage(commands, buffer_, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy);
+
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = finalLayout;
+    if (transfersOwnership()) {
+        // a transfer-only queue can't name the shader stages, the owner's acquire does
+        barrier.dstAccessMask = 0;
+        barrier.srcQueueFamilyIndex = queueFamilyIndex_;
+        barrier.dstQueueFamilyIndex = ownerQueueFamilyIndex_;
+        vkCmdPipelineBarrier(commands,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                             0,
+                             0,
+                             nullptr,
+                             0,
+                             nullptr,
+                             1,
+                             &barrier);
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        batches_[current_].imageAcquires.push_back(barrier);
+    } else {
+        vkCmdPipelineBarrier(commands,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             0,
+                             0,
+                             nullptr,
+                             0,
+                             nullptr,
+                             1,
+                             &barrier);
+    }
+}
+
+uint64_t StagingRing::Submit()
+{
+    Batch &batch = batches_[current_];
+    if (!batch.recording)
+        return submittedSerial_;
+    VK_ASSERT_SUCCESSED(vkEndCommandBuffer(batch.commandBuffer));
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &batch.commandBuffer;
+    VK_ASSERT_SUCCESSED(vkQueueSubmit(queue_, 1, &submitInfo, batch.fence));
+    batch.recording = false;
+    batch.pending = true;
+    batch.end = head_;
+    batch.serial = ++submittedSerial_;
+
+    current_ = (current_ + 1) % kBatchCount;
+    // the next batch slot is reused, so its previous submission has to be finished
+    while (batches_[current_].pending)
+        Retire(true);
+    Retire(false);
+    return batch.serial;
+}
+
+void StagingRing::Flush()
+{
+    Submit();
+    while (batches_[oldest_].pending)
+        Retire(true);
+}
+
+bool StagingRing::IsComplete(uint64_t serial)
+{
+    Retire(false);
+    return serial <= completedSerial_;
+}
+
+void StagingRing::RecordAcquires(VkCommandBuffer ownerCommandBuffer)
+{
+    Retire(false);
+    if (!bufferAcquires_.empty() || !imageAcquires_.empty()) {
+        vkCmdPipelineBarrier(ownerCommandBuffer,
+                             VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                             kReadStages,
+                             0,
+                             0,
+                             nullptr,
+                             static_cast<uint32_t>(bufferAcquires_.size()),
+                             bufferAcquires_.data(),
+                             static_cast<uint32_t>(imageAcquires_.size()),
+                             imageAcquires_.data());
+        bufferAcquires_.clear();
+        imageAcquires_.clear();
+    }
+    completedSerial_ = retiredSerial_;
+}
+
+void StagingRing::Retire(bool wait)
+{
+    // batches finish in submission order, retire from the oldest and stop at the first one still running
+    do {
+        Batch &batch = batches_[oldest_];
+        if (!batch.pending)
+            return;
+        if (wait) {
+            VK_ASSERT_SUCCESSED(vkWaitForFences(*device_, 1, &batch.fence, VK_TRUE, UINT64_MAX));
+        } else if (vkGetFenceStatus(*device_, batch.fence) != VK_SUCCESS) {
+            return;
+        }
+        VK_ASSERT_SUCCESSED(vkResetFences(*device_, 1, &batch.fence));
+        VK_ASSERT_SUCCESSED(vkResetCommandBuffer(batch.commandBuffer, 0));
+        batch.pending = false;
+        tail_ = batch.end;
+        retiredSerial_ = batch.serial;
+        if (transfersOwnership()) {
+            bufferAcquires_.insert(bufferAcquires_.end(), batch.bufferAcquires.begin(), batch.bufferAcquires.end());
+            imageAcquires_.insert(imageAcquires_.end(), batch.imageAcquires.begin(), batch.imageAcquires.end());
+            batch.bufferAcquires.clear();
+            batch.imageAcquires.clear();
+        } else {
+            completedSerial_ = retiredSerial_;
+        }
+        oldest_ = (oldest_ + 1) % kBatchCount;
+    } while (!wait);
+}
+
+} // namespace gdf
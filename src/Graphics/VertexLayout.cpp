@@ -0,0 +1,246 @@
+#include "Graphics/VertexLayout.h"
+#include "Graphics/Graphics.h"
+#include "Log/Logger.h"
+#include <cmath>
+#include <cstring>
+#include <glm/gtc/packing.hpp>
+#include <glm/packing.hpp>
+
+namespace gdf
+{
+
+namespace
+{
+constexpr uint32_t kComponentCounts[kVertexComponentCount] = {3, 3, 2, 4, 4, 4, 4};
+constexpr float kZero[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+constexpr float kOne[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+
+struct FormatInfo {
+    VkFormat vkFormat;
+    uint32_t size;
+};
+
+FormatInfo FormatInfoOf(Vertex::Component component, VertexFormat format)
+{
+    uint32_t count = VertexLayout::ComponentCount(component);
+    switch (format) {
+    case VertexFormat::Unorm16:
+        return {VK_FORMAT_R16G16B16A16_UNORM, 8};
+    case VertexFormat::Octahedral16:
+        if (component == Vertex::Component::Tangent)
+            return {VK_FORMAT_R16G16B16A16_SNORM, 8};
+        return {VK_FORMAT_R16G16_SNORM, 4};
+    case VertexFormat::Half:
+        if (count == 2)
+            return {VK_FORMAT_R16G16_SFLOAT, 4};
+        return {VK_FORMAT_R16G16B16A16_SFLOAT, 8};
+    case VertexFormat::Unorm8:
+        return {VK_FORMAT_R8G8B8A8_UNORM, 4};
+    case VertexFormat::Uint8:
+        return {VK_FORMAT_R8G8B8A8_UINT, 4};
+    case VertexFormat::Uint16:
+        return {VK_FORMAT_R16G16B16A16_UINT, 8};
+    default:
+        if (count == 2)
+            return {VK_FORMAT_R32G32_SFLOAT, 8};
+        if (count == 3)
+            return {VK_FORMAT_R32G32B32_SFLOAT, 12};
+        return {VK_FORMAT_R32G32B32A32_SFLOAT, 16};
+    }
+}
+
+// the first count floats of value, the rest 0
+glm::vec4 Widen(const float *value, uint32_t count)
+{
+    glm::vec4 result(0.0f);
+    for (uint32_t c = 0; c < count; c++)
+        result[c] = value[c];
+    return result;
+}
+
+// Maps a unit vector onto the octahedron and unfolds its lower half into the corners of [-1, 1]^2
+glm::vec2 OctahedralEncode(const glm::vec3 &vector)
+{
+    float sum = std::abs(vector.x) + std::abs(vector.y) + std::abs(vector.z);
+    if (sum == 0.0f)
+        return glm::vec2(0.0f);
+    glm::vec2 encoded = glm::vec2(vector.x, vector.y) / sum;
+    if (vector.z < 0.0f) {
+        glm::vec2 signs(encoded.x >= 0.0f ? 1.0f : -1.0f, encoded.y >= 0.0f ? 1.0f : -1.0f);
+        encoded = (1.0f - glm::abs(glm::vec2(encoded.y, encoded.x))) * signs;
+    }
+    return encoded;
+}
+
+template <typename T>
+void Store(uint8_t *destination, const T &value)
+{
+    std::memcpy(destination, &value, sizeof(T));
+}
+} // namespace
+
+uint32_t VertexLayout::ComponentCount(Vertex::Component component)
+{
+    return kComponentCounts[static_cast<uint32_t>(component)];
+}
+
+const float *VertexLayout::DefaultValue(Vertex::Component component)
+{
+    return component == Vertex::Component::Color ? kOne : kZero;
+}
+
+bool VertexLayout::FormatFits(Vertex::Component component, VertexFormat format)
+{
+    switch (format) {
+    case VertexFormat::Float:
+        return true;
+    case VertexFormat::Unorm16:
+        return component == Vertex::Component::Position;
+    case VertexFormat::Octahedral16:
+        return component == Vertex::Component::Normal || component == Vertex::Component::Tangent;
+    case VertexFormat::Half:
+        return component == Vertex::Component::UV || component == Vertex::Component::Color ||
+               component == Vertex::Component::Weight0;
+    case VertexFormat::Unorm8:
+        return component == Vertex::Component::Color || component == Vertex::Component::Weight0;
+    case VertexFormat::Uint8:
+    case VertexFormat::Uint16:
+        return component == Vertex::Component::Joint0;
+    }
+    return false;
+}
+
+VertexLayout::VertexLayout(uint32_t components, const VertexFormats &formats) : components_(components)
+{
+    // in Vertex order, every size is a multiple of 4 so every attribute stays aligned
+    for (uint32_t i = 0; i < kVertexComponentCount; i++) {
+        Vertex::Component component = static_cast<Vertex::Component>(i);
+        if ((components & ComponentBit(component)) == 0)
+            continue;
+        VertexFormat format = formats[i];
+        if (!FormatFits(component, format)) {
+            GDF_LOG(GraphicsLog,
+                    LogLevel::Warning,
+                    "Vertex format {} can't store component {}, using floats",
+                    static_cast<uint32_t>(format),
+                    i);
+            format = VertexFormat::Float;
+        }
+        FormatInfo info = FormatInfoOf(component, format);
+        attributes_.push_back(Attribute{
+            .component = component,
+            .format = format,
+            .vkFormat = info.vkFormat,
+            .offset = stride_,
+            .size = info.size,
+        });
+        stride_ += info.size;
+    }
+}
+
+const VertexLayout::Attribute *VertexLayout::Find(Vertex::Component component) const
+{
+    for (const Attribute &attribute : attributes_) {
+        if (attribute.component == component)
+            return &attribute;
+    }
+    return nullptr;
+}
+
+void VertexLayout::Encode(const Attribute &attribute,
+                          const float *values,
+                          uint32_t count,
+                          const glm::vec3 &min,
+                          const glm::vec3 &size,
+                          uint8_t *vertices) const
+{
+    uint32_t valueCount = ComponentCount(attribute.component);
+    auto encodeEach = [&](auto &&encode) {
+        for (uint32_t i = 0; i < count; i++)
+            encode(values + i * valueCount, vertices + static_cast<size_t>(stride_) * i + attribute.offset);
+    };
+    switch (attribute.format) {
+    case VertexFormat::Float:
+        encodeEach([&](const float *value, uint8_t *destination) {
+            std::memcpy(destination, value, valueCount * sizeof(float));
+        });
+        break;
+    case VertexFormat::Unorm16: {
+        // a flat primitive has no extent on some axis, its positions there are all min
+        glm::vec3 scale(size.x > 0.0f ? 1.0f / size.x : 0.0f,
+                        size.y > 0.0f ? 1.0f / size.y : 0.0f,
+                        size.z > 0.0f ? 1.0f / size.z : 0.0f);
+        encodeEach([&](const float *value, uint8_t *destination) {
+            glm::vec3 relative = (glm::vec3(value[0], value[1], value[2]) - min) * scale;
+            Store(destination, glm::packUnorm4x16(glm::vec4(relative, 0.0f)));
+        });
+        break;
+    }
+    case VertexFormat::Octahedral16:
+        if (attribute.component == Vertex::Component::Tangent) {
+            encodeEach([&](const float *value, uint8_t *destination) {
+                glm::vec2 encoded = OctahedralEncode(glm::vec3(value[0], value[1], value[2]));
+                float handedness = value[3] < 0.0f ? -1.0f : 1.0f;
+                Store(destination, glm::packSnorm4x16(glm::vec4(encoded, handedness, 0.0f)));
+            });
+        } else {
+            encodeEach([&](const float *value, uint8_t *destination) {
+                Store(destination, glm::packSnorm2x16(OctahedralEncode(glm::vec3(value[0], value[1], value[2]))));
+            });
+        }
+        break;
+    case VertexFormat::Half:
+        if (valueCount == 2) {
+            encodeEach([&](const float *value, uint8_t *destination) {
+                Store(destination, glm::packHalf2x16(glm::vec2(value[0], value[1])));
+            });
+        } else {
+            encodeEach([&](const float *value, uint8_t *destination) {
+                Store(destination, glm::packHalf4x16(Widen(value, valueCount)));
+            });
+        }
+        break;
+    case VertexFormat::Unorm8:
+        encodeEach([&](const float *value, uint8_t *destination) {
+            Store(destination, glm::packUnorm4x8(Widen(value, valueCount)));
+        });
+        break;
+    case VertexFormat::Uint8:
+        encodeEach([&](const float *value, uint8_t *destination) {
+            for (uint32_t c = 0; c < 4; c++)
+                destination[c] = static_cast<uint8_t>(glm::clamp(value[c], 0.0f, 255.0f));
+        });
+        break;
+    case VertexFormat::Uint16:
+        encodeEach([&](const float *value, uint8_t *destination) {
+            for (uint32_t c = 0; c < 4; c++)
+                Store(destination + c * sizeof(uint16_t), static_cast<uint16_t>(glm::clamp(value[c], 0.0f, 65535.0f)));
+        });
+        break;
+    }
+}
+
+VkVertexInputBindingDescription VertexLayout::BindingDescription(uint32_t binding) const
+{
+    return VkVertexInputBindingDescription{
+        .binding = binding,
+        .stride = stride_,
+        .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+    };
+}
+
+std::vector<VkVertexInputAttributeDescription> VertexLayout::AttributeDescriptions(uint32_t binding) const
+{
+    std::vector<VkVertexInputAttributeDescription> descriptions;
+    for (const Attribute &attribute : attributes_) {
+        descriptions.push_back(VkVertexInputAttributeDescription{
+            .location = static_cast<uint32_t>(attribute.component),
+            .binding = binding,
+            .format = attribute.vkFormat,
+            .offset = attribute.offset,
+        });
+    }
+    return descriptions;
+}
+
+} // namespace gdf
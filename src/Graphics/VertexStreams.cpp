@@ -0,0 +1,64 @@
+#include "Graphics/VertexStreams.h"
+#include "Graphics/AccessorDecode.h"
+
+namespace gdf
+{
+
+VertexStreams::VertexStreams(uint32_t components, uint32_t vertexCount)
+    : components_(components), vertexCount_(vertexCount)
+{
+    constexpr size_t blockFloats = kAlignment / sizeof(float);
+    size_t floats = 0;
+    for (uint32_t i = 0; i < kVertexComponentCount; i++) {
+        Vertex::Component component = static_cast<Vertex::Component>(i);
+        if ((components & VertexLayout::ComponentBit(component)) == 0)
+            continue;
+        offsets_[i] = floats;
+        // the next stream starts on the next block
+        size_t streamFloats = static_cast<size_t>(vertexCount) * VertexLayout::ComponentCount(component);
+        floats += (streamFloats + blockFloats - 1) / blockFloats * blockFloats;
+    }
+    blocks_.resize(floats / blockFloats);
+}
+
+float *VertexStreams::Stream(Vertex::Component component)
+{
+    if ((components_ & VertexLayout::ComponentBit(component)) == 0 || blocks_.empty())
+        return nullptr;
+    return blocks_.data()->values + offsets_[static_cast<uint32_t>(component)];
+}
+
+const float *VertexStreams::Stream(Vertex::Component component) const
+{
+    return const_cast<VertexStreams *>(this)->Stream(component);
+}
+
+void VertexStreams::Interleave(const VertexLayout &layout,
+                               uint32_t first,
+                               uint32_t count,
+                               const glm::vec3 &min,
+                               const glm::vec3 &size,
+                               uint8_t *vertexData) const
+{
+    uint8_t *vertices = vertexData + static_cast<size_t>(layout.stride()) * first;
+    for (const VertexLayout::Attribute &attribute : layout.attributes()) {
+        const float *stream = Stream(attribute.component);
+        assert(stream != nullptr);
+        uint32_t valueCount = VertexLayout::ComponentCount(attribute.component);
+        const float *values = stream + static_cast<size_t>(first) * valueCount;
+        if (attribute.format != VertexFormat::Float) {
+            layout.Encode(attribute, values, count, min, size, vertices);
+            continue;
+        }
+        // a float stream is an accessor like any other, the kernels scatter it into the vertices
+        AccessorStream source{
+            .data = reinterpret_cast<const uint8_t *>(values),
+            .stride = valueCount * sizeof(float),
+            .componentType = kComponentFloat,
+            .componentCount = valueCount,
+        };
+        DecodeAccessor(source, reinterpret_cast<float *>(vertices + attribute.offset), layout.stride(), valueCount, count);
+    }
+}
+
+} // namespace gdf
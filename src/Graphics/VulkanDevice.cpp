@@ -1,7 +1,9 @@
 #include "Graphics/VulkanDevice.h"
 #include "Base/File.h"
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <cstring>
 #include <vector>
 namespace gdf
 {
@@ -161,6 +163,20 @@ void VulkanDevice::CreateLogicalDevice(VkPhysicalDeviceFeatures enabledFeatures,
         enableDebugMarkers = true;
     }
 
+    // Frame tracking uses a timeline semaphore when there is one, the extension depends on the instance's
+    // VK_KHR_get_physical_device_properties2 and every device exposing it supports the feature
+    bool hasProperties2 = std::find_if(instanceExtensions.begin(), instanceExtensions.end(), [](const char *extensionName) {
+                              return !strcmp(extensionName, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+                          }) != instanceExtensions.end();
+    VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineSemaphoreFeatures{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR,
+        .timelineSemaphore = VK_TRUE,
+    };
+    if (hasProperties2 && ExtensionSupported(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME)) {
+        deviceExtensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+        enableTimelineSemaphore = true;
+    }
+
 #ifdef __APPLE__
     instanceExtensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
     if ((std::find_if(instanceExtensions.begin(),
@@ -184,6 +200,7 @@ void VulkanDevice::CreateLogicalDevice(VkPhysicalDeviceFeatures enabledFeatures,
 
     VkDeviceCreateInfo deviceCI = {
         .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+        .pNext = enableTimelineSemaphore ? &timelineSemaphoreFeatures : nullptr,
         .queueCreateInfoCount = static_cast<uint32_t>(deviceQueueCIs.size()),
         .pQueueCreateInfos = deviceQueueCIs.data(),
         .enabledLayerCount = static_cast<uint32_t>(0),
@@ -194,6 +211,7 @@ void VulkanDevice::CreateLogicalDevice(VkPhysicalDeviceFeatures enabledFeatures,
     };
 
     VK_ASSERT_SUCCESSED(vkCreateDevice(physicalDevice, &deviceCI, nullptr, &logicalDevice));
+    memoryAllocator.Initialize(logicalDevice, memoryProperties, properties.limits.bufferImageGranularity);
     std::vector<uint32_t> allIndices{
         queueFamilyIndices.graphics, queueFamilyIndices.compute, queueFamilyIndices.transfer, queueFamilyIndices.present};
     std::vector<VkQueue *> queues{&graphicsQueue_, &computeQueue_, &transferQueue_, &presentQueue_};
@@ -224,7 +242,7 @@ void VulkanDevice::CreateImage(uint32_t width,
                                VkImageUsageFlags usage,
                                VkMemoryPropertyFlags properties,
                                VkImage &image,
-                               VkDeviceMemory &imageMemory)
+                               DeviceAllocation &imageAllocation)
 {
     VkImageCreateInfo imageCI{
         .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
@@ -252,13 +270,11 @@ void VulkanDevice::CreateImage(uint32_t width,
     VkMemoryRequirements memRequirements;
     vkGetImageMemoryRequirements(logicalDevice, image, &memRequirements);
 
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = FindMemoryType(memRequirements.memoryTypeBits, properties);
-
-    VK_ASSERT_SUCCESSED(vkAllocateMemory(logicalDevice, &allocInfo, nullptr, &imageMemory))
-    VK_ASSERT_SUCCESSED(vkBindImageMemory(logicalDevice, image, imageMemory, 0));
+    imageAllocation = memoryAllocator.Allocate(memRequirements,
+                                               FindMemoryType(memRequirements.memoryTypeBits, properties),
+                                               tiling == VK_IMAGE_TILING_OPTIMAL ? DeviceResourceKind::Optimal
+                                                                                 : DeviceResourceKind::Linear);
+    VK_ASSERT_SUCCESSED(vkBindImageMemory(logicalDevice, image, imageAllocation.memory, imageAllocation.offset));
 }
 
 VkImageView VulkanDevice::CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags)
@@ -0,0 +1,160 @@
+#include "Log/BinaryLog.h"
+#include "Log/Logger.h"
+#include <cstring>
+#include <fmt/core.h>
+#include <vector>
+
+namespace gdf
+{
+
+namespace
+{
+constexpr char kBinaryLogMagic[8] = {'G', 'D', 'F', 'B', 'L', 'O', 'G', '1'};
+
+template <typename T>
+void WriteValue(std::ofstream &file, const T &value)
+{
+    file.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T>
+bool ReadValue(std::istream &in, T &value)
+{
+    return static_cast<bool>(in.read(reinterpret_cast<char *>(&value), sizeof(T)));
+}
+} // namespace
+
+BinaryFileSink::BinaryFileSink(const std::string &path) : file_(path, std::ios::binary | std::ios::trunc)
+{
+    if (file_.is_open())
+        file_.write(kBinaryLogMagic, sizeof(kBinaryLogMagic));
+}
+
+void BinaryFileSink::Log(const LogCategory *category, const LogLevel level, const std::string_view message)
+{
+    uint32_t categoryId = CategoryId(category);
+    file_.put('T');
+    WriteValue(file_, categoryId);
+    WriteValue(file_, level);
+    WriteValue(file_, static_cast<uint32_t>(message.size()));
+    file_.write(message.data(), message.size());
+}
+
+bool BinaryFileSink::LogDeferred(const LogCategory *category, const LogLevel level, const char *format, const LogArgBuffer &args)
+{
+    uint32_t categoryId = CategoryId(category);
+    uint32_t formatId = FormatId(format);
+    file_.put('R');
+    WriteValue(file_, categoryId);
+    WriteValue(file_, level);
+    WriteValue(file_, formatId);
+    WriteValue(file_, args.size);
+    file_.write(reinterpret_cast<const char *>(args.data), args.size);
+    return true;
+}
+
+void BinaryFileSink::Exception()
+{
+    file_.flush();
+}
+
+uint32_t BinaryFileSink::CategoryId(const LogCategory *category)
+{
+    auto searchIt = categoryIds_.find(category);
+    if (searchIt != categoryIds_.end())
+        return searchIt->second;
+    uint32_t categoryId = static_cast<uint32_t>(categoryIds_.size());
+    categoryIds_.emplace(category, categoryId);
+    file_.put('C');
+    WriteValue(file_, categoryId);
+    WriteValue(file_, static_cast<uint16_t>(category->displayName_.size()));
+    file_.write(category->displayName_.data(), category->displayName_.size());
+    return categoryId;
+}
+
+uint32_t BinaryFileSink::FormatId(const char *format)
+{
+    auto searchIt = formatIds_.find(format);
+    if (searchIt != formatIds_.end())
+        return searchIt->second;
+    uint32_t formatId = static_cast<uint32_t>(formatIds_.size());
+    formatIds_.emplace(format, formatId);
+    uint32_t size = static_cast<uint32_t>(std::strlen(format));
+    file_.put('F');
+    WriteValue(file_, formatId);
+    WriteValue(file_, size);
+    file_.write(format, size);
+    return formatId;
+}
+
+bool DecodeBinaryLog(std::istream &in, std::ostream &out)
+{
+    char magic[sizeof(kBinaryLogMagic)];
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, kBinaryLogMagic, sizeof(magic)) != 0)
+        return false;
+    std::vector<std::string> categories;
+    std::vector<std::string> formats;
+    std::string text;
+    std::vector<std::byte> args;
+    char tag;
+    while (in.get(tag)) {
+        uint32_t id;
+        if (!ReadValue(in, id))
+            return false;
+        switch (tag) {
+        case 'C': {
+            uint16_t size;
+            if (!ReadValue(in, size) || id != categories.size())
+                return false;
+            std::string name(size, '\0');
+            if (!in.read(name.data(), size))
+                return false;
+            categories.push_back(std::move(name));
+            break;
+        }
+        case 'F': {
+            uint32_t size;
+            if (!ReadValue(in, size) || id != formats.size())
+                return false;
+            std::string format(size, '\0');
+            if (!in.read(format.data(), size))
+                return false;
+            formats.push_back(std::move(format));
+            break;
+        }
+        case 'R': {
+            LogLevel level;
+            uint32_t formatId;
+            uint16_t size;
+            if (!ReadValue(in, level) || !ReadValue(in, formatId) || !ReadValue(in, size))
+                return false;
+            if (id >= categories.size() || formatId >= formats.size())
+                return false;
+            args.resize(size);
+            if (!in.read(reinterpret_cast<char *>(args.data()), size))
+                return false;
+            out << fmt::format("[{:s}][{:s}] {:s}\n",
+                               categories[id],
+                               std::to_string(level),
+                               FormatLogArgs(formats[formatId], args.data(), args.size()));
+            break;
+        }
+        case 'T': {
+            LogLevel level;
+            uint32_t size;
+            if (!ReadValue(in, level) || !ReadValue(in, size) || id >= categories.size())
+                return false;
+            text.resize(size);
+            if (!in.read(text.data(), size))
+                return false;
+            out << fmt::format("[{:s}][{:s}] {:s}\n", categories[id], std::to_string(level), text);
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace gdf
@@ -0,0 +1,82 @@
+#include "Log/FileSink.h"
+#include "Log/Logger.h"
+#include <algorithm>
+#include <filesystem>
+#include <fmt/format.h>
+#include <iostream>
+
+namespace gdf
+{
+
+FileSink::FileSink(const std::string &path, size_t maxFileSize, std::chrono::seconds rotationInterval, size_t maxBackups)
+    : path_(path), maxFileSize_(maxFileSize), rotationInterval_(rotationInterval), maxBackups_(maxBackups)
+{
+    Open();
+}
+
+FileSink::~FileSink()
+{
+    if (file_.isOpen())
+        Close();
+}
+
+void FileSink::Log(const LogCategory *category, const LogLevel level, const std::string_view message)
+{
+    if (!file_.isOpen())
+        return;
+    if (rotationInterval_ > std::chrono::seconds::zero() && used_ > 0 &&
+        std::chrono::steady_clock::now() - openedAt_ >= rotationInterval_) {
+        Rotate();
+        if (!file_.isOpen())
+            return;
+    }
+    // level names fit in the small string buffer, nothing here touches the heap
+    std::string levelName = std::to_string(level);
+    auto result = fmt::format_to_n(
+        file_.data() + used_, file_.size() - used_, "[{:s}][{:s}] {:s}\n", category->displayName_, levelName, message);
+    if (result.size > file_.size() - used_ && used_ > 0) {
+        Rotate();
+        if (!file_.isOpen())
+            return;
+        result = fmt::format_to_n(
+            file_.data(), file_.size(), "[{:s}][{:s}] {:s}\n", category->displayName_, levelName, message);
+    }
+    // a single record larger than the whole file is cut at the end of the file
+    used_ += std::min(result.size, file_.size() - used_);
+}
+
+void FileSink::Exception()
+{
+    if (file_.isOpen())
+        file_.Sync();
+}
+
+void FileSink::Open()
+{
+    if (!file_.Open(path_, maxFileSize_))
+        std::cerr << fmt::format("FileSink: couldn't create {} with {} bytes\n", path_, maxFileSize_);
+    openedAt_ = std::chrono::steady_clock::now();
+}
+
+void FileSink::Close()
+{
+    // the file is closed either way, only its unused tail is left behind
+    if (!file_.Close(used_))
+        std::cerr << fmt::format("FileSink: couldn't truncate {} to {} bytes\n", path_, used_);
+    used_ = 0;
+}
+
+void FileSink::Rotate()
+{
+    Close();
+    std::error_code error;
+    if (maxBackups_ > 0) {
+        std::filesystem::remove(fmt::format("{}.{}", path_, maxBackups_), error);
+        for (size_t i = maxBackups_ - 1; i > 0; i--)
+            std::filesystem::rename(fmt::format("{}.{}", path_, i), fmt::format("{}.{}", path_, i + 1), error);
+        std::filesystem::rename(path_, path_ + ".1", error);
+    }
+    Open();
+}
+
+} // namespace gdf
@@ -0,0 +1,98 @@
+#include "Log/LogArgs.h"
+#include <fmt/format.h>
+#if __has_include(<fmt/args.h>)
+#include <fmt/args.h>
+#endif
+
+namespace gdf
+{
+
+namespace
+{
+// false when the record ends before the value does
+template <typename T>
+bool ReadLogArg(const std::byte *&cursor, const std::byte *end, T &value)
+{
+    if (static_cast<size_t>(end - cursor) < sizeof(T))
+        return false;
+    std::memcpy(&value, cursor, sizeof(T));
+    cursor += sizeof(T);
+    return true;
+}
+
+template <typename T>
+bool PushLogArg(fmt::dynamic_format_arg_store<fmt::format_context> &store, const std::byte *&cursor, const std::byte *end)
+{
+    T value;
+    if (!ReadLogArg(cursor, end, value))
+        return false;
+    store.push_back(value);
+    return true;
+}
+
+std::string CorruptedLogArgs(std::string_view format)
+{
+    return fmt::format("<corrupted log arguments for \"{}\">", format);
+}
+} // namespace
+
+std::string FormatLogArgs(std::string_view format, const std::byte *data, size_t size)
+{
+    fmt::dynamic_format_arg_store<fmt::format_context> store;
+    const std::byte *cursor = data;
+    const std::byte *end = data + size;
+    while (cursor < end) {
+        auto type = static_cast<LogArgType>(*cursor++);
+        bool read = false;
+        switch (type) {
+        case LogArgType::Bool:
+            read = PushLogArg<bool>(store, cursor, end);
+            break;
+        case LogArgType::Char:
+            read = PushLogArg<char>(store, cursor, end);
+            break;
+        case LogArgType::Int32:
+            read = PushLogArg<int32_t>(store, cursor, end);
+            break;
+        case LogArgType::UInt32:
+            read = PushLogArg<uint32_t>(store, cursor, end);
+            break;
+        case LogArgType::Int64:
+            read = PushLogArg<int64_t>(store, cursor, end);
+            break;
+        case LogArgType::UInt64:
+            read = PushLogArg<uint64_t>(store, cursor, end);
+            break;
+        case LogArgType::Float:
+            read = PushLogArg<float>(store, cursor, end);
+            break;
+        case LogArgType::Double:
+            read = PushLogArg<double>(store, cursor, end);
+            break;
+        case LogArgType::String: {
+            uint16_t length;
+            if (!ReadLogArg(cursor, end, length) || static_cast<size_t>(end - cursor) < length)
+                break;
+            store.push_back(std::string_view(reinterpret_cast<const char *>(cursor), length));
+            cursor += length;
+            read = true;
+            break;
+        }
+        case LogArgType::Pointer:
+            read = PushLogArg<const void *>(store, cursor, end);
+            break;
+        default:
+            break;
+        }
+        if (!read)
+            return CorruptedLogArgs(format);
+    }
+    // the record may come from a file, its arguments need not match the format
+    try {
+        return fmt::vformat(format, store);
+    } catch (const fmt::format_error &) {
+        return CorruptedLogArgs(format);
+    }
+}
+
+} // namespace gdf
@@ -1,4 +1,5 @@
 #include "Log/Logger.h"
+#include <chrono>
 #include <mutex>
 namespace std
 {
@@ -25,6 +26,69 @@ namespace gdf
 {
 
 void Logger::Log(const LogCategory *category, const LogLevel level, const std::string_view message)
+{
+    if (async_.load(std::memory_order_acquire)) {
+        Submit(Record{category, level, std::string{message}});
+        return;
+    }
+    LogSync(category, level, message);
+}
+
+void Logger::Dispatch(const LogCategory *category, const LogLevel level, std::string &&message)
+{
+    if (async_.load(std::memory_order_acquire)) {
+        Submit(Record{category, level, std::move(message)});
+        return;
+    }
+    LogSync(category, level, message);
+}
+
+void Logger::Submit(Record &&record)
+{
+    const LogLevel level = record.level;
+    if (async_.load(std::memory_order_acquire)) {
+        Enqueue(std::move(record));
+        if (level == LogLevel::Fatal) [[unlikely]] {
+            Flush();
+            std::scoped_lock<std::mutex> lock{sync};
+            for (auto &sink : sinks) {
+                sink->Exception();
+            }
+        }
+        return;
+    }
+    std::scoped_lock<std::mutex> lock{sync};
+    Deliver(record);
+    if (level == LogLevel::Fatal) [[unlikely]] {
+        for (auto &sink : sinks) {
+            sink->Exception();
+        }
+    }
+}
+
+void Logger::Deliver(const Record &record)
+{
+    if (record.format == nullptr) {
+        for (auto sink : sinks) {
+            sink->Log(record.category, record.level, record.message);
+        }
+        return;
+    }
+    // format once, and only if some sink wants text
+    std::string text;
+    bool formatted = false;
+    for (auto sink : sinks) {
+        if (sink->LogDeferred(record.category, record.level, record.format, record.args))
+            continue;
+        if (!formatted) {
+            text = FormatLogArgs(record.format, record.args);
+            formatted = true;
+        }
+        sink->Log(record.category, record.level, text);
+    }
+}
+
+void Logger::LogSync(const LogCategory *category, const LogLevel level, const std::string_view message)
 {
     std::scoped_lock<std::mutex> lock{sync};
     for (auto sink : sinks) {
@@ -37,8 +101,122 @@ void Logger::Log(const LogCategory *category, const LogLevel level, const std::s
     }
 }
 
+void Logger::Enqueue(Record &&record)
+{
+    // count before the slot is claimed so that Flush never waits on less than what is already queued
+    pushedCount_.fetch_add(1, std::memory_order_acq_rel);
+    switch (overflowPolicy_) {
+    case LogOverflowPolicy::Drop:
+        // errors are the records most worth keeping when something floods the log, they wait for a slot instead
+        if (record.level > LogLevel::Error) {
+            if (!queue_->TryEmplace(std::move(record))) {
+                droppedCount_.fetch_add(1, std::memory_order_relaxed);
+                consumedCount_.fetch_add(1, std::memory_order_acq_rel);
+                return;
+            }
+            break;
+        }
+        [[fallthrough]];
+    case LogOverflowPolicy::Block:
+        while (!queue_->TryEmplace(std::move(record))) {
+            WakeDrainThread();
+            std::this_thread::yield();
+        }
+        break;
+    case LogOverflowPolicy::Overwrite:
+        while (!queue_->TryEmplace(std::move(record))) {
+            Record oldest;
+            if (queue_->TryPop(oldest)) {
+                droppedCount_.fetch_add(1, std::memory_order_relaxed);
+                consumedCount_.fetch_add(1, std::memory_order_acq_rel);
+            }
+        }
+        break;
+    }
+    if (drainSleeping_.load(std::memory_order_relaxed))
+        WakeDrainThread();
+}
+
+void Logger::WakeDrainThread()
+{
+    drainCondition_.notify_one();
+}
+
+void Logger::DrainLoop()
+{
+    constexpr size_t kMaxBatchSize = 64;
+    Record record;
+    for (;;) {
+        size_t batchSize = 0;
+        {
+            std::scoped_lock<std::mutex> lock{sync};
+            while (batchSize < kMaxBatchSize && queue_->TryPop(record)) {
+                Deliver(record);
+                batchSize++;
+            }
+        }
+        if (batchSize > 0) {
+            consumedCount_.fetch_add(batchSize, std::memory_order_acq_rel);
+            {
+                std::scoped_lock<std::mutex> lock{flushMutex_};
+            }
+            flushCondition_.notify_all();
+            continue;
+        }
+        if (!draining_.load(std::memory_order_acquire) && queue_->Empty())
+            break;
+        std::unique_lock<std::mutex> lock{drainMutex_};
+        drainSleeping_.store(true, std::memory_order_relaxed);
+        // producers only notify when they see the flag, the timeout covers a wakeup lost in between
+        drainCondition_.wait_for(lock, std::chrono::milliseconds(1), [this] {
+            return !queue_->Empty() || !draining_.load(std::memory_order_acquire);
+        });
+        drainSleeping_.store(false, std::memory_order_relaxed);
+    }
+}
+
+void Logger::EnableAsync(size_t capacity, LogOverflowPolicy overflowPolicy)
+{
+    if (async_.load(std::memory_order_acquire))
+        return;
+    overflowPolicy_ = overflowPolicy;
+    queue_ = std::make_unique<BoundedQueue<Record>>(capacity);
+    pushedCount_.store(0, std::memory_order_relaxed);
+    consumedCount_.store(0, std::memory_order_relaxed);
+    droppedCount_.store(0, std::memory_order_relaxed);
+    draining_.store(true, std::memory_order_release);
+    drainThread_ = std::thread(&Logger::DrainLoop, this);
+    async_.store(true, std::memory_order_release);
+}
+
+void Logger::DisableAsync()
+{
+    if (!async_.load(std::memory_order_acquire))
+        return;
+    async_.store(false, std::memory_order_release);
+    draining_.store(false, std::memory_order_release);
+    WakeDrainThread();
+    drainThread_.join();
+    queue_.reset();
+}
+
+void Logger::Flush()
+{
+    if (!async_.load(std::memory_order_acquire))
+        return;
+    uint64_t target = pushedCount_.load(std::memory_order_acquire);
+    WakeDrainThread();
+    std::unique_lock<std::mutex> lock{flushMutex_};
+    // dropped records are consumed by producers without a notification, so poll as well
+    while (!flushCondition_.wait_for(lock, std::chrono::milliseconds(1), [this, target] {
+        return consumedCount_.load(std::memory_order_acquire) >= target;
+    })) {
+    }
+}
+
 Logger::~Logger()
 {
+    DisableAsync();
     std::cerr << std::flush;
 }
 
@@ -1,6 +1,7 @@
 #include "gdf.h"
 #include "Base/Clock.h"
 #include "Base/Window.h"
+#include "DeveloperTool/CpuProfiler.h"
 #include "Git.h"
 #include "Log/Logger.h"
 #include "Log/StdSink.h"
@@ -16,11 +17,19 @@ void glfwErrorCallback(int error, const char *description)
 {
     GDF_LOG(gdfLog, LogLevel::Info, "Glfw Error {}: {}", error, description);
 }
-void Initialize()
+void Initialize(bool windowSystem)
 {
     ProgramClock::Initialize();
     Logger::Create();
     Logger::instance().RegisterSink(&coutSink);
+#ifdef GDF_ENABLE_PROFILER
+    CpuProfiler::Create();
+#endif // GDF_ENABLE_PROFILER
+    GDF_PROFILE_THREAD("Main");
+    if (!windowSystem) {
+        GDF_LOG(gdfLog, LogLevel::Info, "gdf::Initialize without window system");
+        return;
+    }
     glfwSetErrorCallback(glfwErrorCallback);
     if (!glfwInit())
         THROW_EXCEPT("glfwInit Failed!");
@@ -34,6 +43,9 @@ void Cleanup()
 
     GDF_LOG(gdfLog, LogLevel::Info, "gdf::Cleanup");
     ::glfwTerminate();
+#ifdef GDF_ENABLE_PROFILER
+    CpuProfiler::Destroy();
+#endif // GDF_ENABLE_PROFILER
     Logger::instance().DeregisterSink(&coutSink);
     Logger::Destroy();
 }
@@ -0,0 +1,228 @@
+#include "BestOf.h"
+#include "Graphics/AccessorDecode.h"
+#include "Graphics/Mesh.h"
+#include "gdf.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace gdf;
+
+// Decodes each vertex attribute and index type the glTF loader meets into interleaved vertices, with the per-vertex
+// loop the loader used before and with every kernel set the CPU supports. The kernel sets must agree to the bit.
+// The default count is primitive sized and stays in cache, large counts only measure memory bandwidth.
+//   AccessorDecodeBenchmark [vertices]
+constexpr int kRepeatCount = 5;
+constexpr uint32_t kIndexBase = 1000;
+
+struct AttributeCase {
+    const char *name;
+    int componentType;
+    uint32_t componentCount;
+    bool normalized;
+    Vertex::Component member;
+    uint32_t destinationComponents;
+};
+
+constexpr AttributeCase kAttributeCases[] = {
+    {"position f32x3", kComponentFloat, 3, false, Vertex::Component::Position, 3},
+    {"normal f32x3", kComponentFloat, 3, false, Vertex::Component::Normal, 3},
+    {"uv f32x2", kComponentFloat, 2, false, Vertex::Component::UV, 2},
+    {"uv u16n x2", kComponentUnsignedShort, 2, true, Vertex::Component::UV, 2},
+    {"uv u8n x2", kComponentUnsignedByte, 2, true, Vertex::Component::UV, 2},
+    {"tangent f32x4", kComponentFloat, 4, false, Vertex::Component::Tangent, 4},
+    {"color f32x3", kComponentFloat, 3, false, Vertex::Component::Color, 4},
+    {"color u8n x4", kComponentUnsignedByte, 4, true, Vertex::Component::Color, 4},
+    {"color u16n x4", kComponentUnsignedShort, 4, true, Vertex::Component::Color, 4},
+    {"joint u8x4", kComponentUnsignedByte, 4, false, Vertex::Component::Joint0, 4},
+    {"joint u16x4", kComponentUnsignedShort, 4, false, Vertex::Component::Joint0, 4},
+    {"weight f32x4", kComponentFloat, 4, false, Vertex::Component::Weight0, 4},
+    {"weight u8n x4", kComponentUnsignedByte, 4, true, Vertex::Component::Weight0, 4},
+    {"weight u16n x4", kComponentUnsignedShort, 4, true, Vertex::Component::Weight0, 4},
+};
+
+constexpr AccessorKernelSet kKernelSets[] = {AccessorKernelSet::Scalar, AccessorKernelSet::SSE41, AccessorKernelSet::AVX2};
+
+static float *MemberOf(Vertex &vertex, Vertex::Component member)
+{
+    switch (member) {
+    case Vertex::Component::Position:
+        return glm::value_ptr(vertex.pos);
+    case Vertex::Component::Normal:
+        return glm::value_ptr(vertex.normal);
+    case Vertex::Component::UV:
+        return glm::value_ptr(vertex.uv);
+    case Vertex::Component::Color:
+        return glm::value_ptr(vertex.color);
+    case Vertex::Component::Tangent:
+        return glm::value_ptr(vertex.tangent);
+    case Vertex::Component::Joint0:
+        return glm::value_ptr(vertex.joint0);
+    default:
+        return glm::value_ptr(vertex.weight0);
+    }
+}
+
+// The loader's loop before the kernels: a vertex at a time, each component converted on its own
+static void PerVertexLoop(const AccessorStream &stream, Vertex *vertices, const AttributeCase &attribute, uint32_t count)
+{
+    const float fill[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+    size_t componentSize = AccessorComponentSize(stream.componentType);
+    size_t offset = reinterpret_cast<uint8_t *>(MemberOf(vertices[0], attribute.member)) -
+                    reinterpret_cast<uint8_t *>(vertices);
+    for (uint32_t i = 0; i < count; i++) {
+        const uint8_t *element = stream.data + stream.stride * i;
+        float *destination = reinterpret_cast<float *>(reinterpret_cast<uint8_t *>(vertices + i) + offset);
+        for (uint32_t c = 0; c < attribute.destinationComponents; c++) {
+            if (c >= stream.componentCount) {
+                destination[c] = fill[c];
+                continue;
+            }
+            const uint8_t *component = element + c * componentSize;
+            if (stream.componentType == kComponentFloat) {
+                std::memcpy(destination + c, component, sizeof(float));
+            } else if (stream.componentType == kComponentUnsignedByte) {
+                destination[c] = stream.normalized ? component[0] / 255.0f : component[0];
+            } else {
+                uint16_t value;
+                std::memcpy(&value, component, sizeof(value));
+                destination[c] = stream.normalized ? value / 65535.0f : value;
+            }
+        }
+        if (attribute.member == Vertex::Component::Normal)
+            vertices[i].normal = glm::normalize(vertices[i].normal);
+    }
+}
+
+static void DecodeWithKernels(const AccessorStream &stream,
+                              Vertex *vertices,
+                              const AttributeCase &attribute,
+                              uint32_t count)
+{
+    float *member = MemberOf(vertices[0], attribute.member);
+    DecodeAccessor(stream, member, sizeof(Vertex), attribute.destinationComponents, count);
+    if (attribute.member == Vertex::Component::Normal)
+        NormalizeVectors(member, sizeof(Vertex), count);
+}
+
+// The loader's index loop before the kernels
+static void PerIndexLoop(const uint8_t *data, int componentType, uint32_t count, uint32_t *indices)
+{
+    switch (componentType) {
+    case kComponentUnsignedInt: {
+        const uint32_t *source = reinterpret_cast<const uint32_t *>(data);
+        for (uint32_t i = 0; i < count; i++)
+            indices[i] = source[i] + kIndexBase;
+        break;
+    }
+    case kComponentUnsignedShort: {
+        const uint16_t *source = reinterpret_cast<const uint16_t *>(data);
+        for (uint32_t i = 0; i < count; i++)
+            indices[i] = source[i] + kIndexBase;
+        break;
+    }
+    case kComponentUnsignedByte:
+        for (uint32_t i = 0; i < count; i++)
+            indices[i] = data[i] + kIndexBase;
+        break;
+    }
+}
+
+template <typename Function>
+static double BestNsPerElement(uint32_t count, Function &&function)
+{
+    return BestOfNs(kRepeatCount, function) / count;
+}
+
+static void PrintHeader(const char *first)
+{
+    std::printf("%-16s %12s", first, "per-vertex");
+    for (AccessorKernelSet kernelSet : kKernelSets)
+        std::printf(" %18s", AccessorKernelSetName(kernelSet));
+    std::printf("   (ns per element, speedup)\n");
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t count = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 1u << 14;
+    gdf::Initialize(false);
+    std::printf("%u elements, kernels picked: %s\n", count, AccessorKernelSetName(accessorKernelSet()));
+    AccessorKernelSet picked = accessorKernelSet();
+
+    std::mt19937 random(1);
+    std::vector<uint8_t> bytes(static_cast<size_t>(count) * 16);
+    for (auto &byte : bytes)
+        byte = static_cast<uint8_t>(random());
+    std::vector<float> floats(static_cast<size_t>(count) * 4);
+    for (auto &value : floats)
+        value = static_cast<float>(random() % 20001) / 1000.0f - 10.0f;
+
+    int result = 0;
+    std::vector<Vertex> vertices(count);
+    std::vector<Vertex> reference(count);
+    PrintHeader("attribute");
+    for (const AttributeCase &attribute : kAttributeCases) {
+        bool isFloat = attribute.componentType == kComponentFloat;
+        AccessorStream stream{
+            .data = isFloat ? reinterpret_cast<const uint8_t *>(floats.data()) : bytes.data(),
+            .stride = attribute.componentCount * AccessorComponentSize(attribute.componentType),
+            .componentType = attribute.componentType,
+            .componentCount = attribute.componentCount,
+            .normalized = attribute.normalized,
+        };
+        double baseline = BestNsPerElement(count, [&] { PerVertexLoop(stream, vertices.data(), attribute, count); });
+        std::printf("%-16s %12.2f", attribute.name, baseline);
+        bool first = true;
+        for (AccessorKernelSet kernelSet : kKernelSets) {
+            if (!SetAccessorKernelSet(kernelSet)) {
+                std::printf(" %18s", "-");
+                continue;
+            }
+            double ns = BestNsPerElement(count, [&] { DecodeWithKernels(stream, vertices.data(), attribute, count); });
+            if (first)
+                reference = vertices;
+            bool same = first || std::memcmp(vertices.data(), reference.data(), count * sizeof(Vertex)) == 0;
+            std::printf(" %9.2f (%5.2fx)%s", ns, baseline / ns, same ? "" : "!");
+            if (!same)
+                result = 1;
+            first = false;
+        }
+        std::printf("\n");
+    }
+
+    std::vector<uint32_t> indices(count);
+    std::vector<uint32_t> referenceIndices(count);
+    PrintHeader("indices");
+    for (int componentType : {kComponentUnsignedByte, kComponentUnsignedShort, kComponentUnsignedInt}) {
+        double baseline = BestNsPerElement(count, [&] { PerIndexLoop(bytes.data(), componentType, count, indices.data()); });
+        const char *name = componentType == kComponentUnsignedByte    ? "u8"
+                           : componentType == kComponentUnsignedShort ? "u16"
+                                                                      : "u32";
+        std::printf("%-16s %12.2f", name, baseline);
+        bool first = true;
+        for (AccessorKernelSet kernelSet : kKernelSets) {
+            if (!SetAccessorKernelSet(kernelSet)) {
+                std::printf(" %18s", "-");
+                continue;
+            }
+            double ns = BestNsPerElement(
+                count, [&] { WidenIndices(bytes.data(), componentType, count, kIndexBase, indices.data()); });
+            if (first)
+                referenceIndices = indices;
+            bool same = indices == referenceIndices;
+            std::printf(" %9.2f (%5.2fx)%s", ns, baseline / ns, same ? "" : "!");
+            if (!same)
+                result = 1;
+            first = false;
+        }
+        std::printf("\n");
+    }
+    if (result != 0)
+        std::printf("kernel sets disagree on the rows marked !\n");
+    SetAccessorKernelSet(picked);
+    gdf::Cleanup();
+    return result;
+}
@@ -2,6 +2,7 @@
 #include "Base/Application.h"
 #include "Graphics/Graphics.h"
 #include "Base/TimeManager.h"
+#include "DeveloperTool/CpuProfiler.h"
 #include "DeveloperTool/DeveloperConsole.h"
 #include "Log/StdSink.h"
 #include "Base/Clock.h"
@@ -41,7 +42,11 @@ void GfxApp::StartUp()
 void GfxApp::MainLoop()
 {
     while (!window_.ShouldClose()) {
-        window_.PollEvents();
+        GDF_PROFILE_FRAME();
+        {
+            GDF_PROFILE_ZONE("PollEvents");
+            window_.PollEvents();
+        }
         if (window_.framebufferResized()) {
             gfx_.RequireRecreateSwapchain(true);
         }
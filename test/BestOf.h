@@ -0,0 +1,25 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+
+// Runs function repeatCount times and returns its fastest run in nanoseconds, the run least disturbed by the rest of
+// the system. prepare runs before each one outside the timing.
+template <typename Prepare, typename Function>
+double BestOfNs(int repeatCount, Prepare &&prepare, Function &&function)
+{
+    double best = 0.0;
+    for (int repeat = 0; repeat < repeatCount; repeat++) {
+        prepare();
+        auto begin = std::chrono::steady_clock::now();
+        function();
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+        best = repeat == 0 ? ns : std::min(best, ns);
+    }
+    return best;
+}
+
+template <typename Function>
+double BestOfNs(int repeatCount, Function &&function)
+{
+    return BestOfNs(repeatCount, [] {}, function);
+}
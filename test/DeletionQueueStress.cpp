@@ -0,0 +1,187 @@
+#include "Graphics/Graphics.h"
+#include "gdf.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace gdf;
+
+// Runtime resource churn through Graphics::deletionQueue under the validation layer. Every frame creates buffers,
+// images and views, writes them on the graphics queue and hands them to the deletion queue in the same frame, so the
+// layer reports any object destroyed while a submitted frame still uses it.
+//   DeletionQueueStress [frames] [resources per frame]
+// Headless, so it also runs on lavapipe:
+//   VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json ./DeletionQueueStress 300 2000
+constexpr VkExtent2D kExtent{320, 240};
+constexpr VkDeviceSize kBufferSize = 4096;
+constexpr uint32_t kImageExtent = 16;
+// one resource in kImageEvery is an image with a view, the rest are buffers
+constexpr int kImageEvery = 4;
+
+static void CreateBuffer(VulkanDevice &device, VkBuffer &buffer, DeviceAllocation &allocation)
+{
+    auto bufferCI =
+        GraphicsTools::MakeBufferCreateInfo(kBufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_SHARING_MODE_EXCLUSIVE);
+    VK_ASSERT_SUCCESSED(vkCreateBuffer(device, &bufferCI, nullptr, &buffer))
+    VkMemoryRequirements requirements;
+    vkGetBufferMemoryRequirements(device, buffer, &requirements);
+    allocation = device.memoryAllocator.Allocate(
+        requirements,
+        device.FindMemoryType(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT),
+        DeviceResourceKind::Linear);
+    VK_ASSERT_SUCCESSED(vkBindBufferMemory(device, buffer, allocation.memory, allocation.offset))
+}
+
+int main(int argc, char **argv)
+{
+    int frameCount = argc > 1 ? std::atoi(argv[1]) : 300;
+    int resourceCount = argc > 2 ? std::atoi(argv[2]) : 2000;
+
+    gdf::Initialize(false);
+    int result = 0;
+    {
+        Graphics gfx;
+        gfx.Initialize(nullptr, true, kExtent);
+        VulkanDevice &device = gfx.device_;
+        uint32_t baseAllocations = device.memoryAllocator.statistics().allocationCount;
+
+        // our own command buffer per frame slot, submitted ahead of the frame on the same queue
+        std::vector<VkCommandPool> commandPools(gfx.framesInFlight());
+        std::vector<VkCommandBuffer> commandBuffers(gfx.framesInFlight());
+        for (uint32_t i = 0; i < gfx.framesInFlight(); i++) {
+            VkCommandPoolCreateInfo poolCI{
+                .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+                .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+                .queueFamilyIndex = device.queueFamilyIndices.graphics,
+            };
+            VK_ASSERT_SUCCESSED(vkCreateCommandPool(device, &poolCI, nullptr, &commandPools[i]))
+            VkCommandBufferAllocateInfo allocateInfo{
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                .commandPool = commandPools[i],
+                .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+                .commandBufferCount = 1,
+            };
+            VK_ASSERT_SUCCESSED(vkAllocateCommandBuffers(device, &allocateInfo, &commandBuffers[i]))
+        }
+
+        VkImageSubresourceRange range{
+            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .baseMipLevel = 0,
+            .levelCount = 1,
+            .baseArrayLayer = 0,
+            .layerCount = 1,
+        };
+        VkClearColorValue clearColor{{0.25f, 0.5f, 0.75f, 1.0f}};
+        size_t maxPending = 0;
+        size_t objectsPerFrame = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frameCount; frame++) {
+            gfx.FrameBegin();
+            // FrameBegin waited for the previous frame of this slot, its command buffer is free again
+            VkCommandBuffer commandBuffer = commandBuffers[gfx.currentFrame_];
+            VK_ASSERT_SUCCESSED(vkResetCommandPool(device, commandPools[gfx.currentFrame_], 0))
+            VkCommandBufferBeginInfo beginInfo{
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+                .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+            };
+            VK_ASSERT_SUCCESSED(vkBeginCommandBuffer(commandBuffer, &beginInfo))
+
+            objectsPerFrame = 0;
+            for (int i = 0; i < resourceCount; i++) {
+                if (i % kImageEvery != 0) {
+                    VkBuffer buffer;
+                    DeviceAllocation allocation;
+                    CreateBuffer(device, buffer, allocation);
+                    vkCmdFillBuffer(commandBuffer, buffer, 0, VK_WHOLE_SIZE, static_cast<uint32_t>(frame));
+                    gfx.deletionQueue().Enqueue(buffer);
+                    gfx.deletionQueue().Enqueue(allocation);
+                    objectsPerFrame += 2;
+                    continue;
+                }
+                VkImage image;
+                DeviceAllocation allocation;
+                device.CreateImage(kImageExtent,
+                                   kImageExtent,
+                                   VK_FORMAT_R8G8B8A8_UNORM,
+                                   VK_IMAGE_TILING_OPTIMAL,
+                                   VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                                   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                   image,
+                                   allocation);
+                VkImageView imageView = device.CreateImageView(image, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT);
+                VkImageMemoryBarrier barrier{
+                    .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                    .srcAccessMask = 0,
+                    .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                    .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+                    .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .image = image,
+                    .subresourceRange = range,
+                };
+                vkCmdPipelineBarrier(commandBuffer,
+                                     VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                     VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                     0,
+                                     0,
+                                     nullptr,
+                                     0,
+                                     nullptr,
+                                     1,
+                                     &barrier);
+                vkCmdClearColorImage(
+                    commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &clearColor, 1, &range);
+                gfx.deletionQueue().Enqueue(imageView);
+                gfx.deletionQueue().Enqueue(image);
+                gfx.deletionQueue().Enqueue(allocation);
+                objectsPerFrame += 3;
+            }
+            VK_ASSERT_SUCCESSED(vkEndCommandBuffer(commandBuffer))
+            auto submitInfo = GraphicsTools::MakeSubmitInfo(0, nullptr, nullptr, 1, &commandBuffer, 0, nullptr);
+            // no fence of our own, the frame submitted after it on the same queue retires after it
+            VK_ASSERT_SUCCESSED(vkQueueSubmit(gfx.graphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE))
+
+            gfx.DrawFrame();
+            gfx.FrameEnd();
+            maxPending = std::max(maxPending, gfx.deletionQueue().pendingCount());
+        }
+        gfx.DeviceWaitIdle();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::printf("%d frames, %zu objects per frame, %.1f us/frame\n",
+                    frameCount,
+                    objectsPerFrame,
+                    seconds * 1e6 / std::max(frameCount, 1));
+        std::printf("frame tracking: %s, most objects waiting: %zu\n",
+                    gfx.frameSync().timeline() ? "timeline semaphore" : "fences",
+                    maxPending);
+
+        // the objects of at most the frames in flight and the one being built wait at any time
+        if (maxPending > (gfx.framesInFlight() + 1) * objectsPerFrame) {
+            std::fprintf(stderr, "the deletion queue fell behind the retired frames\n");
+            result = 1;
+        }
+        gfx.deletionQueue().Collect();
+        if (gfx.deletionQueue().pendingCount() != 0) {
+            std::fprintf(stderr, "%zu objects left after the device went idle\n", gfx.deletionQueue().pendingCount());
+            result = 1;
+        }
+        if (device.memoryAllocator.statistics().allocationCount != baseAllocations) {
+            std::fprintf(stderr, "allocations leaked\n");
+            result = 1;
+        }
+        if (Graphics::validationErrorCount() != 0) {
+            std::fprintf(stderr, "%u validation errors\n", Graphics::validationErrorCount());
+            result = 1;
+        }
+
+        for (auto commandPool : commandPools)
+            vkDestroyCommandPool(device, commandPool, nullptr);
+        gfx.Cleanup();
+    }
+    gdf::Cleanup();
+    std::printf(result == 0 ? "passed\n" : "FAILED\n");
+    return result;
+}
@@ -0,0 +1,153 @@
+#include "Graphics/VulkanDevice.h"
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace gdf;
+
+// Headless stress test of VulkanDevice::memoryAllocator: 100k mixed buffer/image creations and destructions
+// bound to sub-allocated memory. Runs on any Vulkan device, on CI use lavapipe:
+//   VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json ./DeviceMemoryStress
+struct Resource {
+    VkBuffer buffer{VK_NULL_HANDLE};
+    VkImage image{VK_NULL_HANDLE};
+    DeviceAllocation allocation;
+};
+
+int main(int argc, char **argv)
+{
+    constexpr int kOperationCount = 100000;
+    constexpr size_t kMaxLive = 2048;
+
+    VkApplicationInfo appInfo{};
+    appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    appInfo.pApplicationName = "DeviceMemoryStress";
+    appInfo.apiVersion = VK_API_VERSION_1_0;
+    VkInstanceCreateInfo instanceCI{};
+    instanceCI.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instanceCI.pApplicationInfo = &appInfo;
+    VkInstance instance;
+    if (vkCreateInstance(&instanceCI, nullptr, &instance) != VK_SUCCESS) {
+        std::fprintf(stderr, "failed to create a Vulkan instance\n");
+        return 1;
+    }
+    uint32_t physicalDeviceCount = 0;
+    vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, nullptr);
+    if (physicalDeviceCount == 0) {
+        std::fprintf(stderr, "no Vulkan device\n");
+        return 1;
+    }
+    std::vector<VkPhysicalDevice> physicalDevices(physicalDeviceCount);
+    vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, physicalDevices.data());
+
+    int result = 0;
+    {
+        VulkanDevice device;
+        device.AttachPhysicalDevice(physicalDevices[0], false);
+        device.CreateLogicalDevice({}, VK_NULL_HANDLE, {}, {});
+        std::printf("device: %s\n", device.properties.deviceName);
+
+        std::mt19937 random(1234);
+        std::vector<Resource> live;
+        size_t written = 0;
+        for (int i = 0; i < kOperationCount; i++) {
+            if (live.size() == kMaxLive || (!live.empty() && random() % 2 == 0)) {
+                size_t index = random() % live.size();
+                Resource &resource = live[index];
+                if (resource.buffer != VK_NULL_HANDLE)
+                    vkDestroyBuffer(device, resource.buffer, nullptr);
+                else
+                    vkDestroyImage(device, resource.image, nullptr);
+                device.memoryAllocator.Free(resource.allocation);
+                live[index] = live.back();
+                live.pop_back();
+                continue;
+            }
+            Resource resource;
+            VkMemoryRequirements requirements;
+            VkMemoryPropertyFlags properties;
+            DeviceResourceKind kind;
+            if (random() % 3 != 0) {
+                // staging and vertex buffers, host visible so the mapping gets exercised too
+                VkBufferCreateInfo bufferCI{};
+                bufferCI.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+                bufferCI.size = 256 + random() % (256 * 1024);
+                bufferCI.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+                bufferCI.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+                VK_ASSERT_SUCCESSED(vkCreateBuffer(device, &bufferCI, nullptr, &resource.buffer))
+                vkGetBufferMemoryRequirements(device, resource.buffer, &requirements);
+                properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+                kind = DeviceResourceKind::Linear;
+            } else {
+                // textures, one in fifty large enough for a dedicated allocation
+                uint32_t extent = random() % 50 == 0 ? 4096 : 16u << (random() % 6);
+                VkImageCreateInfo imageCI{};
+                imageCI.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+                imageCI.imageType = VK_IMAGE_TYPE_2D;
+                imageCI.format = VK_FORMAT_R8G8B8A8_UNORM;
+                imageCI.extent = {extent, extent, 1};
+                imageCI.mipLevels = 1;
+                imageCI.arrayLayers = 1;
+                imageCI.samples = VK_SAMPLE_COUNT_1_BIT;
+                imageCI.tiling = VK_IMAGE_TILING_OPTIMAL;
+                imageCI.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+                imageCI.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+                imageCI.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+                VK_ASSERT_SUCCESSED(vkCreateImage(device, &imageCI, nullptr, &resource.image))
+                vkGetImageMemoryRequirements(device, resource.image, &requirements);
+                properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+                kind = DeviceResourceKind::Optimal;
+            }
+            resource.allocation = device.memoryAllocator.Allocate(
+                requirements, device.FindMemoryType(requirements.memoryTypeBits, properties), kind);
+            if (resource.allocation.offset % requirements.alignment != 0) {
+                std::fprintf(stderr, "misaligned allocation at operation %d\n", i);
+                result = 1;
+            }
+            if (resource.buffer != VK_NULL_HANDLE) {
+                VK_ASSERT_SUCCESSED(vkBindBufferMemory(
+                    device, resource.buffer, resource.allocation.memory, resource.allocation.offset))
+                if (resource.allocation.mapped != nullptr) {
+                    std::memset(resource.allocation.mapped, 0xCD, static_cast<size_t>(requirements.size));
+                    written++;
+                }
+            } else {
+                VK_ASSERT_SUCCESSED(
+                    vkBindImageMemory(device, resource.image, resource.allocation.memory, resource.allocation.offset))
+            }
+            live.push_back(resource);
+        }
+
+        auto statistics = device.memoryAllocator.statistics();
+        std::printf("live allocations: %u (%u dedicated)\n", statistics.allocationCount, statistics.dedicatedCount);
+        std::printf("vkAllocateMemory objects: %u\n", statistics.blockCount + statistics.dedicatedCount);
+        std::printf("block bytes: %llu, used bytes: %llu, largest free range: %llu\n",
+                    static_cast<unsigned long long>(statistics.blockBytes),
+                    static_cast<unsigned long long>(statistics.usedBytes),
+                    static_cast<unsigned long long>(statistics.largestFreeRange));
+        std::printf("fragmentation: %.3f, mapped writes: %zu\n", statistics.fragmentation, written);
+        if (statistics.allocationCount != live.size()) {
+            std::fprintf(stderr, "allocation count mismatch\n");
+            result = 1;
+        }
+
+        for (auto &resource : live) {
+            if (resource.buffer != VK_NULL_HANDLE)
+                vkDestroyBuffer(device, resource.buffer, nullptr);
+            else
+                vkDestroyImage(device, resource.image, nullptr);
+            device.memoryAllocator.Free(resource.allocation);
+        }
+        statistics = device.memoryAllocator.statistics();
+        if (statistics.allocationCount != 0 || statistics.usedBytes != 0) {
+            std::fprintf(stderr, "allocations left after freeing everything\n");
+            result = 1;
+        }
+        device.memoryAllocator.Destroy();
+        vkDestroyDevice(device, nullptr);
+    }
+    vkDestroyInstance(instance, nullptr);
+    std::printf(result == 0 ? "passed\n" : "FAILED\n");
+    return result;
+}
@@ -0,0 +1,80 @@
+#include "Base/LinearArena.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+using namespace gdf;
+
+// A draw list as a renderer builds it every frame: one item per visible object, bucketed by material
+// and sorted by depth, all thrown away once the frame is submitted
+struct DrawItem {
+    uint32_t mesh;
+    uint32_t material;
+    float depth;
+    float transform[16];
+};
+
+constexpr size_t kObjectCount = 5000;
+constexpr size_t kMaterialCount = 64;
+constexpr size_t kFrameCount = 2000;
+
+template <typename Vector, typename Buckets, typename MakeVector>
+static uint64_t BuildFrame(size_t frame, Vector items, Buckets buckets, MakeVector makeVector)
+{
+    for (size_t i = 0; i < kObjectCount; i++) {
+        DrawItem item{};
+        item.mesh = static_cast<uint32_t>(i);
+        item.material = static_cast<uint32_t>((i * 31 + frame) % kMaterialCount);
+        item.depth = static_cast<float>((i * 7919 + frame * 13) % 1000);
+        item.transform[0] = item.transform[5] = item.transform[10] = item.transform[15] = 1.0f;
+        items.push_back(item);
+    }
+    for (size_t m = 0; m < kMaterialCount; m++)
+        buckets.push_back(makeVector());
+    for (auto &item : items)
+        buckets[item.material].push_back(&item);
+    uint64_t checksum = 0;
+    for (auto &bucket : buckets) {
+        std::sort(bucket.begin(), bucket.end(), [](const DrawItem *a, const DrawItem *b) { return a->depth < b->depth; });
+        if (!bucket.empty())
+            checksum += bucket.front()->mesh;
+    }
+    return checksum;
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t checksum = 0;
+
+    auto heapBegin = std::chrono::steady_clock::now();
+    for (size_t frame = 0; frame < kFrameCount; frame++) {
+        checksum += BuildFrame(
+            frame, std::vector<DrawItem>{}, std::vector<std::vector<DrawItem *>>{}, [] { return std::vector<DrawItem *>{}; });
+    }
+    auto heapEnd = std::chrono::steady_clock::now();
+
+    // one arena per frame in flight used round robin, like Graphics::frameArena with the default two
+    LinearArena arenas[2];
+    auto arenaBegin = std::chrono::steady_clock::now();
+    for (size_t frame = 0; frame < kFrameCount; frame++) {
+        LinearArena &arena = arenas[frame % 2];
+        arena.Reset();
+        checksum += BuildFrame(frame,
+                               ArenaVector<DrawItem>{arena},
+                               ArenaVector<ArenaVector<DrawItem *>>{arena},
+                               [&arena] { return ArenaVector<DrawItem *>{arena}; });
+    }
+    auto arenaEnd = std::chrono::steady_clock::now();
+
+    double heapNs = std::chrono::duration<double, std::nano>(heapEnd - heapBegin).count() / kFrameCount;
+    double arenaNs = std::chrono::duration<double, std::nano>(arenaEnd - arenaBegin).count() / kFrameCount;
+    std::printf("%-16s %14s\n", "allocator", "ns/frame");
+    std::printf("%-16s %14.1f\n", "std::allocator", heapNs);
+    std::printf("%-16s %14.1f\n", "frame arena", arenaNs);
+    std::printf("arena capacity after warm up: %zu bytes (checksum %llu)\n",
+                arenas[0].capacity(),
+                static_cast<unsigned long long>(checksum));
+    return 0;
+}
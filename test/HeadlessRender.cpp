@@ -0,0 +1,110 @@
+#include "Graphics/Graphics.h"
+#include "gdf.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace gdf;
+
+// Frame loop throughput without a window, and an image-diff check of the last frame.
+//   HeadlessRender [frames] [output.ppm] [reference.ppm]
+// Runs on any Vulkan device, on CI use lavapipe:
+//   VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json ./HeadlessRender 1000 frame.ppm reference.ppm
+constexpr VkExtent2D kExtent{640, 480};
+// per channel difference tolerated against the reference, software and hardware rasterizers round differently
+constexpr int kTolerance = 2;
+
+static bool WritePPM(const std::string &path, const std::vector<uint8_t> &rgba, VkExtent2D extent)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open())
+        return false;
+    file << "P6\n" << extent.width << " " << extent.height << "\n255\n";
+    for (size_t i = 0; i < rgba.size(); i += 4)
+        file.write(reinterpret_cast<const char *>(&rgba[i]), 3);
+    return file.good();
+}
+
+static bool ReadPPM(const std::string &path, std::vector<uint8_t> &rgb, VkExtent2D &extent)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::string magic;
+    int maxValue = 0;
+    if (!(file >> magic >> extent.width >> extent.height >> maxValue) || magic != "P6" || maxValue != 255)
+        return false;
+    file.get();
+    rgb.resize(static_cast<size_t>(extent.width) * extent.height * 3);
+    file.read(reinterpret_cast<char *>(rgb.data()), static_cast<std::streamsize>(rgb.size()));
+    return file.good();
+}
+
+int main(int argc, char **argv)
+{
+    int frameCount = argc > 1 ? std::atoi(argv[1]) : 1000;
+    std::string outputPath = argc > 2 ? argv[2] : "";
+    std::string referencePath = argc > 3 ? argv[3] : "";
+
+    gdf::Initialize(false);
+    int result = 0;
+    {
+        Graphics gfx;
+        gfx.Initialize(nullptr, false, kExtent);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < frameCount; i++) {
+            gfx.FrameBegin();
+            gfx.DrawFrame();
+            gfx.FrameEnd();
+        }
+        gfx.DeviceWaitIdle();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::printf("%d frames in %.3f s, %.1f fps, %.1f us/frame\n",
+                    frameCount,
+                    seconds,
+                    frameCount / seconds,
+                    seconds * 1e6 / frameCount);
+
+        // one more frame with readback, so the timed loop never paid for the copy
+        gfx.EnableReadback(true);
+        gfx.FrameBegin();
+        gfx.DrawFrame();
+        gfx.FrameEnd();
+        std::vector<uint8_t> pixels;
+        if (!gfx.ReadFrame(pixels)) {
+            std::fprintf(stderr, "readback failed\n");
+            result = 1;
+        }
+        if (result == 0 && !outputPath.empty() && !WritePPM(outputPath, pixels, gfx.extent())) {
+            std::fprintf(stderr, "failed to write %s\n", outputPath.c_str());
+            result = 1;
+        }
+        if (result == 0 && !referencePath.empty()) {
+            std::vector<uint8_t> reference;
+            VkExtent2D referenceExtent{};
+            if (!ReadPPM(referencePath, reference, referenceExtent) || referenceExtent.width != kExtent.width ||
+                referenceExtent.height != kExtent.height) {
+                std::fprintf(stderr, "failed to read %s or size mismatch\n", referencePath.c_str());
+                result = 1;
+            } else {
+                size_t differing = 0;
+                for (size_t pixel = 0; pixel * 3 < reference.size(); pixel++) {
+                    for (size_t channel = 0; channel < 3; channel++) {
+                        if (std::abs(int(pixels[pixel * 4 + channel]) - int(reference[pixel * 3 + channel])) > kTolerance) {
+                            differing++;
+                            break;
+                        }
+                    }
+                }
+                std::printf("%zu pixels differ from %s\n", differing, referencePath.c_str());
+                result = differing == 0 ? 0 : 1;
+            }
+        }
+        gfx.Cleanup();
+    }
+    gdf::Cleanup();
+    std::printf(result == 0 ? "passed\n" : "FAILED\n");
+    return result;
+}
@@ -0,0 +1,23 @@
+#include "Log/BinaryLog.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+// Prints a BinaryFileSink log as the text CerrSink would have produced
+int main(int argc, char **argv)
+{
+    if (argc != 2) {
+        std::fprintf(stderr, "usage: %s <binary log>\n", argv[0]);
+        return 1;
+    }
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in.is_open()) {
+        std::fprintf(stderr, "failed to open %s\n", argv[1]);
+        return 1;
+    }
+    if (!gdf::DecodeBinaryLog(in, std::cout)) {
+        std::fprintf(stderr, "%s is not a valid binary log\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include "Log/Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace gdf;
+
+GDF_DECLARE_LOG_CATEGORY(BenchmarkLog, LogLevel::All, LogLevel::All)
+GDF_DEFINE_LOG_CATEGORY(BenchmarkLog)
+
+// Stands in for a console sink: every record costs a couple of microseconds on the thread that calls it
+class SlowSink : public LogSink
+{
+public:
+    virtual void Log(const LogCategory *category, const LogLevel level, const std::string_view message)
+    {
+        auto end = std::chrono::steady_clock::now() + std::chrono::microseconds(2);
+        while (std::chrono::steady_clock::now() < end) {
+        }
+        bytes_ += message.size();
+    }
+    virtual void Exception()
+    {
+    }
+
+private:
+    size_t bytes_{0};
+};
+
+struct Result {
+    double mean;
+    double p50;
+    double p99;
+    double max;
+};
+
+static Result RunProducers(size_t threadCount, size_t messagesPerThread)
+{
+    std::vector<std::vector<double>> latencies(threadCount);
+    std::vector<std::thread> producers;
+    for (size_t t = 0; t < threadCount; t++) {
+        producers.emplace_back([t, messagesPerThread, &latencies] {
+            auto &samples = latencies[t];
+            samples.reserve(messagesPerThread);
+            for (size_t i = 0; i < messagesPerThread; i++) {
+                auto begin = std::chrono::steady_clock::now();
+                GDF_LOG(BenchmarkLog, LogLevel::Warning, "swapchain out of date, thread {} frame {}", t, i);
+                auto end = std::chrono::steady_clock::now();
+                samples.push_back(std::chrono::duration<double, std::nano>(end - begin).count());
+            }
+        });
+    }
+    for (auto &producer : producers)
+        producer.join();
+    Logger::instance().Flush();
+
+    std::vector<double> all;
+    for (auto &samples : latencies)
+        all.insert(all.end(), samples.begin(), samples.end());
+    std::sort(all.begin(), all.end());
+    double sum = 0;
+    for (auto sample : all)
+        sum += sample;
+    return Result{sum / all.size(), all[all.size() / 2], all[all.size() * 99 / 100], all.back()};
+}
+
+int main(int argc, char **argv)
+{
+    constexpr size_t kMessagesPerThread = 20000;
+    Logger::Create();
+    SlowSink slowSink;
+    Logger::instance().RegisterSink(&slowSink);
+
+    struct Mode {
+        const char *name;
+        bool async;
+        LogOverflowPolicy policy;
+    };
+    Mode modes[] = {
+        {"sync", false, LogOverflowPolicy::Block},
+        {"async/block", true, LogOverflowPolicy::Block},
+        {"async/drop", true, LogOverflowPolicy::Drop},
+        {"async/overwrite", true, LogOverflowPolicy::Overwrite},
+    };
+    std::printf("%-16s %8s %12s %12s %12s %12s %10s\n", "mode", "threads", "mean(ns)", "p50(ns)", "p99(ns)", "max(ns)", "dropped");
+    for (auto &mode : modes) {
+        for (size_t threadCount : {1, 4, 16}) {
+            if (mode.async)
+                Logger::instance().EnableAsync(8192, mode.policy);
+            Result result = RunProducers(threadCount, kMessagesPerThread);
+            uint64_t dropped = Logger::instance().droppedCount();
+            Logger::instance().DisableAsync();
+            std::printf("%-16s %8zu %12.1f %12.1f %12.1f %12.1f %10llu\n",
+                        mode.name,
+                        threadCount,
+                        result.mean,
+                        result.p50,
+                        result.p99,
+                        result.max,
+                        static_cast<unsigned long long>(mode.async ? dropped : 0));
+        }
+    }
+
+    Logger::instance().DeregisterSink(&slowSink);
+    Logger::Destroy();
+    return 0;
+}
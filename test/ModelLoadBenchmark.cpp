@@ -0,0 +1,217 @@
+#include "Base/WorkerPool.h"
+#include "BestOf.h"
+#include "Graphics/Mesh.h"
+#include "gdf.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace gdf;
+
+// Loads a synthetic .glb with many small primitives, the shape of a production scene, with the primitive decoding
+// spread over 1..hardware_concurrency threads. Every load must produce the same geometry as the serial one.
+// A last serial load stores the vertices in the quantized formats and reports the memory they save, another one decodes
+// them into per-attribute streams and must interleave them to the same bytes.
+//   ModelLoadBenchmark [primitives] [vertices per primitive]
+constexpr int kPrimitivesPerMesh = 8;
+constexpr int kRepeatCount = 3;
+// glTF componentType values
+constexpr int kUnsignedShort = 5123;
+constexpr int kUnsignedInt = 5125;
+constexpr int kFloat = 5126;
+
+static void AppendView(std::vector<uint8_t> &bin, nlohmann::json &bufferViews, const void *data, size_t size)
+{
+    bufferViews.push_back({{"buffer", 0}, {"byteOffset", bin.size()}, {"byteLength", size}});
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    bin.insert(bin.end(), bytes, bytes + size);
+    // keep every view 4 byte aligned
+    bin.resize((bin.size() + 3) & ~size_t{3});
+}
+
+static void AppendAccessor(nlohmann::json &accessors, size_t view, int componentType, int count, const char *type)
+{
+    accessors.push_back({{"bufferView", view}, {"componentType", componentType}, {"count", count}, {"type", type}});
+}
+
+static void WriteSyntheticGlb(const std::string &path, int primitiveCount, int vertexCount)
+{
+    nlohmann::json accessors = nlohmann::json::array();
+    nlohmann::json bufferViews = nlohmann::json::array();
+    nlohmann::json meshes = nlohmann::json::array();
+    nlohmann::json nodes = nlohmann::json::array();
+    nlohmann::json sceneNodes = nlohmann::json::array();
+    std::vector<uint8_t> bin;
+    std::vector<float> positions(vertexCount * 3);
+    std::vector<float> normals(vertexCount * 3);
+    std::vector<float> texCoords(vertexCount * 2);
+    std::vector<float> tangents(vertexCount * 4);
+    std::vector<uint16_t> shortIndices(vertexCount * 3);
+    std::vector<uint32_t> intIndices(vertexCount * 3);
+
+    for (int p = 0; p < primitiveCount; p++) {
+        if (p % kPrimitivesPerMesh == 0) {
+            meshes.push_back({{"primitives", nlohmann::json::array()}});
+            nodes.push_back({{"mesh", meshes.size() - 1}});
+            sceneNodes.push_back(nodes.size() - 1);
+        }
+        for (int v = 0; v < vertexCount; v++) {
+            float x = static_cast<float>(p % 100) + static_cast<float>(v % 8);
+            float y = static_cast<float>(p / 100) + static_cast<float>(v / 8);
+            positions[v * 3 + 0] = x;
+            positions[v * 3 + 1] = y;
+            positions[v * 3 + 2] = static_cast<float>(v % 3);
+            normals[v * 3 + 0] = 0.0f;
+            normals[v * 3 + 1] = 0.0f;
+            normals[v * 3 + 2] = 1.0f;
+            texCoords[v * 2 + 0] = static_cast<float>(v % 8) / 8.0f;
+            texCoords[v * 2 + 1] = static_cast<float>(v / 8) / 8.0f;
+            tangents[v * 4 + 0] = 1.0f;
+            tangents[v * 4 + 1] = 0.0f;
+            tangents[v * 4 + 2] = 0.0f;
+            tangents[v * 4 + 3] = 1.0f;
+        }
+        for (int i = 0; i < vertexCount * 3; i++) {
+            shortIndices[i] = static_cast<uint16_t>((i * 7 + p) % vertexCount);
+            intIndices[i] = shortIndices[i];
+        }
+        size_t accessor = accessors.size();
+        AppendView(bin, bufferViews, positions.data(), positions.size() * sizeof(float));
+        AppendAccessor(accessors, bufferViews.size() - 1, kFloat, vertexCount, "VEC3");
+        accessors.back()["min"] = {0.0f, 0.0f, 0.0f};
+        accessors.back()["max"] = {1000.0f, 1000.0f, 2.0f};
+        AppendView(bin, bufferViews, normals.data(), normals.size() * sizeof(float));
+        AppendAccessor(accessors, bufferViews.size() - 1, kFloat, vertexCount, "VEC3");
+        AppendView(bin, bufferViews, texCoords.data(), texCoords.size() * sizeof(float));
+        AppendAccessor(accessors, bufferViews.size() - 1, kFloat, vertexCount, "VEC2");
+        AppendView(bin, bufferViews, tangents.data(), tangents.size() * sizeof(float));
+        AppendAccessor(accessors, bufferViews.size() - 1, kFloat, vertexCount, "VEC4");
+        // mix both index widths like exported scenes do
+        if (p % 2 == 0) {
+            AppendView(bin, bufferViews, shortIndices.data(), shortIndices.size() * sizeof(uint16_t));
+            AppendAccessor(accessors, bufferViews.size() - 1, kUnsignedShort, vertexCount * 3, "SCALAR");
+        } else {
+            AppendView(bin, bufferViews, intIndices.data(), intIndices.size() * sizeof(uint32_t));
+            AppendAccessor(accessors, bufferViews.size() - 1, kUnsignedInt, vertexCount * 3, "SCALAR");
+        }
+        nlohmann::json attributes = {
+            {"POSITION", accessor},
+            {"NORMAL", accessor + 1},
+            {"TEXCOORD_0", accessor + 2},
+            {"TANGENT", accessor + 3},
+        };
+        meshes.back()["primitives"].push_back({{"attributes", attributes}, {"indices", accessor + 4}});
+    }
+
+    nlohmann::json document = {
+        {"asset", {{"version", "2.0"}}},
+        {"scene", 0},
+        {"scenes", {{{"nodes", sceneNodes}}}},
+        {"nodes", nodes},
+        {"meshes", meshes},
+        {"accessors", accessors},
+        {"bufferViews", bufferViews},
+        {"buffers", {{{"byteLength", bin.size()}}}},
+    };
+    std::string json = document.dump();
+    json.resize((json.size() + 3) & ~size_t{3}, ' ');
+
+    auto writeU32 = [](std::ofstream &file, uint32_t value) { file.write(reinterpret_cast<const char *>(&value), 4); };
+    std::ofstream file(path, std::ios::binary);
+    writeU32(file, 0x46546C67); // "glTF"
+    writeU32(file, 2);
+    writeU32(file, static_cast<uint32_t>(12 + 8 + json.size() + 8 + bin.size()));
+    writeU32(file, static_cast<uint32_t>(json.size()));
+    writeU32(file, 0x4E4F534A); // "JSON"
+    file.write(json.data(), json.size());
+    writeU32(file, static_cast<uint32_t>(bin.size()));
+    writeU32(file, 0x004E4942); // "BIN\0"
+    file.write(reinterpret_cast<const char *>(bin.data()), bin.size());
+}
+
+// best of kRepeatCount loads, model receives the last one
+static double TimeLoad(const std::string &path,
+                       WorkerPool *workers,
+                       Model *&model,
+                       const VertexFormats &formats = kFloatVertexFormats,
+                       VertexStorage storage = VertexStorage::Interleaved)
+{
+    double ns = BestOfNs(
+        kRepeatCount, [&] { delete model; }, [&] { model = Model::LoadFromFile(path, workers, formats, storage); });
+    return ns * 1e-6;
+}
+
+int main(int argc, char **argv)
+{
+    int primitiveCount = argc > 1 ? std::atoi(argv[1]) : 12000;
+    int vertexCount = argc > 2 ? std::atoi(argv[2]) : 64;
+
+    gdf::Initialize(false);
+    std::string path = (std::filesystem::temp_directory_path() / "gdf_model_load_benchmark.glb").string();
+    WriteSyntheticGlb(path, primitiveCount, vertexCount);
+    std::printf("%d primitives, %d vertices each, %.1f MB\n",
+                primitiveCount,
+                vertexCount,
+                static_cast<double>(std::filesystem::file_size(path)) / (1024.0 * 1024.0));
+
+    Model *serial = nullptr;
+    double serialMs = TimeLoad(path, nullptr, serial);
+    std::printf("%-8s %12s %10s\n", "threads", "ms/load", "speedup");
+    std::printf("%-8s %12.2f %10s\n", "serial", serialMs, "1.00x");
+
+    int result = 0;
+    // powers of two up to every hardware thread
+    uint32_t maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<uint32_t> threadCounts;
+    for (uint32_t threads = 1; threads < maxThreads; threads *= 2)
+        threadCounts.push_back(threads);
+    threadCounts.push_back(maxThreads);
+    for (uint32_t threads : threadCounts) {
+        WorkerPool workers;
+        workers.Create(threads);
+        Model *model = nullptr;
+        double ms = TimeLoad(path, &workers, model);
+        bool same = model->vertexData == serial->vertexData && model->indexData == serial->indexData;
+        std::printf("%-8u %12.2f %9.2fx%s\n", threads, ms, serialMs / ms, same ? "" : "  geometry differs!");
+        if (!same)
+            result = 1;
+        delete model;
+        workers.Destroy();
+    }
+
+    // the compact layout on the serial path, against the float one
+    Model *quantized = nullptr;
+    double quantizedMs = TimeLoad(path, nullptr, quantized, kQuantizedVertexFormats);
+    std::printf("vertex bytes: %u float (%.1f MB), %u quantized (%.1f MB), %.2f ms serial load quantized\n",
+                serial->vertexLayout.stride(),
+                static_cast<double>(serial->vertexData.size()) / (1024.0 * 1024.0),
+                quantized->vertexLayout.stride(),
+                static_cast<double>(quantized->vertexData.size()) / (1024.0 * 1024.0),
+                quantizedMs);
+
+    Model *streams = nullptr;
+    double streamsMs = TimeLoad(path, nullptr, streams, kQuantizedVertexFormats, VertexStorage::Streams);
+    auto begin = std::chrono::steady_clock::now();
+    streams->InterleaveVertices();
+    double interleaveMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    bool same = streams->vertexData == quantized->vertexData;
+    std::printf("%.2f ms serial load to streams, %.2f ms to interleave them%s\n",
+                streamsMs,
+                interleaveMs,
+                same ? "" : "  geometry differs!");
+    if (!same)
+        result = 1;
+    delete streams;
+    delete quantized;
+    delete serial;
+    std::filesystem::remove(path);
+    gdf::Cleanup();
+    return result;
+}
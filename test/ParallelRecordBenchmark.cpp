@@ -0,0 +1,75 @@
+#include "Graphics/Graphics.h"
+#include "gdf.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+using namespace gdf;
+
+// CPU cost of recording the scene pass inline and into secondaries on 1..hardware_concurrency threads.
+//   ParallelRecordBenchmark [thousand draws] [frames]
+// Headless, so it also runs on lavapipe:
+//   VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json ./ParallelRecordBenchmark 20 200
+constexpr VkExtent2D kExtent{640, 480};
+constexpr int kWarmUpFrames = 10;
+
+// Records the main pass into a primary of the current frame slot without submitting it, so only recording is timed
+static double RecordFrames(Graphics &gfx, int frameCount)
+{
+    VkCommandBufferBeginInfo beginInfo{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    };
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frameCount; i++) {
+        gfx.ResetFrameCommandPool();
+        VkCommandBuffer commandBuffer = gfx.AllocateFrameCommandBuffer();
+        VK_ASSERT_SUCCESSED(vkBeginCommandBuffer(commandBuffer, &beginInfo));
+        gfx.RecordMainPass(commandBuffer, 0);
+        VK_ASSERT_SUCCESSED(vkEndCommandBuffer(commandBuffer));
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frameCount;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t drawCount = static_cast<uint32_t>(argc > 1 ? std::atoi(argv[1]) : 20) * 1000;
+    int frameCount = argc > 2 ? std::atoi(argv[2]) : 200;
+    uint32_t maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    gdf::Initialize(false);
+    {
+        Graphics gfx;
+        gfx.Initialize(nullptr, false, kExtent);
+        gfx.sceneDrawCount_ = drawCount;
+        gfx.DeviceWaitIdle();
+
+        std::printf("%u draws, %d frames\n", drawCount, frameCount);
+        std::printf("%-10s %12s %14s %10s\n", "threads", "ms/frame", "draws/ms", "speedup");
+        // 0 is the inline baseline the speedup is measured against, the rest go through secondaries
+        double inlineMs = 0.0;
+        for (uint32_t threadCount = 0; threadCount <= maxThreads; threadCount++) {
+            gfx.SetRecordingThreads(threadCount);
+            RecordFrames(gfx, kWarmUpFrames);
+            double ms = RecordFrames(gfx, frameCount);
+            if (threadCount == 0)
+                inlineMs = ms;
+            std::string name = threadCount == 0 ? "inline" : std::to_string(threadCount);
+            std::printf("%-10s %12.3f %14.1f %9.2fx\n", name.c_str(), ms, drawCount / ms, inlineMs / ms);
+        }
+
+        // the secondaries must also survive a real submission
+        for (int i = 0; i < static_cast<int>(gfx.framesInFlight()) + 1; i++) {
+            gfx.FrameBegin();
+            gfx.DrawFrame();
+            gfx.FrameEnd();
+        }
+        gfx.DeviceWaitIdle();
+        gfx.Cleanup();
+    }
+    gdf::Cleanup();
+    return 0;
+}
@@ -0,0 +1,181 @@
+#include "BestOf.h"
+#include "Graphics/Mesh.h"
+#include "Graphics/VertexStreams.h"
+#include "gdf.h"
+#include <algorithm>
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace gdf;
+
+// Runs two CPU passes over a skinned mesh, a bounding box and linear blend skinning of positions and normals, once
+// over the interleaved float vertices the loader uploads and once over the per-attribute streams. Both layouts hold
+// the same floats and go through the same per-vertex code, so the results must agree to the bit and the difference
+// is only what the passes drag through the cache. The default count is past the last level cache of most CPUs.
+//   VertexStreamsBenchmark [vertices]
+constexpr int kRepeatCount = 5;
+constexpr uint32_t kJointCount = 64;
+
+template <typename Function>
+static double BestNsPerVertex(uint32_t count, Function &&function)
+{
+    return BestOfNs(kRepeatCount, function) / count;
+}
+
+struct Bounds {
+    glm::vec3 min{FLT_MAX};
+    glm::vec3 max{-FLT_MAX};
+};
+
+static void Grow(Bounds &bounds, const float *position)
+{
+    for (int c = 0; c < 3; c++) {
+        bounds.min[c] = std::min(bounds.min[c], position[c]);
+        bounds.max[c] = std::max(bounds.max[c], position[c]);
+    }
+}
+
+static void SkinVertex(const glm::mat4 *joints,
+                       const float *position,
+                       const float *normal,
+                       const float *joint,
+                       const float *weight,
+                       float *skinnedPosition,
+                       float *skinnedNormal)
+{
+    glm::mat4 skin = joints[static_cast<uint32_t>(joint[0])] * weight[0] +
+                     joints[static_cast<uint32_t>(joint[1])] * weight[1] +
+                     joints[static_cast<uint32_t>(joint[2])] * weight[2] +
+                     joints[static_cast<uint32_t>(joint[3])] * weight[3];
+    glm::vec3 p(skin * glm::vec4(glm::make_vec3(position), 1.0f));
+    glm::vec3 n = glm::normalize(glm::mat3(skin) * glm::make_vec3(normal));
+    std::memcpy(skinnedPosition, glm::value_ptr(p), sizeof(p));
+    std::memcpy(skinnedNormal, glm::value_ptr(n), sizeof(n));
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t count = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 1u << 20;
+    gdf::Initialize(false);
+
+    // every attribute a skinned glTF mesh has
+    uint32_t components = 0;
+    for (uint32_t i = 0; i < kVertexComponentCount; i++)
+        components |= VertexLayout::ComponentBit(static_cast<Vertex::Component>(i));
+    VertexStreams streams(components, count);
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    for (uint32_t i = 0; i < kVertexComponentCount; i++) {
+        Vertex::Component component = static_cast<Vertex::Component>(i);
+        float *stream = streams.Stream(component);
+        for (size_t v = 0; v < static_cast<size_t>(count) * VertexLayout::ComponentCount(component); v++)
+            stream[v] = unit(random) * 10.0f;
+    }
+    float *normals = streams.Stream(Vertex::Component::Normal);
+    float *joints = streams.Stream(Vertex::Component::Joint0);
+    float *weights = streams.Stream(Vertex::Component::Weight0);
+    for (size_t v = 0; v < count; v++) {
+        glm::vec3 normal = glm::normalize(glm::make_vec3(normals + v * 3) + glm::vec3(0.0f, 0.0f, 0.01f));
+        std::memcpy(normals + v * 3, glm::value_ptr(normal), sizeof(normal));
+        float sum = 0.0f;
+        for (int k = 0; k < 4; k++) {
+            joints[v * 4 + k] = static_cast<float>(random() % kJointCount);
+            weights[v * 4 + k] = unit(random) * 0.5f + 0.5f;
+            sum += weights[v * 4 + k];
+        }
+        for (int k = 0; k < 4; k++)
+            weights[v * 4 + k] /= sum;
+    }
+    std::vector<glm::mat4> jointMatrices(kJointCount);
+    for (glm::mat4 &matrix : jointMatrices) {
+        matrix = glm::mat4(1.0f);
+        for (int column = 0; column < 4; column++)
+            for (int row = 0; row < 3; row++)
+                matrix[column][row] += unit(random) * 0.1f;
+    }
+
+    VertexLayout layout(components, kFloatVertexFormats);
+    std::vector<uint8_t> vertices(static_cast<size_t>(count) * layout.stride());
+    streams.Interleave(layout, 0, count, glm::vec3(0.0f), glm::vec3(1.0f), vertices.data());
+    uint32_t stride = layout.stride();
+    uint32_t positionOffset = layout.Find(Vertex::Component::Position)->offset;
+    uint32_t normalOffset = layout.Find(Vertex::Component::Normal)->offset;
+    uint32_t jointOffset = layout.Find(Vertex::Component::Joint0)->offset;
+    uint32_t weightOffset = layout.Find(Vertex::Component::Weight0)->offset;
+    auto attributeOf = [&](const std::vector<uint8_t> &data, size_t vertex, uint32_t offset) {
+        return reinterpret_cast<const float *>(data.data() + vertex * stride + offset);
+    };
+    const float *positions = streams.Stream(Vertex::Component::Position);
+
+    std::printf("%u vertices, %u bytes interleaved, %u joints\n", count, stride, kJointCount);
+    std::printf("%-10s %12s %15s   (ns per vertex, speedup)\n", "pass", "interleaved", "streams");
+    int result = 0;
+
+    Bounds interleavedBounds;
+    double interleavedNs = BestNsPerVertex(count, [&] {
+        interleavedBounds = Bounds{};
+        for (size_t v = 0; v < count; v++)
+            Grow(interleavedBounds, attributeOf(vertices, v, positionOffset));
+    });
+    Bounds streamBounds;
+    double streamNs = BestNsPerVertex(count, [&] {
+        streamBounds = Bounds{};
+        for (size_t v = 0; v < count; v++)
+            Grow(streamBounds, positions + v * 3);
+    });
+    bool same = std::memcmp(&interleavedBounds, &streamBounds, sizeof(Bounds)) == 0;
+    std::printf("%-10s %12.2f %6.2f (%5.2fx)%s\n",
+                "bounds",
+                interleavedNs,
+                streamNs,
+                interleavedNs / streamNs,
+                same ? "" : "  results differ!");
+    if (!same)
+        result = 1;
+
+    // the interleaved pass writes the vertices it read, the streamed one its own position and normal streams
+    std::vector<uint8_t> skinnedVertices = vertices;
+    std::vector<float> skinnedPositions(static_cast<size_t>(count) * 3);
+    std::vector<float> skinnedNormals(static_cast<size_t>(count) * 3);
+    interleavedNs = BestNsPerVertex(count, [&] {
+        for (size_t v = 0; v < count; v++) {
+            uint8_t *vertex = skinnedVertices.data() + v * stride;
+            SkinVertex(jointMatrices.data(),
+                       attributeOf(vertices, v, positionOffset),
+                       attributeOf(vertices, v, normalOffset),
+                       attributeOf(vertices, v, jointOffset),
+                       attributeOf(vertices, v, weightOffset),
+                       reinterpret_cast<float *>(vertex + positionOffset),
+                       reinterpret_cast<float *>(vertex + normalOffset));
+        }
+    });
+    streamNs = BestNsPerVertex(count, [&] {
+        for (size_t v = 0; v < count; v++)
+            SkinVertex(jointMatrices.data(),
+                       positions + v * 3,
+                       normals + v * 3,
+                       joints + v * 4,
+                       weights + v * 4,
+                       skinnedPositions.data() + v * 3,
+                       skinnedNormals.data() + v * 3);
+    });
+    same = true;
+    for (size_t v = 0; v < count && same; v++)
+        same = std::memcmp(attributeOf(skinnedVertices, v, positionOffset), &skinnedPositions[v * 3], 12) == 0 &&
+               std::memcmp(attributeOf(skinnedVertices, v, normalOffset), &skinnedNormals[v * 3], 12) == 0;
+    std::printf("%-10s %12.2f %6.2f (%5.2fx)%s\n",
+                "skinning",
+                interleavedNs,
+                streamNs,
+                interleavedNs / streamNs,
+                same ? "" : "  results differ!");
+    if (!same)
+        result = 1;
+
+    gdf::Cleanup();
+    return result;
+}
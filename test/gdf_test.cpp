@@ -1,9 +1,42 @@
 #define CATCH_CONFIG_RUNNER
+#include "Base/LinearArena.h"
+#include "Base/MappedFile.h"
+#include "Base/MessageQueue.h"
+#include "Base/OffsetAllocator.h"
+#include "Base/Pool.h"
+#include "Base/WorkerPool.h"
+#include "DeveloperTool/CpuProfiler.h"
+#include "DeveloperTool/DeveloperConsole.h"
+#include "Graphics/AccessorDecode.h"
+#include "Graphics/Mesh.h"
+#include "Graphics/VertexLayout.h"
+#include "Graphics/VertexStreams.h"
 #include "Log//LogCategory.h"
 #include "Log//LogLevel.h"
+#include "Log/BinaryLog.h"
+#include "Log/FileSink.h"
 #include "Log/Logger.h"
+#include "Log/StdSink.h"
 #include "gdf.h"
 #include <catch2/catch.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fmt/core.h>
+#include <fstream>
+#include <glm/gtc/packing.hpp>
+#include <glm/packing.hpp>
+#include <map>
+#include <nlohmann/json.hpp>
+#include <random>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 using namespace gdf;
 
@@ -175,10 +208,988 @@ TEST_CASE("LogCategory - Runtime log levels", "[gdf][LogCategory]")
     gdf::Logger::instance().DeregisterSink(&testSink);
 }
 
+class CountSink : public LogSink
+{
+public:
+    virtual void Log(const LogCategory *category, const LogLevel level, const std::string_view message)
+    {
+        count_++;
+        if (level == LogLevel::Error)
+            errorCount_++;
+        lastLog_ = message;
+    }
+    void Exception()
+    {
+        exceptionCount_++;
+    }
+
+    size_t count_{0};
+    size_t errorCount_{0};
+    size_t exceptionCount_{0};
+    std::string lastLog_;
+};
+
+GDF_DECLARE_LOG_CATEGORY(AsyncCategory, LogLevel::All, LogLevel::All)
+GDF_DEFINE_LOG_CATEGORY(AsyncCategory)
+
+TEST_CASE("Logger - Async mode", "[gdf][Logger]")
+{
+    CountSink countSink;
+    gdf::Logger::instance().DeregisterSink(&coutSink);
+    gdf::Logger::instance().RegisterSink(&countSink);
+    SECTION("Delivers every record after Flush")
+    {
+        gdf::Logger::instance().EnableAsync(64, LogOverflowPolicy::Block);
+        REQUIRE(gdf::Logger::instance().isAsync());
+        std::vector<std::thread> producers;
+        for (int t = 0; t < 4; t++) {
+            producers.emplace_back([t] {
+                for (int i = 0; i < 1000; i++)
+                    GDF_LOG(AsyncCategory, LogLevel::Info, "thread {} message {}", t, i);
+            });
+        }
+        for (auto &producer : producers)
+            producer.join();
+        gdf::Logger::instance().Flush();
+        REQUIRE(countSink.count_ == 4000);
+        REQUIRE(gdf::Logger::instance().droppedCount() == 0);
+    }
+    SECTION("Fatal flushes before Exception")
+    {
+        gdf::Logger::instance().EnableAsync(64, LogOverflowPolicy::Block);
+        for (int i = 0; i < 100; i++)
+            GDF_LOG(AsyncCategory, LogLevel::Info, "message {}", i);
+        GDF_LOG(AsyncCategory, LogLevel::Fatal, "Fatal");
+        REQUIRE(countSink.count_ == 101);
+        REQUIRE(countSink.lastLog_ == "Fatal");
+        REQUIRE(countSink.exceptionCount_ == 1);
+    }
+    SECTION("Drop and overwrite keep memory bounded")
+    {
+        auto policy = GENERATE(LogOverflowPolicy::Drop, LogOverflowPolicy::Overwrite);
+        gdf::Logger::instance().EnableAsync(4, policy);
+        for (int i = 0; i < 10000; i++)
+            GDF_LOG(AsyncCategory, LogLevel::Info, "message {}", i);
+        gdf::Logger::instance().Flush();
+        REQUIRE(countSink.count_ + gdf::Logger::instance().droppedCount() == 10000);
+        // overwrite only ever discards the oldest record
+        if (policy == LogOverflowPolicy::Overwrite)
+            REQUIRE(countSink.lastLog_ == "message 9999");
+    }
+    SECTION("Drop keeps errors")
+    {
+        gdf::Logger::instance().EnableAsync(4, LogOverflowPolicy::Drop);
+        for (int i = 0; i < 10000; i++) {
+            GDF_LOG(AsyncCategory, LogLevel::Info, "message {}", i);
+            if (i % 100 == 0)
+                GDF_LOG(AsyncCategory, LogLevel::Error, "error {}", i);
+        }
+        gdf::Logger::instance().Flush();
+        REQUIRE(countSink.errorCount_ == 100);
+        REQUIRE(countSink.count_ + gdf::Logger::instance().droppedCount() == 10100);
+    }
+    gdf::Logger::instance().DisableAsync();
+    REQUIRE_FALSE(gdf::Logger::instance().isAsync());
+    gdf::Logger::instance().DeregisterSink(&countSink);
+    gdf::Logger::instance().RegisterSink(&coutSink);
+}
+
+TEST_CASE("Logger - Deferred formatting", "[gdf][Logger]")
+{
+    CountSink countSink;
+    gdf::Logger::instance().DeregisterSink(&coutSink);
+    gdf::Logger::instance().RegisterSink(&countSink);
+    gdf::Logger::instance().deferredFormatting(true);
+    std::string name = "swapchain";
+    SECTION("Text sinks get the formatted message")
+    {
+        bool async = GENERATE(false, true);
+        if (async)
+            gdf::Logger::instance().EnableAsync(64, LogOverflowPolicy::Block);
+        GDF_LOG(AsyncCategory, LogLevel::Info, "{} {} {:.2f} {} {}", name, 42, 1.5f, -7LL, "done");
+        gdf::Logger::instance().Flush();
+        REQUIRE(countSink.count_ == 1);
+        REQUIRE(countSink.lastLog_ == "swapchain 42 1.50 -7 done");
+    }
+    SECTION("Runtime formats are formatted at once")
+    {
+        gdf::Logger::instance().EnableAsync(64, LogOverflowPolicy::Block);
+        char format[16];
+        std::snprintf(format, sizeof(format), "{} of {}");
+        GDF_LOG(AsyncCategory, LogLevel::Info, std::string_view{format}, 1, 2);
+        // the record must not depend on the buffer once GDF_LOG returns
+        std::memset(format, 0, sizeof(format));
+        gdf::Logger::instance().Flush();
+        REQUIRE(countSink.count_ == 1);
+        REQUIRE(countSink.lastLog_ == "1 of 2");
+    }
+    SECTION("Binary sink round trip")
+    {
+        std::string path = "gdf_test_binary.log";
+        std::string expected;
+        {
+            BinaryFileSink binarySink(path);
+            REQUIRE(binarySink.isOpen());
+            gdf::Logger::instance().RegisterSink(&binarySink);
+            for (int i = 0; i < 3; i++) {
+                GDF_LOG(AsyncCategory, LogLevel::Warning, "{} frame {} took {:.3f}ms ({})", name, i, 16.6 + i, std::string_view{"late"});
+                expected += fmt::format("[AsyncCategory][Warning] {} frame {} took {:.3f}ms ({})\n", name, i, 16.6 + i, "late");
+            }
+            GDF_LOG(AsyncCategory, LogLevel::Error, "no arguments");
+            expected += "[AsyncCategory][Error] no arguments\n";
+            gdf::Logger::instance().DeregisterSink(&binarySink);
+        }
+        REQUIRE(countSink.count_ == 4);
+        std::ifstream in(path, std::ios::binary);
+        std::ostringstream out;
+        REQUIRE(DecodeBinaryLog(in, out));
+        REQUIRE(out.str() == expected);
+        in.close();
+        std::remove(path.c_str());
+    }
+    gdf::Logger::instance().DisableAsync();
+    gdf::Logger::instance().deferredFormatting(false);
+    gdf::Logger::instance().DeregisterSink(&countSink);
+    gdf::Logger::instance().RegisterSink(&coutSink);
+}
+
+TEST_CASE("BinaryLog - Corrupted records", "[gdf][BinaryLog]")
+{
+    std::string stream("GDFBLOG1", 8);
+    auto append = [&](const auto &value) { stream.append(reinterpret_cast<const char *>(&value), sizeof(value)); };
+    auto appendRecord = [&](uint32_t formatId, const std::vector<uint8_t> &args) {
+        stream += 'R';
+        append(uint32_t{0});
+        append(LogLevel::Warning);
+        append(formatId);
+        append(static_cast<uint16_t>(args.size()));
+        stream.append(reinterpret_cast<const char *>(args.data()), args.size());
+    };
+    stream += 'C';
+    append(uint32_t{0});
+    append(uint16_t{4});
+    stream += "Test";
+    const std::string format = "{} {}";
+    stream += 'F';
+    append(uint32_t{0});
+    append(static_cast<uint32_t>(format.size()));
+    stream += format;
+    // an Int32 cut off after two of its bytes
+    appendRecord(0, {static_cast<uint8_t>(LogArgType::Int32), 1, 2});
+    // a string claiming 100 bytes with 3 left
+    appendRecord(0, {static_cast<uint8_t>(LogArgType::String), 100, 0, 'a', 'b', 'c'});
+    // well formed but one argument short of the format
+    appendRecord(0, {static_cast<uint8_t>(LogArgType::Char), 'x'});
+
+    std::istringstream in(stream);
+    std::ostringstream out;
+    REQUIRE(DecodeBinaryLog(in, out));
+    std::string corrupted = "[Test][Warning] <corrupted log arguments for \"{} {}\">\n";
+    REQUIRE(out.str() == corrupted + corrupted + corrupted);
+}
+
+static std::string ReadText(const std::string &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream out;
+    out << in.rdbuf();
+    return out.str();
+}
+
+TEST_CASE("FileSink - Rotation", "[gdf][FileSink]")
+{
+    std::string path = "gdf_test_file.log";
+    // every line has the same length, so three of them fill the file
+    std::string line = "[AsyncCategory][Info] message 0\n";
+    {
+        FileSink fileSink(path, line.size() * 3, std::chrono::seconds::zero(), 2);
+        REQUIRE(fileSink.isOpen());
+        gdf::Logger::instance().RegisterSink(&fileSink);
+        for (int i = 0; i < 8; i++)
+            GDF_LOG(AsyncCategory, LogLevel::Info, "message {}", i);
+        REQUIRE(fileSink.usedSize() == line.size() * 2);
+        gdf::Logger::instance().DeregisterSink(&fileSink);
+    }
+    REQUIRE(ReadText(path) == "[AsyncCategory][Info] message 6\n[AsyncCategory][Info] message 7\n");
+    REQUIRE(ReadText(path + ".1") ==
+            "[AsyncCategory][Info] message 3\n[AsyncCategory][Info] message 4\n[AsyncCategory][Info] message 5\n");
+    REQUIRE(ReadText(path + ".2") ==
+            "[AsyncCategory][Info] message 0\n[AsyncCategory][Info] message 1\n[AsyncCategory][Info] message 2\n");
+    REQUIRE_FALSE(std::filesystem::exists(path + ".3"));
+    std::filesystem::remove(path);
+    std::filesystem::remove(path + ".1");
+    std::filesystem::remove(path + ".2");
+}
+
+TEST_CASE("MappedFile - Read only", "[gdf][MappedFile]")
+{
+    std::string path = "gdf_test_mapped.bin";
+    std::string text = "glTF binary chunk";
+    std::ofstream(path, std::ios::binary) << text;
+    {
+        MappedFile file;
+        REQUIRE(file.OpenRead(path));
+        REQUIRE(file.size() == text.size());
+        REQUIRE(std::string(file.data(), file.size()) == text);
+        // closing a read-only mapping leaves the file as it was
+        file.Close(0);
+        REQUIRE_FALSE(file.isOpen());
+    }
+    REQUIRE(ReadText(path) == text);
+    MappedFile missing;
+    REQUIRE_FALSE(missing.OpenRead(path + ".missing"));
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("MappedFile - Truncate on close", "[gdf][MappedFile]")
+{
+    std::string path = "gdf_test_mapped.bin";
+    std::string text = "binary log records";
+    {
+        MappedFile file;
+        REQUIRE(file.Open(path, 64 * 1024));
+        REQUIRE(std::filesystem::file_size(path) == 64 * 1024);
+        std::memcpy(file.data(), text.data(), text.size());
+        REQUIRE(file.Close(text.size()));
+    }
+    REQUIRE(ReadText(path) == text);
+    MappedFile unreachable;
+    REQUIRE_FALSE(unreachable.Open("gdf_test_missing_directory/mapped.bin", 4096));
+    std::filesystem::remove(path);
+}
+
+// Counts every heap allocation made by the test process, including the ones in the library
+static std::atomic<size_t> allocationCount{0};
+
+// The plain, array and nothrow forms all allocate with malloc and free with free. One left to the runtime would free
+// these blocks with its own allocator, or these free its blocks. The aligned forms stay paired within the runtime.
+static void *CountedAllocate(size_t size) noexcept
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size != 0 ? size : 1);
+}
+
+void *operator new(size_t size)
+{
+    if (void *pointer = CountedAllocate(size))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+    if (void *pointer = CountedAllocate(size))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    return CountedAllocate(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+    return CountedAllocate(size);
+}
+
+// noinline keeps GCC from pairing new expressions with the frees below and warning about it
+[[gnu::noinline]] void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+[[gnu::noinline]] void operator delete[](void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+[[gnu::noinline]] void operator delete(void *pointer, size_t) noexcept
+{
+    std::free(pointer);
+}
+
+[[gnu::noinline]] void operator delete[](void *pointer, size_t) noexcept
+{
+    std::free(pointer);
+}
+
+[[gnu::noinline]] void operator delete(void *pointer, const std::nothrow_t &) noexcept
+{
+    std::free(pointer);
+}
+
+[[gnu::noinline]] void operator delete[](void *pointer, const std::nothrow_t &) noexcept
+{
+    std::free(pointer);
+}
+
+TEST_CASE("DeveloperConsole - History", "[gdf][DeveloperConsole]")
+{
+    constexpr size_t kMaxEntries = 1000;
+    constexpr size_t kMessageCount = 1000000;
+    DeveloperConsole console(kMaxEntries);
+    REQUIRE(console.memoryUsage() >= kMaxEntries * DeveloperConsole::kArenaBytesPerEntry);
+    // lengths spread around the per entry budget so the arena, not maxEntries, limits the history at times
+    static const std::string padding(600, '.');
+    auto message = [](size_t i, char *buffer, size_t bufferSize) {
+        auto result = fmt::format_to_n(buffer, bufferSize, "message {} {}", i, std::string_view{padding}.substr(0, i % 500));
+        return std::string_view{buffer, result.size};
+    };
+    char buffer[1024];
+    size_t allocations = allocationCount.load();
+    for (size_t i = 0; i < kMessageCount; i++)
+        console.Log(AsyncCategory::instance(), LogLevel::Info, message(i, buffer, sizeof(buffer)));
+    REQUIRE(allocationCount.load() == allocations);
+
+    size_t count = console.entryCount();
+    REQUIRE(count > 0);
+    REQUIRE(count <= kMaxEntries);
+    char expected[1024];
+    size_t index = 0;
+    console.ForEachEntry([&](const DeveloperConsole::EntryView &entry) {
+        REQUIRE(entry.category == AsyncCategory::instance());
+        REQUIRE(entry.message == message(kMessageCount - count + index++, expected, sizeof(expected)));
+    });
+    REQUIRE(index == count);
+
+    // shrinking keeps the newest entries that fit in the smaller arena
+    console.maxEntries(10);
+    count = console.entryCount();
+    REQUIRE(count > 0);
+    REQUIRE(count <= 10);
+    std::string newest;
+    console.ForEachEntry([&](const DeveloperConsole::EntryView &entry) { newest = entry.message; });
+    REQUIRE(newest == message(kMessageCount - 1, expected, sizeof(expected)));
+
+    // an empty message takes no arena bytes but shares its offset with the next entry. Once the write offset wraps
+    // around to it, that next entry must still be overwritten only after it has left the history.
+    DeveloperConsole small(8);
+    const std::string filler(DeveloperConsole::kArenaBytesPerEntry * 8 / 2 - 24, 'x');
+    const std::string messages[] = {filler, "", filler + "y", std::string(filler.size(), 'z'), "w"};
+    size_t logged = 0;
+    bool intact = true;
+    for (const std::string &text : messages) {
+        small.Log(AsyncCategory::instance(), LogLevel::Info, text);
+        logged++;
+        size_t j = logged - small.entryCount();
+        small.ForEachEntry([&](const DeveloperConsole::EntryView &entry) {
+            intact = intact && entry.message == messages[j++];
+        });
+    }
+    REQUIRE(intact);
+}
+
+TEST_CASE("MessageCollector - Multiple producers", "[gdf][MessageCollector]")
+{
+    constexpr int kProducerCount = 4;
+    constexpr int kMessagesPerProducer = 250000;
+    MessageCollector collector(256);
+    REQUIRE(collector.capacity() == 256);
+    std::vector<std::thread> producers;
+    for (int t = 0; t < kProducerCount; t++) {
+        producers.emplace_back([t, &collector] {
+            char buffer[32];
+            for (int i = 0; i < kMessagesPerProducer; i++) {
+                auto result = fmt::format_to_n(buffer, sizeof(buffer), "{} {}", t, i);
+                while (!collector.AddMessage(std::string_view{buffer, result.size}))
+                    std::this_thread::yield();
+            }
+        });
+    }
+    // each producer's messages must come out in order and none may be lost
+    std::vector<int> next(kProducerCount, 0);
+    size_t received = 0;
+    bool ordered = true;
+    while (received < kProducerCount * kMessagesPerProducer) {
+        size_t drained = collector.Drain([&](std::string_view message) {
+            int t = message[0] - '0';
+            ordered = ordered && message.substr(2) == std::to_string(next[t]);
+            next[t]++;
+        });
+        if (drained == 0)
+            std::this_thread::yield();
+        received += drained;
+    }
+    for (auto &producer : producers)
+        producer.join();
+    REQUIRE(ordered);
+    REQUIRE(collector.Drain([](std::string_view) {}) == 0);
+    for (int t = 0; t < kProducerCount; t++)
+        REQUIRE(next[t] == kMessagesPerProducer);
+
+    std::string longMessage(MessageCollector::kMaxMessageSize + 10, 'x');
+    REQUIRE(collector.AddMessage(longMessage));
+    collector.Drain([](std::string_view message) { REQUIRE(message.size() == MessageCollector::kMaxMessageSize); });
+}
+
+struct PoolObject {
+    static inline std::atomic<int> alive{0};
+    PoolObject(int value) : value(value), name(std::to_string(value))
+    {
+        alive++;
+    }
+    ~PoolObject()
+    {
+        alive--;
+    }
+    int value;
+    std::string name;
+};
+
+TEST_CASE("ObjectPool - Allocate and release", "[gdf][Pool]")
+{
+    SECTION("Single thread")
+    {
+        ObjectPool<PoolObject, 64> pool;
+        std::vector<PoolObject *> objects;
+        for (int i = 0; i < 1000; i++)
+            objects.push_back(pool.New(i));
+        REQUIRE(PoolObject::alive == 1000);
+        REQUIRE(pool.size() == 1000);
+        REQUIRE(pool.capacity() == 1024);
+        // a freed slot is the next one handed out
+        PoolObject *freed = objects[500];
+        pool.Delete(freed);
+        REQUIRE(PoolObject::alive == 999);
+        PoolObject *reused = pool.New(-1);
+        REQUIRE(reused == freed);
+        REQUIRE(objects[499]->name == "499");
+        REQUIRE(objects[501]->name == "501");
+        pool.Release();
+        REQUIRE(PoolObject::alive == 0);
+        REQUIRE(pool.size() == 0);
+        REQUIRE(pool.capacity() == 0);
+    }
+    SECTION("Per thread caches")
+    {
+        SharedObjectPool<PoolObject, 64, 16> pool;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; t++) {
+            threads.emplace_back([t, &pool] {
+                SharedObjectPool<PoolObject, 64, 16>::Cache cache(pool);
+                std::vector<PoolObject *> objects;
+                for (int i = 0; i < 10000; i++)
+                    objects.push_back(cache.New(t * 10000 + i));
+                for (int i = 0; i < 10000; i += 2)
+                    cache.Delete(objects[i]);
+            });
+        }
+        for (auto &thread : threads)
+            thread.join();
+        REQUIRE(PoolObject::alive == 20000);
+        pool.Release();
+        REQUIRE(PoolObject::alive == 0);
+    }
+}
+
+TEST_CASE("LinearArena - Frame reuse", "[gdf][LinearArena]")
+{
+    LinearArena arena(1024);
+    void *first = arena.Allocate(10, 1);
+    auto *aligned = arena.Allocate(8, 64);
+    REQUIRE(reinterpret_cast<uintptr_t>(aligned) % 64 == 0);
+    // larger than a block gets a block of its own
+    void *large = arena.Allocate(4096);
+    REQUIRE(large != nullptr);
+    REQUIRE(arena.used() == 10 + 8 + 4096);
+    size_t capacity = arena.capacity();
+
+    size_t allocations = allocationCount.load();
+    for (int frame = 0; frame < 100; frame++) {
+        arena.Reset();
+        REQUIRE(arena.Allocate(10, 1) == first);
+        ArenaVector<int> values{arena};
+        for (int i = 0; i < 200; i++)
+            values.push_back(i);
+        REQUIRE(values[199] == 199);
+    }
+    REQUIRE(arena.capacity() == capacity);
+    REQUIRE(allocationCount.load() == allocations);
+}
+
+TEST_CASE("OffsetAllocator - Mixed allocations", "[gdf][OffsetAllocator]")
+{
+    constexpr uint64_t kSize = 1024ull * 1024 * 1024;
+    constexpr size_t kMaxLive = 512;
+    OffsetAllocator allocator(kSize);
+    struct Live {
+        OffsetAllocator::Allocation allocation;
+        uint64_t size;
+    };
+    std::vector<Live> live;
+    std::mt19937 random(1234);
+    size_t failed = 0;
+    bool aligned = true;
+    for (int i = 0; i < 100000; i++) {
+        if (live.size() == kMaxLive || (!live.empty() && random() % 2 == 0)) {
+            size_t index = random() % live.size();
+            allocator.Free(live[index].allocation);
+            live[index] = live.back();
+            live.pop_back();
+            continue;
+        }
+        // mostly small buffers, some textures, the occasional large attachment
+        uint64_t size = random() % 100 < 90 ? 256 + random() % (64 * 1024) : 1024 * 1024 + random() % (8 * 1024 * 1024);
+        uint64_t alignment = uint64_t{1} << (random() % 17);
+        auto allocation = allocator.Allocate(size, alignment);
+        if (!allocation.valid()) {
+            failed++;
+            continue;
+        }
+        aligned = aligned && allocation.offset % alignment == 0;
+        live.push_back(Live{allocation, size});
+    }
+    REQUIRE(aligned);
+    // a steady state of about a quarter of the range in use never runs out of space
+    REQUIRE(failed == 0);
+
+    std::vector<Live> sorted = live;
+    std::sort(sorted.begin(), sorted.end(), [](const Live &a, const Live &b) {
+        return a.allocation.offset < b.allocation.offset;
+    });
+    bool overlapping = false;
+    uint64_t usedSize = 0;
+    for (size_t i = 0; i < sorted.size(); i++) {
+        usedSize += sorted[i].size;
+        if (i > 0 && sorted[i - 1].allocation.offset + sorted[i - 1].size > sorted[i].allocation.offset)
+            overlapping = true;
+    }
+    REQUIRE_FALSE(overlapping);
+    REQUIRE(sorted.back().allocation.offset + sorted.back().size <= kSize);
+
+    auto statistics = allocator.statistics();
+    REQUIRE(statistics.allocationCount == live.size());
+    REQUIRE(statistics.usedSize == usedSize);
+    REQUIRE(statistics.largestFreeRange <= statistics.freeSize);
+
+    for (auto &entry : live)
+        allocator.Free(entry.allocation);
+    statistics = allocator.statistics();
+    REQUIRE(allocator.empty());
+    REQUIRE(statistics.freeRangeCount == 1);
+    REQUIRE(statistics.largestFreeRange == kSize);
+    REQUIRE(statistics.fragmentation() == 0.0f);
+}
+
+TEST_CASE("WorkerPool - Parallel for", "[gdf][WorkerPool]")
+{
+    WorkerPool workers;
+    workers.Create(4);
+    REQUIRE(workers.threadCount() == 4);
+    std::vector<uint32_t> runs(10007, 0);
+    // Catch2 assertions aren't thread safe, the workers only record what they saw
+    std::atomic<bool> oversizedChunk{false};
+    for (int job = 0; job < 3; job++) {
+        workers.ParallelFor(static_cast<uint32_t>(runs.size()), 7, [&](uint32_t first, uint32_t last) {
+            if (last - first > 7)
+                oversizedChunk = true;
+            for (uint32_t i = first; i < last; i++)
+                runs[i]++;
+        });
+    }
+    REQUIRE_FALSE(oversizedChunk);
+    REQUIRE(std::all_of(runs.begin(), runs.end(), [](uint32_t count) { return count == 3; }));
+
+    // the first exception reaches the caller and the pool stays usable
+    REQUIRE_THROWS_AS(workers.ParallelFor(1000,
+                                          1,
+                                          [](uint32_t first, uint32_t) {
+                                              if (first == 500)
+                                                  throw std::runtime_error("item failed");
+                                          }),
+                      std::runtime_error);
+    std::atomic<uint32_t> itemCount{0};
+    workers.ParallelFor(100, 3, [&](uint32_t first, uint32_t last) { itemCount += last - first; });
+    REQUIRE(itemCount == 100);
+    workers.Destroy();
+}
+
+TEST_CASE("AccessorDecode - Kernel sets agree", "[gdf][AccessorDecode]")
+{
+    constexpr uint32_t kCount = 103;
+    constexpr size_t kStride = 20;
+    std::mt19937 random(7);
+    std::vector<uint8_t> source(kCount * kStride);
+    for (auto &byte : source)
+        byte = static_cast<uint8_t>(random());
+    // every kernel reads float components, keep them finite
+    for (uint32_t i = 0; i < kCount * kStride / sizeof(float); i++) {
+        float value = static_cast<float>(random() % 2001) / 100.0f - 10.0f;
+        std::memcpy(source.data() + i * sizeof(float), &value, sizeof(float));
+    }
+    std::vector<uint8_t> floatSource = source;
+    for (auto &byte : source)
+        byte = static_cast<uint8_t>(random());
+
+    const int componentTypes[] = {
+        kComponentByte, kComponentUnsignedByte, kComponentShort, kComponentUnsignedShort, kComponentFloat};
+    AccessorKernelSet original = accessorKernelSet();
+    for (int componentType : componentTypes) {
+        for (uint32_t componentCount = 1; componentCount <= 4; componentCount++) {
+            for (bool normalized : {false, true}) {
+                AccessorStream stream{
+                    .data = componentType == kComponentFloat ? floatSource.data() : source.data(),
+                    .stride = kStride,
+                    .componentType = componentType,
+                    .componentCount = componentCount,
+                    .normalized = normalized,
+                };
+                std::vector<float> expected(kCount * 4);
+                REQUIRE(SetAccessorKernelSet(AccessorKernelSet::Scalar));
+                DecodeAccessor(stream, expected.data(), 4 * sizeof(float), 4, kCount);
+                for (auto kernelSet : {AccessorKernelSet::SSE41, AccessorKernelSet::AVX2}) {
+                    if (!SetAccessorKernelSet(kernelSet))
+                        continue;
+                    std::vector<float> decoded(kCount * 4);
+                    DecodeAccessor(stream, decoded.data(), 4 * sizeof(float), 4, kCount);
+                    INFO(AccessorKernelSetName(kernelSet) << " type " << componentType << " x" << componentCount);
+                    REQUIRE(std::memcmp(decoded.data(), expected.data(), decoded.size() * sizeof(float)) == 0);
+                }
+            }
+        }
+    }
+
+    // normalized ends of the range, missing components widen to (0, 0, 0, 1)
+    const uint8_t bytes[] = {255, 0, 128, 0x80};
+    float color[4];
+    REQUIRE(SetAccessorKernelSet(original));
+    DecodeAccessor({.data = bytes, .stride = 4, .componentType = kComponentUnsignedByte, .componentCount = 2,
+                    .normalized = true},
+                   color,
+                   sizeof(color),
+                   4,
+                   1);
+    REQUIRE(color[0] == 1.0f);
+    REQUIRE(color[1] == 0.0f);
+    REQUIRE(color[2] == 0.0f);
+    REQUIRE(color[3] == 1.0f);
+    DecodeAccessor({.data = bytes + 3, .stride = 1, .componentType = kComponentByte, .componentCount = 1,
+                    .normalized = true},
+                   color,
+                   sizeof(color),
+                   1,
+                   1);
+    REQUIRE(color[0] == -1.0f);
+
+    for (int componentType : {kComponentUnsignedByte, kComponentUnsignedShort, kComponentUnsignedInt}) {
+        std::vector<uint32_t> expected(kCount);
+        REQUIRE(SetAccessorKernelSet(AccessorKernelSet::Scalar));
+        WidenIndices(source.data(), componentType, kCount, 1000, expected.data());
+        for (auto kernelSet : {AccessorKernelSet::SSE41, AccessorKernelSet::AVX2}) {
+            if (!SetAccessorKernelSet(kernelSet))
+                continue;
+            std::vector<uint32_t> widened(kCount);
+            WidenIndices(source.data(), componentType, kCount, 1000, widened.data());
+            REQUIRE(widened == expected);
+        }
+        if (componentType == kComponentUnsignedShort)
+            REQUIRE(expected[1] == (source[2] | source[3] << 8) + 1000u);
+    }
+    SetAccessorKernelSet(original);
+}
+
+TEST_CASE("VertexLayout - Present attributes and quantization", "[gdf][VertexLayout]")
+{
+    uint32_t components = VertexLayout::ComponentBit(Vertex::Component::Position) |
+                          VertexLayout::ComponentBit(Vertex::Component::Normal) |
+                          VertexLayout::ComponentBit(Vertex::Component::UV) |
+                          VertexLayout::ComponentBit(Vertex::Component::Tangent);
+    VertexLayout floats(components, kFloatVertexFormats);
+    REQUIRE(floats.stride() == 48);
+    REQUIRE(floats.Find(Vertex::Component::Color) == nullptr);
+    auto descriptions = floats.AttributeDescriptions(0);
+    REQUIRE(descriptions.size() == 4);
+    REQUIRE(descriptions[2].location == static_cast<uint32_t>(Vertex::Component::UV));
+    REQUIRE(descriptions[2].offset == 24);
+    REQUIRE(descriptions[2].format == VK_FORMAT_R32G32_SFLOAT);
+    REQUIRE(descriptions[3].location == static_cast<uint32_t>(Vertex::Component::Tangent));
+
+    VertexLayout layout(components, kQuantizedVertexFormats);
+    REQUIRE(layout.stride() == 24);
+    REQUIRE(layout.BindingDescription(1).stride == 24);
+    REQUIRE(layout.Find(Vertex::Component::Normal)->vkFormat == VK_FORMAT_R16G16_SNORM);
+    // a format the attribute can't use falls back to floats
+    VertexFormats misfit = kQuantizedVertexFormats;
+    misfit[static_cast<uint32_t>(Vertex::Component::Position)] = VertexFormat::Octahedral16;
+    REQUIRE(VertexLayout(components, misfit).Find(Vertex::Component::Position)->format == VertexFormat::Float);
+
+    constexpr uint32_t kCount = 1000;
+    std::mt19937 random(3);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    glm::vec3 min(-2.0f, 0.0f, 5.0f);
+    glm::vec3 size(4.0f, 0.0f, 10.0f);
+    std::vector<float> positions;
+    std::vector<float> normals;
+    std::vector<float> tangents;
+    for (uint32_t i = 0; i < kCount; i++) {
+        glm::vec3 position = min + (glm::vec3(unit(random), unit(random), unit(random)) * 0.5f + 0.5f) * size;
+        positions.insert(positions.end(), {position.x, position.y, position.z});
+        glm::vec3 normal;
+        do {
+            normal = glm::vec3(unit(random), unit(random), unit(random));
+        } while (glm::length(normal) < 0.1f);
+        normal = glm::normalize(normal);
+        normals.insert(normals.end(), {normal.x, normal.y, normal.z});
+        tangents.insert(tangents.end(), {normal.y, normal.z, normal.x, i % 2 == 0 ? 1.0f : -1.0f});
+    }
+    std::vector<uint8_t> vertices(static_cast<size_t>(kCount) * layout.stride());
+    const VertexLayout::Attribute &position = *layout.Find(Vertex::Component::Position);
+    const VertexLayout::Attribute &normal = *layout.Find(Vertex::Component::Normal);
+    const VertexLayout::Attribute &tangent = *layout.Find(Vertex::Component::Tangent);
+    layout.Encode(position, positions.data(), kCount, min, size, vertices.data());
+    layout.Encode(normal, normals.data(), kCount, min, size, vertices.data());
+    layout.Encode(tangent, tangents.data(), kCount, min, size, vertices.data());
+
+    // what a shader reads back, the octahedral decode as documented on VertexFormat
+    auto octahedralDecode = [](glm::vec2 encoded) {
+        glm::vec3 vector(encoded, 1.0f - std::abs(encoded.x) - std::abs(encoded.y));
+        float fold = std::max(-vector.z, 0.0f);
+        vector.x -= (vector.x >= 0.0f ? 1.0f : -1.0f) * fold;
+        vector.y -= (vector.y >= 0.0f ? 1.0f : -1.0f) * fold;
+        return glm::normalize(vector);
+    };
+    float positionError = 0.0f;
+    float normalDot = 1.0f;
+    bool handednessKept = true;
+    for (uint32_t i = 0; i < kCount; i++) {
+        const uint8_t *vertex = vertices.data() + static_cast<size_t>(i) * layout.stride();
+        uint64_t packedPosition;
+        std::memcpy(&packedPosition, vertex + position.offset, sizeof(packedPosition));
+        glm::vec3 decoded = min + glm::vec3(glm::unpackUnorm4x16(packedPosition)) * size;
+        glm::vec3 original(positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2]);
+        positionError = std::max(positionError, glm::length(decoded - original));
+
+        uint32_t packedNormal;
+        std::memcpy(&packedNormal, vertex + normal.offset, sizeof(packedNormal));
+        glm::vec3 decodedNormal = octahedralDecode(glm::unpackSnorm2x16(packedNormal));
+        glm::vec3 originalNormal(normals[i * 3], normals[i * 3 + 1], normals[i * 3 + 2]);
+        normalDot = std::min(normalDot, glm::dot(decodedNormal, originalNormal));
+
+        uint64_t packedTangent;
+        std::memcpy(&packedTangent, vertex + tangent.offset, sizeof(packedTangent));
+        glm::vec4 decodedTangent = glm::unpackSnorm4x16(packedTangent);
+        handednessKept = handednessKept && decodedTangent.z == tangents[i * 4 + 3];
+    }
+    // half a step of 16 bits over the largest extent, a flat axis is exact
+    REQUIRE(positionError <= glm::length(size) / 65535.0f);
+    REQUIRE(normalDot > 0.99999f);
+    REQUIRE(handednessKept);
+
+    // joints as bytes, weights as unorm8
+    VertexLayout skinned(VertexLayout::ComponentBit(Vertex::Component::Joint0) |
+                             VertexLayout::ComponentBit(Vertex::Component::Weight0),
+                         kQuantizedVertexFormats);
+    REQUIRE(skinned.stride() == 8);
+    const float joints[4] = {3.0f, 255.0f, 0.0f, 17.0f};
+    const float weights[4] = {0.5f, 0.25f, 0.25f, 0.0f};
+    uint8_t skin[8];
+    skinned.Encode(*skinned.Find(Vertex::Component::Joint0), joints, 1, min, size, skin);
+    skinned.Encode(*skinned.Find(Vertex::Component::Weight0), weights, 1, min, size, skin);
+    REQUIRE(skin[0] == 3);
+    REQUIRE(skin[1] == 255);
+    REQUIRE(skin[3] == 17);
+    REQUIRE(skin[4] == 128);
+    REQUIRE(skin[5] == 64);
+    REQUIRE(skin[7] == 0);
+}
+
+TEST_CASE("VertexStreams - Aligned streams interleave to the layout", "[gdf][VertexStreams]")
+{
+    uint32_t components = VertexLayout::ComponentBit(Vertex::Component::Position) |
+                          VertexLayout::ComponentBit(Vertex::Component::Normal) |
+                          VertexLayout::ComponentBit(Vertex::Component::UV);
+    // an odd count so the streams need padding to stay aligned
+    constexpr uint32_t kCount = 7;
+    VertexStreams streams(components, kCount);
+    REQUIRE(streams.Stream(Vertex::Component::Color) == nullptr);
+    for (Vertex::Component component : {Vertex::Component::Position, Vertex::Component::Normal, Vertex::Component::UV}) {
+        float *stream = streams.Stream(component);
+        REQUIRE(stream != nullptr);
+        REQUIRE(reinterpret_cast<uintptr_t>(stream) % VertexStreams::kAlignment == 0);
+        for (uint32_t i = 0; i < kCount * VertexLayout::ComponentCount(component); i++)
+            stream[i] = static_cast<float>(i) * 0.125f + static_cast<float>(component);
+    }
+
+    VertexLayout floats(components, kFloatVertexFormats);
+    std::vector<uint8_t> vertices(static_cast<size_t>(kCount) * floats.stride());
+    glm::vec3 min(0.0f);
+    glm::vec3 size(1.0f);
+    // in two ranges like two primitives
+    streams.Interleave(floats, 0, 3, min, size, vertices.data());
+    streams.Interleave(floats, 3, kCount - 3, min, size, vertices.data());
+    bool same = true;
+    for (const VertexLayout::Attribute &attribute : floats.attributes()) {
+        uint32_t valueCount = VertexLayout::ComponentCount(attribute.component);
+        for (uint32_t i = 0; i < kCount; i++)
+            same = same && std::memcmp(vertices.data() + static_cast<size_t>(i) * floats.stride() + attribute.offset,
+                                       streams.Stream(attribute.component) + i * valueCount,
+                                       valueCount * sizeof(float)) == 0;
+    }
+    REQUIRE(same);
+
+    // quantized attributes are encoded from the streams the way the loader encodes them
+    VertexLayout quantized(components, kQuantizedVertexFormats);
+    std::vector<uint8_t> encoded(static_cast<size_t>(kCount) * quantized.stride());
+    std::vector<uint8_t> expected(encoded.size());
+    size = glm::vec3(16.0f);
+    streams.Interleave(quantized, 0, kCount, min, size, encoded.data());
+    for (const VertexLayout::Attribute &attribute : quantized.attributes())
+        quantized.Encode(attribute, streams.Stream(attribute.component), kCount, min, size, expected.data());
+    REQUIRE(encoded == expected);
+}
+
+// A triangle in a .glb, positionCount positions whose view claims positionViewLength bytes of the 36 there are
+static void WriteTriangleGlb(const std::string &path, int positionCount, size_t positionViewLength)
+{
+    const float positions[] = {0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 2.0f, 0.5f};
+    const uint16_t indices[] = {0, 1, 2, 0};
+    std::vector<uint8_t> bin(sizeof(positions) + sizeof(indices));
+    std::memcpy(bin.data(), positions, sizeof(positions));
+    std::memcpy(bin.data() + sizeof(positions), indices, sizeof(indices));
+    nlohmann::json document = {
+        {"asset", {{"version", "2.0"}}},
+        {"scene", 0},
+        {"scenes", {{{"nodes", {0}}}}},
+        {"nodes", {{{"mesh", 0}}}},
+        {"meshes", {{{"primitives", {{{"attributes", {{"POSITION", 0}}}, {"indices", 1}}}}}}},
+        {"accessors",
+         {{{"bufferView", 0},
+           {"componentType", 5126},
+           {"count", positionCount},
+           {"type", "VEC3"},
+           {"min", {0.0f, 0.0f, 0.0f}},
+           {"max", {1.0f, 2.0f, 0.5f}}},
+          {{"bufferView", 1}, {"componentType", 5123}, {"count", 3}, {"type", "SCALAR"}}}},
+        {"bufferViews",
+         {{{"buffer", 0}, {"byteOffset", 0}, {"byteLength", positionViewLength}},
+          {{"buffer", 0}, {"byteOffset", sizeof(positions)}, {"byteLength", 6}}}},
+        {"buffers", {{{"byteLength", bin.size()}}}},
+    };
+    std::string json = document.dump();
+    json.resize((json.size() + 3) & ~size_t{3}, ' ');
+
+    auto writeU32 = [](std::ofstream &file, uint32_t value) { file.write(reinterpret_cast<const char *>(&value), 4); };
+    std::ofstream file(path, std::ios::binary);
+    writeU32(file, 0x46546C67); // "glTF"
+    writeU32(file, 2);
+    writeU32(file, static_cast<uint32_t>(12 + 8 + json.size() + 8 + bin.size()));
+    writeU32(file, static_cast<uint32_t>(json.size()));
+    writeU32(file, 0x4E4F534A); // "JSON"
+    file.write(json.data(), json.size());
+    writeU32(file, static_cast<uint32_t>(bin.size()));
+    writeU32(file, 0x004E4942); // "BIN\0"
+    file.write(reinterpret_cast<const char *>(bin.data()), bin.size());
+}
+
+TEST_CASE("Model - Load glb", "[gdf][Model]")
+{
+    auto path = (std::filesystem::temp_directory_path() / "gdf_model_test.glb").string();
+    SECTION("Round trip")
+    {
+        WriteTriangleGlb(path, 3, 36);
+        Model *model = Model::LoadFromFile(path);
+        REQUIRE(model != nullptr);
+        REQUIRE(model->vertices.count == 3);
+        REQUIRE(model->indices.count == 3);
+        REQUIRE(model->indexData == std::vector<uint32_t>{0, 1, 2});
+        const VertexLayout::Attribute *position = model->vertexLayout.Find(Vertex::Component::Position);
+        REQUIRE(position != nullptr);
+        const float expected[3][3] = {{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 2.0f, 0.5f}};
+        for (int v = 0; v < 3; v++) {
+            float value[3];
+            std::memcpy(value, model->vertexData.data() + v * model->vertexLayout.stride() + position->offset, 12);
+            REQUIRE(std::memcmp(value, expected[v], 12) == 0);
+        }
+        delete model;
+    }
+    // the geometry is read straight from the mapping, what lies past it must fail the load instead
+    SECTION("Accessor past its buffer view")
+    {
+        WriteTriangleGlb(path, 4, 36);
+        REQUIRE(Model::LoadFromFile(path) == nullptr);
+    }
+    SECTION("Buffer view past its buffer")
+    {
+        WriteTriangleGlb(path, 3, 4096);
+        REQUIRE(Model::LoadFromFile(path) == nullptr);
+    }
+    std::filesystem::remove(path);
+}
+
+#ifdef GDF_ENABLE_PROFILER
+TEST_CASE("CpuProfiler - Zones across threads", "[gdf][CpuProfiler]")
+{
+    constexpr int kThreadCount = 3;
+    constexpr int kZonesPerThread = 1000;
+    // the profiler gdf::Initialize created, other tests may have registered threads and left zones in it
+    CpuProfiler &profiler = CpuProfiler::instance();
+    GDF_PROFILE_FRAME();
+    uint64_t dropped = profiler.droppedCount();
+    profiler.BeginCapture();
+    {
+        GDF_PROFILE_ZONE("Outer");
+        GDF_PROFILE_ZONE("Inner");
+    }
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreadCount; t++) {
+        threads.emplace_back([] {
+            GDF_PROFILE_THREAD("Profiled Worker");
+            for (int i = 0; i < kZonesPerThread; i++) {
+                GDF_PROFILE_ZONE("Work");
+            }
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+    GDF_PROFILE_FRAME();
+
+    const auto &events = profiler.frameEvents();
+    REQUIRE(events.size() == 2 + kThreadCount * kZonesPerThread);
+    REQUIRE(profiler.droppedCount() == dropped);
+    // a zone is written when it ends, so the inner zone comes first
+    REQUIRE(std::string_view{events[0].name} == "Inner");
+    REQUIRE(events[0].depth == 1);
+    REQUIRE(std::string_view{events[1].name} == "Outer");
+    REQUIRE(events[1].depth == 0);
+    REQUIRE(events[1].begin <= events[0].begin);
+    REQUIRE(events[0].end <= events[1].end);
+    std::map<uint32_t, int> perThread;
+    for (const auto &event : events) {
+        REQUIRE(event.begin >= profiler.frameBegin());
+        REQUIRE(event.end <= profiler.frameEnd());
+        if (std::string_view{event.name} == "Work")
+            perThread[event.thread]++;
+    }
+    REQUIRE(perThread.size() == kThreadCount);
+    REQUIRE(perThread.count(events[0].thread) == 0);
+    for (const auto &[thread, count] : perThread)
+        REQUIRE(count == kZonesPerThread);
+
+    auto path = (std::filesystem::temp_directory_path() / "gdf_cpu_trace.json").string();
+    REQUIRE(profiler.ExportChromeTrace(path));
+    REQUIRE_FALSE(profiler.capturing());
+    std::ifstream file(path);
+    auto trace = nlohmann::json::parse(file);
+    size_t completeEvents = 0;
+    size_t workerNames = 0;
+    for (const auto &event : trace["traceEvents"]) {
+        if (event["ph"] == "X")
+            completeEvents++;
+        else if (event["ph"] == "M" && event["args"]["name"] == "Profiled Worker")
+            workerNames++;
+    }
+    REQUIRE(completeEvents == events.size());
+    REQUIRE(workerNames == kThreadCount);
+    file.close();
+    std::filesystem::remove(path);
+}
+#endif // GDF_ENABLE_PROFILER
+
 int main(int argc, char *argv[])
 {
     gdf::Initialize();
     int result = Catch::Session().run(argc, argv);
     gdf::Cleanup();
     return result;
-}
\ No newline at end of file
+}